@@ -0,0 +1,1005 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "FileHandler.h"
+#include "Simulator.h"
+#include "CacheConfig.h"
+#include "Arguments.h"
+
+/*
+ * Benchmark harness of the simulator, built by make bench.
+ *
+ * Every benchmark runs in its own process, so its peak RSS is its own and includes its trace, and reports the fastest
+ * of its runs. The hits and misses of every level must match the golden counts written with --write-golden, which don't
+ * depend on the machine. The throughput and peak RSS are only compared with a baseline written with --write-baseline on
+ * the same machine, and only for benchmarks whose runs are long enough to be timed reliably.
+ */
+
+// Levels of the deepest hierarchy benchmarked
+#define BENCH_MAX_LEVELS 2
+
+// Least runs of each benchmark, the fastest one is kept
+#define BENCH_REPETITIONS 5
+
+// Short benchmarks are run again until their runs add up to this many seconds, so the fastest run is not just noise
+#define BENCH_MIN_SECONDS 0.25
+
+// Benchmarks whose fastest run is shorter than this many seconds are too sensitive to the machine to gate on throughput
+#define BENCH_MIN_GATED_SECONDS 0.005
+
+// Levels with fewer accesses per run than this have their ns per access left out, the time they add is just noise
+#define BENCH_MIN_LEVEL_ACCESSES ( 1 << 16 )
+
+// Table of the calibration kernel, 1 MiB of words, and its dependent lookups per run
+#define BENCH_CALIBRATION_WORDS ( 1 << 18 )
+#define BENCH_CALIBRATION_STEPS ( 1 << 20 )
+
+// Slowdowns within this many times the relative standard deviation of the runs are taken as noise
+#define BENCH_NOISE_FACTOR 3
+
+// Accesses of each synthetic trace
+#define BENCH_SYNTHETIC_SIZE ( 1 << 22 )
+
+// Relative tolerance of the throughput and peak RSS of a new baseline, on top of the noise of the runs
+#define BENCH_DEFAULT_TOLERANCE 0.30
+
+// Runs again of a benchmark that looks like a regression before it is reported as one, a slowdown of the machine
+// while it ran is not
+#define BENCH_RETRIES 2
+
+// Peak RSS growth below this many KiB is never a regression, whatever the tolerance
+#define BENCH_RSS_SLACK_KB 1024
+
+// Directory of the traces of the repository, relative to the working directory of make
+#define BENCH_TESTS_DIRECTORY "tests"
+
+#define BENCH_MAX_NAME 160
+
+enum benchTraceKind_t {
+    BENCH_TRACE_FILE,
+    BENCH_TRACE_UNIFORM,   // Uniformly random words of 16 MiB
+    BENCH_TRACE_STRIDED,   // Sweeps of 8 MiB with a stride of 64 bytes
+    BENCH_TRACE_HOT_COLD   // 90% of the accesses to a hot 32 KiB region, the rest to a cold 64 MiB region
+};
+
+enum benchKind_t {
+    BENCH_SIMULATE,        // simulate with a hierarchy and a replacement policy
+    BENCH_DIRECT_MAPPING,  // simulateDirectMapping
+    BENCH_LOAD_BINARY,     // handleBinaryFile
+    BENCH_LOAD_TEXT        // handleTextFile
+};
+
+typedef struct _benchTrace_t {
+    const char *  name;
+    const char *  file;  // Name of the trace in BENCH_TESTS_DIRECTORY without its extension, NULL for synthetic traces
+    int           kind;  // See benchTraceKind_t
+} benchTrace_t;
+
+typedef struct _benchLevel_t {
+    uint32_t  nsets;
+    uint32_t  bsize;
+    uint32_t  assoc;
+} benchLevel_t;
+
+typedef struct _benchHierarchy_t {
+    unsigned int  levels;
+    benchLevel_t  level[ BENCH_MAX_LEVELS ];
+} benchHierarchy_t;
+
+/*
+ * A benchmark: what it runs and on which trace.
+ */
+typedef struct _benchCase_t {
+    int                       kind;       // See benchKind_t
+    const benchTrace_t *      trace;
+    const benchHierarchy_t *  hierarchy;  // Only for BENCH_SIMULATE
+    int                       policy;     // Only for BENCH_SIMULATE, the policy of every level
+    char                      name[ BENCH_MAX_NAME ];
+} benchCase_t;
+
+/*
+ * Measurements of a benchmark. Loaders have no levels, their accesses are the addresses loaded.
+ */
+typedef struct _benchResult_t {
+    char          name[ BENCH_MAX_NAME ];
+    unsigned int  levels;
+    uint64_t      accesses;
+    double        seconds;                          // Fastest run
+    double        noise;                            // Relative standard deviation of the runs
+    double        machineSpeed;                     // Steps per second of the calibration kernel around the benchmark
+    double        accessesPerSecond;
+    double        nsPerAccess[ BENCH_MAX_LEVELS ];  // Time added by each level, per access to it, NAN if not measured
+    uint64_t      hits[ BENCH_MAX_LEVELS ];
+    uint64_t      misses[ BENCH_MAX_LEVELS ];
+    long          peakRssKB;
+} benchResult_t;
+
+/*
+ * Run times of a benchmark.
+ */
+typedef struct _benchTimer_t {
+    int     runs;
+    double  best;
+    double  sum;
+    double  sumSquares;
+} benchTimer_t;
+
+static const benchTrace_t benchTraces[] = {
+    { "bin_100", "bin_100", BENCH_TRACE_FILE },
+    { "bin_1000", "bin_1000", BENCH_TRACE_FILE },
+    { "bin_10000", "bin_10000", BENCH_TRACE_FILE },
+    { "vortex", "vortex.in.sem.persons", BENCH_TRACE_FILE },
+    { "uniform", NULL, BENCH_TRACE_UNIFORM },
+    { "strided", NULL, BENCH_TRACE_STRIDED },
+    { "hotcold", NULL, BENCH_TRACE_HOT_COLD }
+};
+
+static const benchHierarchy_t benchHierarchies[] = {
+    { 1, { { 256, 32, 4 } } },
+    { 1, { { 256, 32, 16 } } },
+    { 2, { { 64, 32, 4 }, { 1024, 64, 8 } } }
+};
+
+// Cache of the direct mapping benchmarks
+static const benchLevel_t benchDirectMapped = { 1024, 32, 1 };
+
+/*
+ * A consistency check of an option of the first level of a hierarchy: simulated with the option, every level below the
+ * first must still be accessed once per miss of the level above it, whatever the block sizes, and if the option keeps
+ * the first level as it is every count must be the same as without it.
+ */
+typedef struct _benchCheck_t {
+    const char *  name;
+    void       ( * apply )( cacheConfig_t * cacheConfig );
+    bool          sameResults;
+} benchCheck_t;
+
+static void partitionAllWays( cacheConfig_t * cacheConfig ) {
+    cacheConfig->wayMasks[ 0 ] = ( UINT64_C( 1 ) << cacheConfig->assoc ) - 1;
+    cacheConfig->partitioned = true;
+}
+
+static void partitionTwoWays( cacheConfig_t * cacheConfig ) {
+    cacheConfig->wayMasks[ 0 ] = 0x3;
+    cacheConfig->partitioned = true;
+}
+
+static void partitionFourSetGroups( cacheConfig_t * cacheConfig ) {
+    cacheConfig->setMasks[ 0 ] = 0xF;
+    cacheConfig->partitioned = true;
+}
+
+static const benchCheck_t benchChecks[] = {
+    { "partition:ways:all", partitionAllWays, true },
+    { "partition:ways:0x3", partitionTwoWays, false },
+    { "partition:sets:0xF", partitionFourSetGroups, false }
+};
+
+// Trace and hierarchy of the checks, the second level has smaller blocks than the first
+static const benchTrace_t benchCheckTrace = { "vortex", "vortex.in.sem.persons", BENCH_TRACE_FILE };
+static const benchHierarchy_t benchCheckHierarchy = { 2, { { 64, 64, 4 }, { 256, 16, 8 } } };
+
+static double elapsedSeconds( const struct timespec * start ) {
+    struct timespec end;
+
+    clock_gettime( CLOCK_MONOTONIC, &end );
+
+    return ( double )( end.tv_sec - start->tv_sec ) + ( double )( end.tv_nsec - start->tv_nsec ) / 1e9;
+}
+
+/*
+ * Whether a benchmark needs another run.
+ */
+static bool runAgain( const benchTimer_t * timer ) {
+    return timer->runs < BENCH_REPETITIONS || timer->sum < BENCH_MIN_SECONDS;
+}
+
+static void recordRun( benchTimer_t * timer, double seconds ) {
+    timer->best = timer->runs == 0 || seconds < timer->best ? seconds : timer->best;
+    timer->sum += seconds;
+    timer->sumSquares += seconds * seconds;
+    timer->runs++;
+}
+
+/*
+ * Relative standard deviation of the runs of a timer.
+ */
+static double timerNoise( const benchTimer_t * timer ) {
+    double mean = timer->sum / timer->runs;
+    double variance = timer->sumSquares / timer->runs - mean * mean;
+
+    return variance > 0 && mean > 0 ? sqrt( variance ) / mean : 0;
+}
+
+/*
+ * Measures the speed of the machine as the steps per second of a fixed kernel of dependent table lookups and
+ * arithmetic, which doesn't depend on the simulator.
+ *
+ * The speed of a shared machine drifts by tens of percent over seconds, so benchmarks are compared by their throughput
+ * relative to the speed of the machine measured right around them instead of by their absolute throughput.
+ */
+static double measureMachineSpeed( void ) {
+    static uint32_t    table[ BENCH_CALIBRATION_WORDS ];
+    benchTimer_t       timer = { 0 };
+    volatile uint32_t  sink;
+
+    for ( uint32_t i = 0; i < BENCH_CALIBRATION_WORDS; i++ ) {
+        table[ i ] = i * UINT32_C( 2654435761 );
+    }
+
+    for ( int run = 0; run < BENCH_REPETITIONS; run++ ) {
+        struct timespec  start;
+        uint32_t         index = 0;
+
+        clock_gettime( CLOCK_MONOTONIC, &start );
+
+        for ( uint32_t step = 0; step < BENCH_CALIBRATION_STEPS; step++ ) {
+            index = ( table[ index ] ^ step ) & ( BENCH_CALIBRATION_WORDS - 1 );
+        }
+
+        sink = index;
+        recordRun( &timer, elapsedSeconds( &start ) );
+    }
+
+    ( void )sink;
+
+    return BENCH_CALIBRATION_STEPS / timer.best;
+}
+
+/*
+ * Generates a synthetic trace, always the same one for each kind.
+ */
+static void generateTrace( int kind, uint32_t ** addresses, size_t * size ) {
+    uint64_t state = UINT64_C( 0x853C49E6748FEA9B );
+
+    *size = BENCH_SYNTHETIC_SIZE;
+    *addresses = malloc( sizeof( uint32_t ) * *size );
+
+    if ( *addresses == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( size_t i = 0; i < *size; i++ ) {
+        // xorshift64*
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+
+        uint32_t random = ( uint32_t )( ( state * UINT64_C( 0x2545F4914F6CDD1D ) ) >> 32 );
+
+        if ( kind == BENCH_TRACE_UNIFORM ) {
+            ( *addresses )[ i ] = random & ( ( UINT32_C( 1 ) << 24 ) - 4 );
+        } else if ( kind == BENCH_TRACE_STRIDED ) {
+            ( *addresses )[ i ] = ( uint32_t )( i * 64 ) & ( ( UINT32_C( 1 ) << 23 ) - 1 );
+        } else if ( random % 10 < 9 ) {
+            ( *addresses )[ i ] = ( random >> 4 ) & ( ( UINT32_C( 1 ) << 15 ) - 4 );
+        } else {
+            ( *addresses )[ i ] = UINT32_C( 0x10000000 ) + ( ( random >> 4 ) & ( ( UINT32_C( 1 ) << 26 ) - 4 ) );
+        }
+    }
+}
+
+static void traceFilePath( const benchTrace_t * trace, const char * extension, char * path, size_t size ) {
+    snprintf( path, size, "%s/%s.%s", BENCH_TESTS_DIRECTORY, trace->file, extension );
+}
+
+static void loadTrace( const benchTrace_t * trace, uint32_t ** addresses, size_t * size ) {
+    char path[ BENCH_MAX_NAME ];
+
+    if ( trace->kind != BENCH_TRACE_FILE ) {
+        generateTrace( trace->kind, addresses, size );
+
+        return;
+    }
+
+    traceFilePath( trace, "bin", path, sizeof( path ) );
+    handleBinaryFile( path, addresses, size );
+}
+
+/*
+ * Builds the configuration list of the first levels levels of a hierarchy, every level with the same policy.
+ */
+static cacheConfigList_t * buildHierarchy( const benchHierarchy_t * hierarchy, unsigned int levels, int policy ) {
+    cacheConfigList_t * cacheConfigList = NULL;
+
+    for ( unsigned int i = 0; i < levels; i++ ) {
+        cacheConfig_t cacheConfig = { .nsets = hierarchy->level[ i ].nsets, .bsize = hierarchy->level[ i ].bsize,
+                                      .assoc = hierarchy->level[ i ].assoc, .replacementPolicy = policy, .level = i + 1 };
+
+        if ( cacheConfigList == NULL ) {
+            initializeCacheConfigList( &cacheConfigList, &cacheConfig );
+        } else {
+            pushCacheConfig( &cacheConfigList, &cacheConfig );
+        }
+    }
+
+    verifyCacheConfig( cacheConfigList );
+
+    return cacheConfigList;
+}
+
+/*
+ * Runs simulate on the first levels levels of the hierarchy of a benchmark, timing every run into timer and returning
+ * the results of the last one.
+ */
+static result_t * timeSimulation( const benchCase_t * bench, unsigned int levels, uint32_t * addresses, size_t size, benchTimer_t * timer ) {
+    cacheConfigList_t *  cacheConfigList = buildHierarchy( bench->hierarchy, levels, bench->policy );
+    result_t *           results = NULL;
+
+    *timer = ( benchTimer_t ){ 0 };
+
+    while ( runAgain( timer ) ) {
+        struct timespec start;
+
+        free( results );
+
+        clock_gettime( CLOCK_MONOTONIC, &start );
+        results = simulate( addresses, size, cacheConfigList );
+        recordRun( timer, elapsedSeconds( &start ) );
+    }
+
+    destroyCacheConfigList( cacheConfigList );
+
+    return results;
+}
+
+/*
+ * Runs a simulation benchmark. Each level is timed as the difference between simulating the hierarchy down to it and
+ * down to the level above it, unless it has too few accesses for the difference to mean anything.
+ */
+static void runSimulation( const benchCase_t * bench, benchResult_t * result ) {
+    uint32_t *  addresses;
+    size_t      size;
+    double      previous = 0;
+
+    loadTrace( bench->trace, &addresses, &size );
+
+    result->levels = bench->hierarchy->levels;
+    result->accesses = size;
+
+    for ( unsigned int levels = 1; levels <= bench->hierarchy->levels; levels++ ) {
+        benchTimer_t  timer;
+        result_t *    results = timeSimulation( bench, levels, addresses, size, &timer );
+        uint64_t      levelAccesses = results[ levels - 1 ].accesses;
+        double        added = timer.best > previous ? timer.best - previous : 0;
+
+        result->nsPerAccess[ levels - 1 ] = levelAccesses >= BENCH_MIN_LEVEL_ACCESSES ? added * 1e9 / levelAccesses : NAN;
+        result->seconds = timer.best;
+        result->noise = timerNoise( &timer );
+        previous = timer.best;
+
+        if ( levels == bench->hierarchy->levels ) {
+            for ( unsigned int level = 0; level < levels; level++ ) {
+                result->hits[ level ] = results[ level ].hits;
+                result->misses[ level ] = results[ level ].compulsoryMisses + results[ level ].capacityMisses + results[ level ].conflictMisses;
+            }
+        }
+
+        free( results );
+    }
+
+    releaseFile( addresses );
+}
+
+static void runDirectMapping( const benchCase_t * bench, benchResult_t * result ) {
+    uint32_t *    addresses;
+    size_t        size;
+    result_t      directResult = { 0 };
+    benchTimer_t  timer = { 0 };
+
+    loadTrace( bench->trace, &addresses, &size );
+
+    result->levels = 1;
+    result->accesses = size;
+
+    while ( runAgain( &timer ) ) {
+        struct timespec start;
+
+        clock_gettime( CLOCK_MONOTONIC, &start );
+        directResult = simulateDirectMapping( addresses, size, benchDirectMapped.bsize, benchDirectMapped.nsets );
+        recordRun( &timer, elapsedSeconds( &start ) );
+    }
+
+    result->seconds = timer.best;
+    result->noise = timerNoise( &timer );
+    result->nsPerAccess[ 0 ] = size >= BENCH_MIN_LEVEL_ACCESSES ? result->seconds * 1e9 / size : NAN;
+    result->hits[ 0 ] = directResult.hits;
+    result->misses[ 0 ] = directResult.compulsoryMisses + directResult.capacityMisses + directResult.conflictMisses;
+
+    releaseFile( addresses );
+}
+
+static void runLoader( const benchCase_t * bench, benchResult_t * result ) {
+    char          path[ BENCH_MAX_NAME ];
+    benchTimer_t  timer = { 0 };
+
+    traceFilePath( bench->trace, bench->kind == BENCH_LOAD_BINARY ? "bin" : "txt", path, sizeof( path ) );
+
+    result->levels = 0;
+
+    while ( runAgain( &timer ) ) {
+        struct timespec  start;
+        uint32_t *       addresses;
+        size_t           size;
+
+        clock_gettime( CLOCK_MONOTONIC, &start );
+
+        if ( bench->kind == BENCH_LOAD_BINARY ) {
+            handleBinaryFile( path, &addresses, &size );
+        } else {
+            handleTextFile( path, &addresses, &size );
+        }
+
+        recordRun( &timer, elapsedSeconds( &start ) );
+        result->accesses = size;
+
+        releaseFile( addresses );
+    }
+
+    result->seconds = timer.best;
+    result->noise = timerNoise( &timer );
+}
+
+/*
+ * Runs a benchmark in a child process, which sends its measurements through a pipe, and adds the peak RSS of the
+ * child.
+ */
+static void runBenchmark( const benchCase_t * bench, benchResult_t * result ) {
+    int             channel[ 2 ];
+    pid_t           child;
+    int             status;
+    struct rusage   usage;
+
+    fflush( stdout );
+
+    if ( pipe( channel ) != 0 || ( child = fork() ) < 0 ) {
+        perror( "cache_benchmark" );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( child == 0 ) {
+        benchResult_t  measured = { 0 };
+        double         speedBefore;
+
+        close( channel[ 0 ] );
+
+        speedBefore = measureMachineSpeed();
+
+        if ( bench->kind == BENCH_SIMULATE ) {
+            runSimulation( bench, &measured );
+        } else if ( bench->kind == BENCH_DIRECT_MAPPING ) {
+            runDirectMapping( bench, &measured );
+        } else {
+            runLoader( bench, &measured );
+        }
+
+        measured.machineSpeed = ( speedBefore + measureMachineSpeed() ) / 2;
+
+        _exit( write( channel[ 1 ], &measured, sizeof( measured ) ) == sizeof( measured ) ? EXIT_SUCCESS : EXIT_FAILURE );
+    }
+
+    close( channel[ 1 ] );
+
+    ssize_t bytesRead = read( channel[ 0 ], result, sizeof( benchResult_t ) );
+
+    close( channel[ 0 ] );
+
+    if ( wait4( child, &status, 0, &usage ) < 0 || !WIFEXITED( status ) || WEXITSTATUS( status ) != EXIT_SUCCESS
+        || bytesRead != sizeof( benchResult_t ) ) {
+        fprintf( stderr, "Erro: o benchmark %s falhou.\n", bench->name );
+        exit( EXIT_FAILURE );
+    }
+
+    memcpy( result->name, bench->name, sizeof( result->name ) );
+    result->accessesPerSecond = result->seconds > 0 ? result->accesses / result->seconds : 0;
+    result->peakRssKB = usage.ru_maxrss;
+}
+
+/*
+ * Lists every benchmark: the loaders of each trace file, then for each trace simulate with every hierarchy and policy
+ * and simulateDirectMapping.
+ */
+static size_t listBenchmarks( benchCase_t ** cases ) {
+    size_t traceCount = sizeof( benchTraces ) / sizeof( benchTraces[ 0 ] );
+    size_t hierarchyCount = sizeof( benchHierarchies ) / sizeof( benchHierarchies[ 0 ] );
+    size_t count = 0;
+
+    *cases = malloc( sizeof( benchCase_t ) * traceCount * ( 2 + hierarchyCount * ( DIP + 1 ) + 1 ) );
+
+    if ( *cases == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( size_t t = 0; t < traceCount; t++ ) {
+        const benchTrace_t * trace = &benchTraces[ t ];
+
+        if ( trace->kind == BENCH_TRACE_FILE ) {
+            ( *cases )[ count ] = ( benchCase_t ){ .kind = BENCH_LOAD_BINARY, .trace = trace };
+            snprintf( ( *cases )[ count++ ].name, BENCH_MAX_NAME, "%s/load:bin", trace->name );
+            ( *cases )[ count ] = ( benchCase_t ){ .kind = BENCH_LOAD_TEXT, .trace = trace };
+            snprintf( ( *cases )[ count++ ].name, BENCH_MAX_NAME, "%s/load:txt", trace->name );
+        }
+    }
+
+    for ( size_t t = 0; t < traceCount; t++ ) {
+        const benchTrace_t * trace = &benchTraces[ t ];
+
+        for ( size_t h = 0; h < hierarchyCount; h++ ) {
+            const benchHierarchy_t * hierarchy = &benchHierarchies[ h ];
+
+            for ( int policy = RANDOM; policy <= DIP; policy++ ) {
+                benchCase_t *  bench = &( *cases )[ count++ ];
+                int            length;
+
+                *bench = ( benchCase_t ){ .kind = BENCH_SIMULATE, .trace = trace, .hierarchy = hierarchy, .policy = policy };
+                length = snprintf( bench->name, BENCH_MAX_NAME, "%s/%s", trace->name, replacementPolicyName( policy ) );
+
+                for ( unsigned int level = 0; level < hierarchy->levels; level++ ) {
+                    length += snprintf( bench->name + length, BENCH_MAX_NAME - length, "/L%u:%" PRIu32 "x%" PRIu32 "x%" PRIu32, level + 1,
+                                        hierarchy->level[ level ].nsets, hierarchy->level[ level ].bsize, hierarchy->level[ level ].assoc );
+                }
+            }
+        }
+
+        ( *cases )[ count ] = ( benchCase_t ){ .kind = BENCH_DIRECT_MAPPING, .trace = trace };
+        snprintf( ( *cases )[ count++ ].name, BENCH_MAX_NAME, "%s/direct/L1:%" PRIu32 "x%" PRIu32 "x1", trace->name, benchDirectMapped.nsets,
+                  benchDirectMapped.bsize );
+    }
+
+    return count;
+}
+
+/*
+ * Runs the consistency checks, printing a line for each, and returns how many failed.
+ */
+static size_t runChecks( void ) {
+    size_t      checkCount = sizeof( benchChecks ) / sizeof( benchChecks[ 0 ] );
+    size_t      failures = 0;
+    uint32_t *  addresses;
+    size_t      size;
+    result_t *  plain;
+
+    loadTrace( &benchCheckTrace, &addresses, &size );
+
+    cacheConfigList_t * cacheConfigList = buildHierarchy( &benchCheckHierarchy, benchCheckHierarchy.levels, LRU );
+
+    plain = simulate( addresses, size, cacheConfigList );
+    destroyCacheConfigList( cacheConfigList );
+
+    for ( size_t i = 0; i < checkCount; i++ ) {
+        const benchCheck_t *  check = &benchChecks[ i ];
+        result_t *            results;
+        bool                  passed = true;
+
+        cacheConfigList = buildHierarchy( &benchCheckHierarchy, benchCheckHierarchy.levels, LRU );
+        check->apply( &cacheConfigList->cacheConfig );
+        results = simulate( addresses, size, cacheConfigList );
+
+        for ( unsigned int level = 0; level < benchCheckHierarchy.levels; level++ ) {
+            uint64_t misses = results[ level ].compulsoryMisses + results[ level ].capacityMisses + results[ level ].conflictMisses;
+
+            if ( level + 1 < benchCheckHierarchy.levels && results[ level + 1 ].accesses != misses ) {
+                passed = false;
+            }
+
+            if ( check->sameResults && ( results[ level ].accesses != plain[ level ].accesses || results[ level ].hits != plain[ level ].hits ) ) {
+                passed = false;
+            }
+        }
+
+        printf( "%s/check/%-40s %s\n", benchCheckTrace.name, check->name, passed ? "ok" : "MISMATCH" );
+
+        failures += !passed;
+
+        free( results );
+        destroyCacheConfigList( cacheConfigList );
+    }
+
+    free( plain );
+    releaseFile( addresses );
+
+    return failures;
+}
+
+/*
+ * Writes results as JSON, one benchmark per line, which is the layout readResults reads. The golden counts only have
+ * the hits and misses of each benchmark, which don't depend on the machine.
+ */
+static void writeResults( const char * filePath, benchResult_t * results, size_t count, bool golden ) {
+    FILE * file = fopen( filePath, "w" );
+
+    if ( file == NULL ) {
+        perror( filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    fputs( "{\n", file );
+
+    if ( !golden ) {
+        fprintf( file, "  \"tolerance\": %.2f,\n", BENCH_DEFAULT_TOLERANCE );
+    }
+
+    fputs( "  \"benchmarks\": [\n", file );
+
+    for ( size_t i = 0; i < count; i++ ) {
+        benchResult_t * result = &results[ i ];
+
+        fprintf( file, "    { \"name\": \"%s\", \"accesses\": %" PRIu64, result->name, result->accesses );
+
+        if ( !golden ) {
+            fprintf( file, ", \"seconds\": %.9f, \"noise\": %.4f, \"machine_speed\": %.0f, \"accesses_per_second\": %.0f, \"peak_rss_kb\": %ld, \"ns_per_access\": [",
+                     result->seconds, result->noise, result->machineSpeed, result->accessesPerSecond, result->peakRssKB );
+
+            for ( unsigned int level = 0; level < result->levels; level++ ) {
+                if ( isnan( result->nsPerAccess[ level ] ) ) {
+                    fprintf( file, "%snull", level > 0 ? ", " : "" );
+                } else {
+                    fprintf( file, "%s%.3f", level > 0 ? ", " : "", result->nsPerAccess[ level ] );
+                }
+            }
+
+            fputs( "]", file );
+        }
+
+        fputs( ", \"hits\": [", file );
+
+        for ( unsigned int level = 0; level < result->levels; level++ ) {
+            fprintf( file, "%s%" PRIu64, level > 0 ? ", " : "", result->hits[ level ] );
+        }
+
+        fputs( "], \"misses\": [", file );
+
+        for ( unsigned int level = 0; level < result->levels; level++ ) {
+            fprintf( file, "%s%" PRIu64, level > 0 ? ", " : "", result->misses[ level ] );
+        }
+
+        fprintf( file, "] }%s\n", i + 1 < count ? "," : "" );
+    }
+
+    fputs( "  ]\n}\n", file );
+
+    if ( fclose( file ) != 0 ) {
+        perror( filePath );
+        exit( EXIT_FAILURE );
+    }
+}
+
+/*
+ * Finds the value of a key in a line of JSON, returns NULL if the line doesn't have it.
+ */
+static const char * findJsonValue( const char * line, const char * key ) {
+    char          quoted[ 64 ];
+    const char *  found;
+
+    snprintf( quoted, sizeof( quoted ), "\"%s\":", key );
+    found = strstr( line, quoted );
+
+    return found != NULL ? found + strlen( quoted ) + strspn( found + strlen( quoted ), " " ) : NULL;
+}
+
+/*
+ * Reads an array of numbers of a line of JSON, returning how many it has, up to max.
+ */
+static unsigned int readJsonArray( const char * line, const char * key, double * values, unsigned int max ) {
+    const char *  value = findJsonValue( line, key );
+    unsigned int  count = 0;
+    char *        end;
+
+    if ( value == NULL || *value != '[' ) {
+        return 0;
+    }
+
+    for ( value++; count < max; value = end + strspn( end, ", " ) ) {
+        double number = strtod( value, &end );
+
+        if ( end == value ) {
+            break;
+        }
+
+        values[ count++ ] = number;
+    }
+
+    return count;
+}
+
+/*
+ * Reads golden counts or a baseline written by writeResults, returning the number of benchmarks read into results.
+ * Returns 0 without results if the file doesn't exist and it's optional.
+ */
+static size_t readResults( const char * filePath, bool optional, benchResult_t ** results, double * tolerance ) {
+    FILE *  file = fopen( filePath, "r" );
+    char    line[ 1024 ];
+    size_t  count = 0;
+    size_t  capacity = 256;
+
+    *results = NULL;
+
+    if ( file == NULL && optional ) {
+        return 0;
+    }
+
+    if ( file == NULL ) {
+        perror( filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    *results = malloc( sizeof( benchResult_t ) * capacity );
+
+    if ( *results == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    while ( fgets( line, sizeof( line ), file ) != NULL ) {
+        const char *  value;
+        double        numbers[ BENCH_MAX_LEVELS ];
+
+        if ( ( value = findJsonValue( line, "tolerance" ) ) != NULL && tolerance != NULL ) {
+            *tolerance = strtod( value, NULL );
+        }
+
+        if ( ( value = findJsonValue( line, "name" ) ) == NULL || *value != '"' ) {
+            continue;
+        }
+
+        if ( count == capacity ) {
+            capacity *= 2;
+            *results = realloc( *results, sizeof( benchResult_t ) * capacity );
+
+            if ( *results == NULL ) {
+                fputs( "Sem memória.\n", stderr );
+                exit( EXIT_FAILURE );
+            }
+        }
+
+        benchResult_t *  result = &( *results )[ count++ ];
+        size_t           length = strcspn( value + 1, "\"" );
+
+        *result = ( benchResult_t ){ 0 };
+        memcpy( result->name, value + 1, length < BENCH_MAX_NAME ? length : BENCH_MAX_NAME - 1 );
+
+        value = findJsonValue( line, "accesses" );
+        result->accesses = value != NULL ? strtoull( value, NULL, 10 ) : 0;
+        value = findJsonValue( line, "seconds" );
+        result->seconds = value != NULL ? strtod( value, NULL ) : 0;
+        value = findJsonValue( line, "noise" );
+        result->noise = value != NULL ? strtod( value, NULL ) : 0;
+        value = findJsonValue( line, "machine_speed" );
+        result->machineSpeed = value != NULL ? strtod( value, NULL ) : 0;
+        value = findJsonValue( line, "accesses_per_second" );
+        result->accessesPerSecond = value != NULL ? strtod( value, NULL ) : 0;
+        value = findJsonValue( line, "peak_rss_kb" );
+        result->peakRssKB = value != NULL ? strtol( value, NULL, 10 ) : 0;
+
+        result->levels = readJsonArray( line, "hits", numbers, BENCH_MAX_LEVELS );
+
+        for ( unsigned int level = 0; level < result->levels; level++ ) {
+            result->hits[ level ] = ( uint64_t )numbers[ level ];
+        }
+
+        readJsonArray( line, "misses", numbers, BENCH_MAX_LEVELS );
+
+        for ( unsigned int level = 0; level < result->levels; level++ ) {
+            result->misses[ level ] = ( uint64_t )numbers[ level ];
+        }
+    }
+
+    fclose( file );
+
+    return count;
+}
+
+static benchResult_t * findResult( benchResult_t * results, size_t count, const char * name ) {
+    for ( size_t i = 0; i < count; i++ ) {
+        if ( strcmp( results[ i ].name, name ) == 0 ) {
+            return &results[ i ];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Throughput of a result relative to the speed of the machine while it ran.
+ */
+static double relativeThroughput( const benchResult_t * result ) {
+    return result->machineSpeed > 0 ? result->accessesPerSecond / result->machineSpeed : result->accessesPerSecond;
+}
+
+/*
+ * Whether a result is timed reliably enough, in the baseline and now, to be gated on throughput.
+ */
+static bool isGated( benchResult_t * result, benchResult_t * baseline ) {
+    return baseline != NULL && result->seconds >= BENCH_MIN_GATED_SECONDS && baseline->seconds >= BENCH_MIN_GATED_SECONDS;
+}
+
+/*
+ * Whether a gated result got slower or bigger than its baseline beyond the tolerance, widened by the noise of the runs
+ * of either of them. Throughputs are compared relative to the speed of the machine.
+ */
+static bool isRegression( benchResult_t * result, benchResult_t * baseline, double tolerance ) {
+    double noise = result->noise > baseline->noise ? result->noise : baseline->noise;
+
+    return isGated( result, baseline )
+        && ( relativeThroughput( result ) < relativeThroughput( baseline ) * ( 1 - tolerance - BENCH_NOISE_FACTOR * noise )
+        || result->peakRssKB > baseline->peakRssKB * ( 1 + tolerance ) + BENCH_RSS_SLACK_KB );
+}
+
+/*
+ * Checks a result against its golden counts and its baseline, printing its line of the report. Returns whether the
+ * counts match the golden counts, and sets regression if it got slower or bigger beyond the tolerance.
+ *
+ * Benchmarks too short to be gated on throughput are reported as short, those without golden counts as new.
+ */
+static bool checkResult( benchResult_t * result, benchResult_t * golden, benchResult_t * baseline, double tolerance, bool * regression ) {
+    const char *  status = "ok";
+    bool          matches = true;
+    char          change[ 32 ] = "";
+    char          nsPerAccess[ BENCH_MAX_LEVELS ][ 16 ];
+
+    *regression = baseline != NULL && isRegression( result, baseline, tolerance );
+
+    if ( golden != NULL ) {
+        matches = result->accesses == golden->accesses && result->levels == golden->levels;
+
+        for ( unsigned int level = 0; matches && level < result->levels; level++ ) {
+            matches = result->hits[ level ] == golden->hits[ level ] && result->misses[ level ] == golden->misses[ level ];
+        }
+    }
+
+    if ( baseline != NULL && baseline->accessesPerSecond > 0 ) {
+        snprintf( change, sizeof( change ), "%+.1f%%", ( relativeThroughput( result ) / relativeThroughput( baseline ) - 1 ) * 100 );
+    }
+
+    for ( unsigned int level = 0; level < BENCH_MAX_LEVELS; level++ ) {
+        if ( level < result->levels && !isnan( result->nsPerAccess[ level ] ) ) {
+            snprintf( nsPerAccess[ level ], sizeof( nsPerAccess[ level ] ), "%.2f", result->nsPerAccess[ level ] );
+        } else {
+            snprintf( nsPerAccess[ level ], sizeof( nsPerAccess[ level ] ), "-" );
+        }
+    }
+
+    if ( !matches ) {
+        status = "MISMATCH";
+    } else if ( *regression ) {
+        status = "REGRESSION";
+    } else if ( golden == NULL ) {
+        status = "new";
+    } else if ( baseline != NULL && !isGated( result, baseline ) ) {
+        status = "short";
+    }
+
+    printf( "%-56s %10.2f %8s %6.1f%% %8s %8s %9ld  %s\n", result->name, result->accessesPerSecond / 1e6, change, result->noise * 100,
+            nsPerAccess[ 0 ], nsPerAccess[ 1 ], result->peakRssKB, status );
+
+    return matches;
+}
+
+static void printUsage( const char * program ) {
+    fprintf( stderr, "Argumentos incorretos. Utilize:\n"
+                     "%s [--golden <contagens.json>] [--baseline <baseline.json>] [--output <resultados.json>]\n"
+                     "%s [--golden <contagens.json>] --write-baseline <baseline.json>\n"
+                     "%s --write-golden <contagens.json>\n", program, program, program );
+    exit( EXIT_FAILURE );
+}
+
+int main( int argc, char * argv[] ) {
+    benchCase_t *    cases;
+    benchResult_t *  results;
+    benchResult_t *  golden = NULL;
+    benchResult_t *  baseline = NULL;
+    size_t           goldenCount = 0;
+    size_t           baselineCount = 0;
+    size_t           count;
+    double           tolerance = BENCH_DEFAULT_TOLERANCE;
+    const char *     goldenPath = NULL;
+    const char *     baselinePath = NULL;
+    const char *     outputPath = NULL;
+    bool             writeGolden = false;
+    bool             writeBaseline = false;
+    size_t           mismatches = 0;
+    size_t           regressions = 0;
+    size_t           failedChecks;
+
+    for ( int i = 1; i < argc; i++ ) {
+        if ( i + 1 == argc ) {
+            printUsage( argv[ 0 ] );
+        }
+
+        if ( strcmp( argv[ i ], "--golden" ) == 0 ) {
+            goldenPath = argv[ ++i ];
+        } else if ( strcmp( argv[ i ], "--baseline" ) == 0 ) {
+            baselinePath = argv[ ++i ];
+        } else if ( strcmp( argv[ i ], "--output" ) == 0 ) {
+            outputPath = argv[ ++i ];
+        } else if ( strcmp( argv[ i ], "--write-golden" ) == 0 ) {
+            outputPath = argv[ ++i ];
+            writeGolden = true;
+        } else if ( strcmp( argv[ i ], "--write-baseline" ) == 0 ) {
+            outputPath = argv[ ++i ];
+            writeBaseline = true;
+        } else {
+            printUsage( argv[ 0 ] );
+        }
+    }
+
+    if ( ( writeGolden && ( writeBaseline || goldenPath != NULL || baselinePath != NULL ) ) || ( writeBaseline && baselinePath != NULL ) ) {
+        printUsage( argv[ 0 ] );
+    }
+
+    if ( goldenPath != NULL ) {
+        goldenCount = readResults( goldenPath, false, &golden, NULL );
+    }
+
+    if ( baselinePath != NULL ) {
+        baselineCount = readResults( baselinePath, true, &baseline, &tolerance );
+
+        if ( baseline == NULL ) {
+            printf( "Sem baseline em %s, o desempenho não é comparado. Execute make bench-baseline para criá-la nesta máquina.\n", baselinePath );
+        }
+    }
+
+    failedChecks = runChecks();
+
+    printf( "%zu checks, %zu with levels below the option accessed differently from its misses or the results without it\n",
+            sizeof( benchChecks ) / sizeof( benchChecks[ 0 ] ), failedChecks );
+
+    count = listBenchmarks( &cases );
+    results = malloc( sizeof( benchResult_t ) * count );
+
+    if ( results == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    printf( "%-56s %10s %8s %7s %8s %8s %9s  %s\n", "benchmark", "Macc/s", "change", "noise", "L1 ns", "L2 ns", "RSS KiB", "status" );
+
+    for ( size_t i = 0; i < count; i++ ) {
+        benchResult_t *  goldenResult;
+        benchResult_t *  reference;
+        bool             regression;
+
+        runBenchmark( &cases[ i ], &results[ i ] );
+
+        goldenResult = findResult( golden, goldenCount, results[ i ].name );
+        reference = findResult( baseline, baselineCount, results[ i ].name );
+
+        for ( int retry = 0; retry < BENCH_RETRIES && reference != NULL && isRegression( &results[ i ], reference, tolerance ); retry++ ) {
+            benchResult_t again;
+
+            runBenchmark( &cases[ i ], &again );
+
+            if ( relativeThroughput( &again ) > relativeThroughput( &results[ i ] ) ) {
+                results[ i ] = again;
+            }
+        }
+
+        mismatches += !checkResult( &results[ i ], goldenPath != NULL ? goldenResult : &results[ i ], reference, tolerance, &regression );
+        regressions += regression;
+    }
+
+    if ( outputPath != NULL ) {
+        writeResults( outputPath, results, count, writeGolden );
+    }
+
+    printf( "%zu benchmarks, %zu with hit or miss counts different from the golden counts, %zu regressions beyond %.0f%% and the noise\n", count,
+            mismatches, regressions, tolerance * 100 );
+
+    free( cases );
+    free( results );
+    free( golden );
+    free( baseline );
+
+    return failedChecks > 0 || mismatches > 0 || regressions > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,496 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <math.h>
+
+#include "CacheSimulator.h"
+#include "Simulator.h"
+#include "CacheConfig.h"
+#include "Arguments.h"
+
+/* This function parses number parameters with and error checking.
+ * 
+ * It will use the strtoul function to parse the input string.
+ * 
+ * The strtoul function is considered safe to parse user-provided strings, as it will do error and security checks.
+ * 
+ * The strtoul function will automatically handle hexadecimal and octal numbers if the input string starts with "0x" or
+ * "0" respectively (and binary ("0b") if the program is compiled with C2x).
+ */
+unsigned long parseNumberInput( char * input, int index, int level ) {
+    unsigned long  number;
+    char *         endptr;
+    const char *   args[] = { NULL, "<nsets>", "<bsize>", "<assoc>", "<substituição>", "<flag_saída>", "<arquivo_de_entrada>" };
+
+    static_assert( sizeof( unsigned long ) >= sizeof( uint32_t ), "An unsigned long isn't a least 32 bits that allow any acceptable parameter values parameters to be taken. Consider using unsigned long long instead." );
+    static_assert( ERANGE != 0, "ERANGE (range-related errors) is 0, that means it will always report an error when parsing the number input, since it checks if errno is ERANGE and errno is set to 0 before the string handling that could cause the error to ensure a previous error is not caught inadvertently. A solution is to set the errno to some other value, but that may cause problems elsewhere." );
+
+    errno = 0;
+
+    #if COMPLIANCE_LEVEL < 2
+    if ( strlen( input ) >= 2 ) {
+        // Binary
+        if ( input[ 0 ] == '0' && ( input[ 1 ] == 'b' || input[ 1 ] == 'B' ) ) {
+            number = strtoul( input + 2, &endptr, 2 );
+        // Octal with prefix "0o"
+        } else if ( input[ 0 ] == '0' && ( input[ 1 ] == 'o' || input[ 1 ] == 'O' ) ) {
+            number = strtoul( input + 2, &endptr, 8 );
+        // Hexadecimal
+        } else if ( input[ 0 ] == '0' && ( input[ 1 ] == 'x' || input[ 1 ] == 'X' ) ) {
+            number = strtoul( input + 2, &endptr, 16 );
+        } else {
+            #if COMPLIANCE_LEVEL < 1
+            // Accept 0 as octal prefix
+            number = strtoul( input, &endptr, 0 );
+            #else
+            // Accept only decimals if a prefix is not present
+            number = strtoul( input, &endptr, 10 );
+            #endif
+        }
+    } else {
+        #if COMPLIANCE_LEVEL < 1
+        // Accept 0 as octal prefix
+        number = strtoul( input, &endptr, 0 );
+        #else
+        // Do not accept a single 0 as an octal prefix
+        number = strtoul( input, &endptr, 10 );
+        #endif
+    }
+    #else
+    // Only decimals allowed in very strict compliance level
+    number = strtoul( input, &endptr, 10 );
+    #endif
+    
+    if ( *endptr != '\0' || endptr == input || errno == ERANGE ) {
+        if ( level != 0 ) {
+            fprintf( stderr, "Erro: argumento \"%s\" no parâmetro %s da cache L%d não é um número válido ou aceitável.\n", input, args[ index ], level );
+            exit( EXIT_FAILURE );
+        } else {
+            fprintf( stderr, "Erro: argumento \"%s\" no parâmetro %s não é um número válido ou aceitável.\n", input, args[ index ] );
+            exit( EXIT_FAILURE );
+        }
+    }
+    
+    return number;
+}
+
+/*
+ * Parses a cache level specifier argument string and returns the corresponding cache level number.
+ */
+unsigned long parseCacheLevelSpecifier( char * input ) {
+    unsigned long  number;
+    char *         endptr;
+
+    static_assert( ERANGE != 0, "ERANGE (range-related errors) is 0, that means it will always report an error when parsing the number input, since it checks if errno is ERANGE and errno is set to 0 before the string handling that could cause the error to ensure a previous error is not caught inadvertently. A solution is to set the errno to some other value, but that may cause problems elsewhere." );
+
+    errno = 0;
+
+    number = strtoul( input + 2, &endptr, 10 );
+    
+    if ( *endptr != '\0' || endptr == input || errno == ERANGE ) {
+        fprintf( stderr, "Erro: especificador de nível de cache \"%s\" é inválido.\n", input );
+        exit( EXIT_FAILURE );
+    }
+    
+    return number;
+}
+
+/*
+ * Checks if an option at argv[ index ] is followed by the number of arguments it takes.
+ */
+void requireOptionArguments( int argc, char * argv[], int index, int count, char * usage ) {
+    if ( index + count >= argc ) {
+        fprintf( stderr, "Número de argumentos incorreto na opção %s. Utilize:\n"
+                         "[%s %s]\n", argv[ index ], argv[ index ], usage );
+        exit( EXIT_FAILURE );
+    }
+}
+
+/*
+ * Parses the numeric value of an option.
+ */
+unsigned long parseOptionNumber( char * option, char * input ) {
+    unsigned long  number;
+    char *         endptr;
+
+    errno = 0;
+
+    number = strtoul( input, &endptr, 0 );
+    
+    if ( *endptr != '\0' || endptr == input || errno == ERANGE || input[ 0 ] == '-' ) {
+        fprintf( stderr, "Erro: argumento \"%s\" da opção %s não é um número válido ou aceitável.\n", input, option );
+        exit( EXIT_FAILURE );
+    }
+    
+    return number;
+}
+
+/*
+ * Parses the non-negative real value of an option, like a latency or an energy.
+ */
+double parseOptionReal( char * option, char * input ) {
+    double  number;
+    char *  endptr;
+
+    errno = 0;
+
+    number = strtod( input, &endptr );
+
+    // The negated compare also rejects NaN
+    if ( *endptr != '\0' || endptr == input || errno == ERANGE || !( number >= 0 ) || number == HUGE_VAL ) {
+        fprintf( stderr, "Erro: argumento \"%s\" da opção %s não é um número válido ou aceitável.\n", input, option );
+        exit( EXIT_FAILURE );
+    }
+
+    return number;
+}
+
+/*
+ * Finds the configuration of a cache level given to an option, which must have been described before the option.
+ */
+cacheConfig_t * findCacheLevel( cacheConfigList_t * cacheConfigList, char * option, char * input ) {
+    unsigned long level = parseOptionNumber( option, input );
+
+    for ( cacheConfigList_t * current = cacheConfigList; current != NULL; current = current->next ) {
+        if ( current->cacheConfig.level == level ) {
+            return &current->cacheConfig;
+        }
+    }
+
+    fprintf( stderr, "Erro: a cache L%lu da opção %s não foi descrita antes dela.\n", level, option );
+    exit( EXIT_FAILURE );
+}
+
+/*
+ * This function parses the replacement policy string and returns the corresponding enum value.
+ * 
+ * Accepts lowercase letters in addition to uppercase letters as an additional feature if the compliance level is not
+ * very strict.
+ * 
+ * The accepted letters are: 'R' for RANDOM, 'L' for LRU, and 'F' for FIFO. If the compliance level is not very strict
+ * the names of the additional policies are also accepted: PLRU, NRU, SRRIP, BRRIP and DIP.
+ */
+int parseReplacementPolicy( char * subst ) {
+    #if COMPLIANCE_LEVEL < 2
+    #define ASCII_CHAR_TO_UPPER( c ) ( ( c ) & 0xDF )
+    #else
+    #define ASCII_CHAR_TO_UPPER( c ) ( c )
+    #endif
+    
+    if ( ASCII_CHAR_TO_UPPER( subst[ 0 ] ) == 'R' && subst[ 1 ] == '\0' ) {
+        return RANDOM;
+    } else if ( ASCII_CHAR_TO_UPPER( subst[ 0 ] ) == 'L' && subst[ 1 ] == '\0' ) {
+        return LRU;
+    } else if ( ASCII_CHAR_TO_UPPER( subst[ 0 ] ) == 'F' && subst[ 1 ] == '\0' ) {
+        return FIFO;
+    }
+
+    #if COMPLIANCE_LEVEL < 2
+    for ( int policy = PLRU; policy <= DIP; policy++ ) {
+        const char *  name = replacementPolicyName( policy );
+        size_t        i = 0;
+
+        while ( name[ i ] != '\0' && ASCII_CHAR_TO_UPPER( subst[ i ] ) == name[ i ] ) {
+            i++;
+        }
+
+        if ( name[ i ] == '\0' && subst[ i ] == '\0' ) {
+            return policy;
+        }
+    }
+    #endif
+
+    fprintf( stderr, "Erro: política de substituição \"%s\" não é suportada.\n", subst );
+    exit( EXIT_FAILURE );
+}
+/*
+ * Parses an argument that describes the cache hierarchy at argv[ index ], like a lower cache level in the format
+ * -l<level> <nsets> <bsize> <assoc> <substituição>, and adds it to the list of cache configurations, --3c, which
+ * enables exact miss classification, --seed <semente>, which seeds the generators of RANDOM replacement, or
+ * --write <nível> <WB|WT> <WA|NWA>, which sets the write policies of a level already described, --timing <nível>
+ * <latência> <penalidade> <energia>, which sets the latencies and energy of a level already described, --memory
+ * <latência> <energia>, which sets the latency and energy of memory, or --prefetch <nível> <NEXT|STRIDE|STREAM> <grau>
+ * <distância>, which attaches a prefetcher to a level already described, --victim <nível> <VICTIM|MISS> <entradas>,
+ * which attaches a victim or miss cache to a level already described, --partition <nível> <núcleo> <WAYS|SETS>
+ * <máscara>, which restricts a tenant to some ways or sets of a level already described, or --inclusion
+ * <NINE|INCLUSIVE|EXCLUSIVE>, which sets the inclusion policy of the hierarchy.
+ *
+ * The same arguments are accepted on the command line and in sweep configuration files.
+ *
+ * Returns the number of arguments taken or 0 if argv[ index ] is not a cache hierarchy argument.
+ */
+int parseHierarchyArgument( int argc, char * argv[], int index, cacheConfigList_t ** cacheConfigList ) {
+    cacheConfig_t  cacheConfig;
+    unsigned long  cacheLevel;
+
+    if ( argv[ index ][ 0 ] == '-' && argv[ index ][ 1 ] == 'l' ) {
+        cacheLevel = parseCacheLevelSpecifier( argv[ index ] );
+
+        if ( argc < index + 5 ) {
+            fprintf( stderr, "Número de argumentos incorreto na cache L%s. Utilize:\n"
+                             "[-l<level> <nsets> <bsize> <assoc> <substituição>]\n", argv[ index ] + 2 );
+            exit( EXIT_FAILURE );
+        }
+
+        cacheConfig = ( cacheConfig_t ){
+            .nsets = ( uint32_t )parseNumberInput( argv[ index + 1 ], 1, cacheLevel ),
+            .bsize = ( uint32_t )parseNumberInput( argv[ index + 2 ], 2, cacheLevel ),
+            .assoc = ( uint32_t )parseNumberInput( argv[ index + 3 ], 3, cacheLevel ),
+            .replacementPolicy = parseReplacementPolicy( argv[ index + 4 ] ),
+            .level = cacheLevel,
+            .exactMissClassification = ( *cacheConfigList )->cacheConfig.exactMissClassification,
+            .seed = ( *cacheConfigList )->cacheConfig.seed,
+            .memoryLatency = ( *cacheConfigList )->cacheConfig.memoryLatency,
+            .memoryEnergy = ( *cacheConfigList )->cacheConfig.memoryEnergy,
+            .inclusionPolicy = ( *cacheConfigList )->cacheConfig.inclusionPolicy,
+            .reportInclusion = ( *cacheConfigList )->cacheConfig.reportInclusion
+        };
+
+        pushCacheConfig( cacheConfigList, &cacheConfig );
+
+        return 5;
+    }
+
+    // Exact miss classification applies to the whole hierarchy, levels added later inherit it
+    if ( strcmp( argv[ index ], "--3c" ) == 0 ) {
+        for ( cacheConfigList_t * current = *cacheConfigList; current != NULL; current = current->next ) {
+            current->cacheConfig.exactMissClassification = true;
+        }
+
+        return 1;
+    }
+
+    // The seed also applies to the whole hierarchy, each level derives its own sequence from it
+    if ( strcmp( argv[ index ], "--seed" ) == 0 ) {
+        requireOptionArguments( argc, argv, index, 1, "<semente>" );
+
+        uint64_t seed = ( uint64_t )parseOptionNumber( argv[ index ], argv[ index + 1 ] );
+
+        for ( cacheConfigList_t * current = *cacheConfigList; current != NULL; current = current->next ) {
+            current->cacheConfig.seed = seed;
+        }
+
+        return 2;
+    }
+
+    // Write policies are set per level, the default is write-back with write-allocate
+    if ( strcmp( argv[ index ], "--write" ) == 0 ) {
+        requireOptionArguments( argc, argv, index, 3, "<nível> <WB|WT> <WA|NWA>" );
+
+        cacheConfig_t * levelConfig = findCacheLevel( *cacheConfigList, argv[ index ], argv[ index + 1 ] );
+
+        if ( strcmp( argv[ index + 2 ], "WB" ) != 0 && strcmp( argv[ index + 2 ], "WT" ) != 0 ) {
+            fprintf( stderr, "Erro: política de escrita \"%s\" não é suportada, utilize WB ou WT.\n", argv[ index + 2 ] );
+            exit( EXIT_FAILURE );
+        }
+
+        if ( strcmp( argv[ index + 3 ], "WA" ) != 0 && strcmp( argv[ index + 3 ], "NWA" ) != 0 ) {
+            fprintf( stderr, "Erro: política de alocação \"%s\" não é suportada, utilize WA ou NWA.\n", argv[ index + 3 ] );
+            exit( EXIT_FAILURE );
+        }
+
+        levelConfig->writeThrough = strcmp( argv[ index + 2 ], "WT" ) == 0;
+        levelConfig->noWriteAllocate = strcmp( argv[ index + 3 ], "NWA" ) == 0;
+
+        return 4;
+    }
+
+    if ( strcmp( argv[ index ], "--timing" ) == 0 ) {
+        requireOptionArguments( argc, argv, index, 4, "<nível> <latência> <penalidade> <energia>" );
+
+        cacheConfig_t * levelConfig = findCacheLevel( *cacheConfigList, argv[ index ], argv[ index + 1 ] );
+
+        levelConfig->hitLatency = parseOptionReal( argv[ index ], argv[ index + 2 ] );
+        levelConfig->missPenalty = parseOptionReal( argv[ index ], argv[ index + 3 ] );
+        levelConfig->accessEnergy = parseOptionReal( argv[ index ], argv[ index + 4 ] );
+
+        return 5;
+    }
+
+    // Victim and miss caches are attached per level, between the level and the next one
+    if ( strcmp( argv[ index ], "--victim" ) == 0 ) {
+        requireOptionArguments( argc, argv, index, 3, "<nível> <VICTIM|MISS> <entradas>" );
+
+        cacheConfig_t * levelConfig = findCacheLevel( *cacheConfigList, argv[ index ], argv[ index + 1 ] );
+        int             kind = VICTIM_CACHE_NONE;
+
+        for ( int candidate = VICTIM_CACHE; candidate <= MISS_CACHE; candidate++ ) {
+            if ( strcmp( argv[ index + 2 ], victimCacheName( candidate ) ) == 0 ) {
+                kind = candidate;
+            }
+        }
+
+        if ( kind == VICTIM_CACHE_NONE ) {
+            fprintf( stderr, "Erro: cache de vítimas \"%s\" não é suportada, utilize VICTIM ou MISS.\n", argv[ index + 2 ] );
+            exit( EXIT_FAILURE );
+        }
+
+        unsigned long entries = parseOptionNumber( argv[ index ], argv[ index + 3 ] );
+
+        if ( entries < 1 || entries > VICTIM_CACHE_MAX_ENTRIES ) {
+            fprintf( stderr, "Erro: o número de entradas da opção %s deve estar entre 1 e %d.\n", argv[ index ], VICTIM_CACHE_MAX_ENTRIES );
+            exit( EXIT_FAILURE );
+        }
+
+        levelConfig->victimCache = kind;
+        levelConfig->victimEntries = ( uint32_t )entries;
+
+        return 4;
+    }
+
+    // Partitions are set per level and tenant, the default is every way and set for every tenant
+    if ( strcmp( argv[ index ], "--partition" ) == 0 ) {
+        requireOptionArguments( argc, argv, index, 4, "<nível> <núcleo> <WAYS|SETS> <máscara>" );
+
+        cacheConfig_t * levelConfig = findCacheLevel( *cacheConfigList, argv[ index ], argv[ index + 1 ] );
+        unsigned long   tenant = parseOptionNumber( argv[ index ], argv[ index + 2 ] );
+        unsigned long   mask = parseOptionNumber( argv[ index ], argv[ index + 4 ] );
+
+        if ( tenant >= PARTITION_MAX_TENANTS ) {
+            fprintf( stderr, "Erro: o núcleo da opção %s deve estar entre 0 e %d.\n", argv[ index ], PARTITION_MAX_TENANTS - 1 );
+            exit( EXIT_FAILURE );
+        }
+
+        if ( mask == 0 ) {
+            fprintf( stderr, "Erro: a máscara da opção %s não pode ser 0.\n", argv[ index ] );
+            exit( EXIT_FAILURE );
+        }
+
+        if ( strcmp( argv[ index + 3 ], "WAYS" ) == 0 ) {
+            levelConfig->wayMasks[ tenant ] = mask;
+        } else if ( strcmp( argv[ index + 3 ], "SETS" ) == 0 ) {
+            levelConfig->setMasks[ tenant ] = mask;
+        } else {
+            fprintf( stderr, "Erro: partição \"%s\" não é suportada, utilize WAYS ou SETS.\n", argv[ index + 3 ] );
+            exit( EXIT_FAILURE );
+        }
+
+        levelConfig->partitioned = true;
+
+        return 5;
+    }
+
+    // The inclusion policy applies to the whole hierarchy, levels added later inherit it
+    if ( strcmp( argv[ index ], "--inclusion" ) == 0 ) {
+        requireOptionArguments( argc, argv, index, 1, "<NINE|INCLUSIVE|EXCLUSIVE>" );
+
+        int inclusionPolicy = -1;
+
+        for ( int candidate = INCLUSION_NINE; candidate <= INCLUSION_EXCLUSIVE; candidate++ ) {
+            if ( strcmp( argv[ index + 1 ], inclusionPolicyName( candidate ) ) == 0 ) {
+                inclusionPolicy = candidate;
+            }
+        }
+
+        if ( inclusionPolicy < 0 ) {
+            fprintf( stderr, "Erro: política de inclusão \"%s\" não é suportada, utilize NINE, INCLUSIVE ou EXCLUSIVE.\n", argv[ index + 1 ] );
+            exit( EXIT_FAILURE );
+        }
+
+        for ( cacheConfigList_t * current = *cacheConfigList; current != NULL; current = current->next ) {
+            current->cacheConfig.inclusionPolicy = inclusionPolicy;
+            current->cacheConfig.reportInclusion = true;
+        }
+
+        return 2;
+    }
+
+    // Prefetchers are set per level, the default is no prefetcher
+    if ( strcmp( argv[ index ], "--prefetch" ) == 0 ) {
+        requireOptionArguments( argc, argv, index, 4, "<nível> <NEXT|STRIDE|STREAM> <grau> <distância>" );
+
+        cacheConfig_t * levelConfig = findCacheLevel( *cacheConfigList, argv[ index ], argv[ index + 1 ] );
+        int             kind = PREFETCH_NONE;
+
+        for ( int candidate = PREFETCH_NEXT; candidate <= PREFETCH_STREAM; candidate++ ) {
+            if ( strcmp( argv[ index + 2 ], prefetcherName( candidate ) ) == 0 ) {
+                kind = candidate;
+            }
+        }
+
+        if ( kind == PREFETCH_NONE ) {
+            fprintf( stderr, "Erro: prefetcher \"%s\" não é suportado, utilize NEXT, STRIDE ou STREAM.\n", argv[ index + 2 ] );
+            exit( EXIT_FAILURE );
+        }
+
+        unsigned long degree = parseOptionNumber( argv[ index ], argv[ index + 3 ] );
+        unsigned long distance = parseOptionNumber( argv[ index ], argv[ index + 4 ] );
+
+        if ( degree < 1 || degree > PREFETCH_MAX_DEGREE ) {
+            fprintf( stderr, "Erro: o grau da opção %s deve estar entre 1 e %d.\n", argv[ index ], PREFETCH_MAX_DEGREE );
+            exit( EXIT_FAILURE );
+        }
+
+        if ( distance < 1 || distance > UINT32_MAX ) {
+            fprintf( stderr, "Erro: a distância da opção %s deve estar entre 1 e %" PRIu32 " blocos.\n", argv[ index ], UINT32_MAX );
+            exit( EXIT_FAILURE );
+        }
+
+        levelConfig->prefetcher = kind;
+        levelConfig->prefetchDegree = ( uint32_t )degree;
+        levelConfig->prefetchDistance = ( uint32_t )distance;
+
+        return 5;
+    }
+
+    // Memory is behind the whole hierarchy, levels added later inherit it so it's always known by the last level
+    if ( strcmp( argv[ index ], "--memory" ) == 0 ) {
+        requireOptionArguments( argc, argv, index, 2, "<latência> <energia>" );
+
+        double latency = parseOptionReal( argv[ index ], argv[ index + 1 ] );
+        double energy = parseOptionReal( argv[ index ], argv[ index + 2 ] );
+
+        for ( cacheConfigList_t * current = *cacheConfigList; current != NULL; current = current->next ) {
+            current->cacheConfig.memoryLatency = latency;
+            current->cacheConfig.memoryEnergy = energy;
+        }
+
+        return 3;
+    }
+
+    return 0;
+}
+
+/*
+ * Gets the name that selects an inclusion policy in the --inclusion option.
+ */
+const char * inclusionPolicyName( int inclusionPolicy ) {
+    switch ( inclusionPolicy ) {
+        case INCLUSION_INCLUSIVE:
+            return "INCLUSIVE";
+        case INCLUSION_EXCLUSIVE:
+            return "EXCLUSIVE";
+        default:
+            return "NINE";
+    }
+}
+
+/*
+ * Gets the letter that selects a replacement policy, the inverse of parseReplacementPolicy.
+ */
+const char * replacementPolicyName( int replacementPolicy ) {
+    switch ( replacementPolicy ) {
+        case RANDOM:
+            return "R";
+        case LRU:
+            return "L";
+        case FIFO:
+            return "F";
+        case PLRU:
+            return "PLRU";
+        case NRU:
+            return "NRU";
+        case SRRIP:
+            return "SRRIP";
+        case BRRIP:
+            return "BRRIP";
+        case DIP:
+            return "DIP";
+        default:
+            return "?";
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef ARGUMENTS_H
+#define ARGUMENTS_H
+
+#include "CacheConfig.h"
+
+unsigned long  parseNumberInput( char * input, int index, int level );
+int            parseReplacementPolicy( char * subst );
+const char *   replacementPolicyName( int replacementPolicy );
+const char *   inclusionPolicyName( int inclusionPolicy );
+unsigned long  parseCacheLevelSpecifier( char * input );
+unsigned long  parseOptionNumber( char * option, char * input );
+double         parseOptionReal( char * option, char * input );
+void           requireOptionArguments( int argc, char * argv[], int index, int count, char * usage );
+int            parseHierarchyArgument( int argc, char * argv[], int index, cacheConfigList_t ** cacheConfigList );
+cacheConfig_t * findCacheLevel( cacheConfigList_t * cacheConfigList, char * option, char * input );
+
+#endif
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "BlockMap.h"
+
+/*
+ * Fibonacci hashing, spreads the consecutive block addresses of a trace over the whole table.
+ */
+static inline uint32_t blockMapBucket( blockMap_t * map, uint32_t block ) {
+    return ( uint32_t )( ( block * UINT32_C( 0x9E3779B1 ) ) >> map->shift );
+}
+
+static void allocateBlockMap( blockMap_t * map, uint32_t capacity ) {
+    map->capacity = capacity;
+    map->size = 0;
+    map->shift = 32;
+
+    while ( capacity > 1 ) {
+        capacity >>= 1;
+        map->shift--;
+    }
+
+    map->keys = malloc( sizeof( uint32_t ) * map->capacity );
+    map->values = malloc( sizeof( uint32_t ) * map->capacity );
+
+    if ( map->keys == NULL || map->values == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( uint32_t i = 0; i < map->capacity; i++ ) {
+        map->values[ i ] = BLOCK_MAP_EMPTY;
+    }
+}
+
+/*
+ * Initializes an empty block map, the capacity is rounded up to a power of 2.
+ */
+void initializeBlockMap( blockMap_t * map, uint32_t initialCapacity ) {
+    uint32_t capacity = 16;
+
+    while ( capacity < initialCapacity && capacity < ( UINT32_C( 1 ) << 31 ) ) {
+        capacity <<= 1;
+    }
+
+    allocateBlockMap( map, capacity );
+}
+
+void destroyBlockMap( blockMap_t * map ) {
+    free( map->keys );
+    free( map->values );
+}
+
+/*
+ * Finds the value of a block, returns NULL if the block is not in the map.
+ *
+ * The returned pointer is valid until the next insertion or removal.
+ */
+uint32_t * blockMapFind( blockMap_t * map, uint32_t block ) {
+    uint32_t bucket = blockMapBucket( map, block );
+
+    while ( map->values[ bucket ] != BLOCK_MAP_EMPTY ) {
+        if ( map->keys[ bucket ] == block ) {
+            return &map->values[ bucket ];
+        }
+
+        bucket = ( bucket + 1 ) & ( map->capacity - 1 );
+    }
+
+    return NULL;
+}
+
+/*
+ * Doubles the capacity of a block map, keeping the load factor at or below 1/2.
+ */
+static void growBlockMap( blockMap_t * map ) {
+    uint32_t *  keys = map->keys;
+    uint32_t *  values = map->values;
+    uint32_t    capacity = map->capacity;
+
+    if ( capacity >= ( UINT32_C( 1 ) << 31 ) ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    allocateBlockMap( map, capacity * 2 );
+
+    for ( uint32_t i = 0; i < capacity; i++ ) {
+        if ( values[ i ] != BLOCK_MAP_EMPTY ) {
+            blockMapInsert( map, keys[ i ], values[ i ] );
+        }
+    }
+
+    free( keys );
+    free( values );
+}
+
+/*
+ * Inserts a block in the map or replaces its value, returns a pointer to the value.
+ *
+ * The returned pointer is valid until the next insertion or removal.
+ */
+uint32_t * blockMapInsert( blockMap_t * map, uint32_t block, uint32_t value ) {
+    if ( ( map->size + 1 ) * 2 > map->capacity ) {
+        growBlockMap( map );
+    }
+
+    uint32_t bucket = blockMapBucket( map, block );
+
+    while ( map->values[ bucket ] != BLOCK_MAP_EMPTY ) {
+        if ( map->keys[ bucket ] == block ) {
+            map->values[ bucket ] = value;
+
+            return &map->values[ bucket ];
+        }
+
+        bucket = ( bucket + 1 ) & ( map->capacity - 1 );
+    }
+
+    map->keys[ bucket ] = block;
+    map->values[ bucket ] = value;
+    map->size++;
+
+    return &map->values[ bucket ];
+}
+
+/*
+ * Removes a block from the map, if it's in the map.
+ *
+ * Uses backward shift deletion, so lookups never have to skip deleted buckets.
+ */
+void blockMapRemove( blockMap_t * map, uint32_t block ) {
+    uint32_t mask = map->capacity - 1;
+    uint32_t bucket = blockMapBucket( map, block );
+
+    while ( map->values[ bucket ] != BLOCK_MAP_EMPTY && map->keys[ bucket ] != block ) {
+        bucket = ( bucket + 1 ) & mask;
+    }
+
+    if ( map->values[ bucket ] == BLOCK_MAP_EMPTY ) {
+        return;
+    }
+
+    // Move back the following entries of the cluster that would not be found past the hole
+    uint32_t hole = bucket;
+
+    for ( uint32_t next = ( hole + 1 ) & mask; map->values[ next ] != BLOCK_MAP_EMPTY; next = ( next + 1 ) & mask ) {
+        uint32_t home = blockMapBucket( map, map->keys[ next ] );
+
+        // The entry can fill the hole if its home bucket is not cyclically in ( hole, next ]
+        if ( ( ( next - home ) & mask ) >= ( ( next - hole ) & mask ) ) {
+            map->keys[ hole ] = map->keys[ next ];
+            map->values[ hole ] = map->values[ next ];
+            hole = next;
+        }
+    }
+
+    map->values[ hole ] = BLOCK_MAP_EMPTY;
+    map->size--;
+}
@@ -0,0 +1,29 @@
+#ifndef BLOCK_MAP_H
+#define BLOCK_MAP_H
+
+#include <inttypes.h>
+
+// Value of a block that is not in the map
+#define BLOCK_MAP_EMPTY UINT32_MAX
+
+/*
+ * Open addressing hash map from block addresses to 32-bit values, used to keep per block state of blocks seen in a
+ * trace.
+ *
+ * BLOCK_MAP_EMPTY can't be stored as a value, it marks empty buckets.
+ */
+typedef struct _blockMap_t {
+    uint32_t *  keys;
+    uint32_t *  values;
+    uint32_t    capacity; // Always a power of 2
+    uint32_t    size;
+    uint32_t    shift;
+} blockMap_t;
+
+void initializeBlockMap( blockMap_t * map, uint32_t initialCapacity );
+void destroyBlockMap( blockMap_t * map );
+uint32_t * blockMapFind( blockMap_t * map, uint32_t block );
+uint32_t * blockMapInsert( blockMap_t * map, uint32_t block, uint32_t value );
+void blockMapRemove( blockMap_t * map, uint32_t block );
+
+#endif
@@ -5,6 +5,7 @@
 
 #include "CacheSimulator.h"
 #include "CacheConfig.h"
+#include "Simulator.h"
 
 void initializeCacheConfigList( cacheConfigList_t ** head, cacheConfig_t * cacheConfig ) {
     *head = malloc( sizeof( cacheConfigList_t ) );
@@ -63,72 +64,112 @@ bool isPowerOfTwo(uint32_t num) {
 }
 
 /*
- * Verifies if a list of cache configurations is valid.
+ * Checks if a list of cache configurations is valid.
+ *
+ * If it isn't, message is filled with the reason in up to messageSize characters.
  */
-void verifyCacheConfig( cacheConfigList_t * head ) {
+bool checkCacheConfig( cacheConfigList_t * head, char * message, size_t messageSize ) {
     uint32_t             size;
     uint32_t             previousSize = 0;
     unsigned long        currentLevel = 1;
     cacheConfigList_t *  current = head;
 
     if ( head == NULL ) {
-        fputs( "Não há nenhum nível de cache configurado.\n", stderr );
-        exit( EXIT_FAILURE );
+        snprintf( message, messageSize, "Não há nenhum nível de cache configurado." );
+        return false;
     }
 
     // The first cache level must be L1
     if ( head->cacheConfig.level != 1 ) {
-        fputs( "A cache L1 não foi configurada.\n", stderr );
-        exit( EXIT_FAILURE );
+        snprintf( message, messageSize, "A cache L1 não foi configurada." );
+        return false;
     }
 
     while ( current != NULL ) {
         // If there are cache levels missing, the cache configuration is invalid
         if ( current->cacheConfig.level != currentLevel ) {
-            fprintf( stderr, "Cache L%lu não está configurada, enquanto L%lu está.\n", currentLevel, current->cacheConfig.level );
-            exit( EXIT_FAILURE );
+            snprintf( message, messageSize, "Cache L%lu não está configurada, enquanto L%lu está.", currentLevel, current->cacheConfig.level );
+            return false;
         }
 
         size = current->cacheConfig.nsets * current->cacheConfig.bsize * current->cacheConfig.assoc;
 
         // The size of the cache must not be zero
         if ( size == 0 ) {
-            fprintf( stderr, "O tamanho da cache L%lu é zero.\n", current->cacheConfig.level );
-            exit( EXIT_FAILURE );
+            snprintf( message, messageSize, "O tamanho da cache L%lu é zero.", current->cacheConfig.level );
+            return false;
         }
 
         // The size of the cache must not be smaller than the previous level
         if ( size < previousSize ) {
-            fprintf( stderr, "O tamanho da cache L%lu (%" PRIu32 ") é menor que o tamanho da cache L%lu (%" PRIu32 ").\n", current->cacheConfig.level, size, current->cacheConfig.level - 1, previousSize );
-            exit( EXIT_FAILURE );
+            snprintf( message, messageSize, "O tamanho da cache L%lu (%" PRIu32 ") é menor que o tamanho da cache L%lu (%" PRIu32 ").", current->cacheConfig.level, size, current->cacheConfig.level - 1, previousSize );
+            return false;
         }
 
         // bsize must be a power of 2
         if ( !isPowerOfTwo(current->cacheConfig.bsize ) ) {
-            fprintf( stderr, "O valor de <bsize> (%" PRIu32 ") da cache L%lu não é uma potência de 2.\n", current->cacheConfig.bsize, current->cacheConfig.level );
-            exit( EXIT_FAILURE );
+            snprintf( message, messageSize, "O valor de <bsize> (%" PRIu32 ") da cache L%lu não é uma potência de 2.", current->cacheConfig.bsize, current->cacheConfig.level );
+            return false;
         }
 
         // assoc must be a power of 2
         if ( !isPowerOfTwo(current->cacheConfig.assoc ) ) {
-            fprintf( stderr, "O valor de <assoc> (%" PRIu32 ") da cache L%lu não é uma potência de 2.\n", current->cacheConfig.assoc, current->cacheConfig.level );
-            exit( EXIT_FAILURE );
+            snprintf( message, messageSize, "O valor de <assoc> (%" PRIu32 ") da cache L%lu não é uma potência de 2.", current->cacheConfig.assoc, current->cacheConfig.level );
+            return false;
         }
 
         // nsets must be a power of 2
         if ( !isPowerOfTwo( current->cacheConfig.nsets ) ) {
-            fprintf( stderr, "O valor de <nsets> (%" PRIu32 ") da cache L%lu não é uma potência de 2.\n", current->cacheConfig.nsets, current->cacheConfig.level );
-            exit( EXIT_FAILURE );
+            snprintf( message, messageSize, "O valor de <nsets> (%" PRIu32 ") da cache L%lu não é uma potência de 2.", current->cacheConfig.nsets, current->cacheConfig.level );
+            return false;
+        }
+
+        // Blocks move between the levels of an exclusive hierarchy, so they must fit a line of every level
+        if ( current->cacheConfig.inclusionPolicy == INCLUSION_EXCLUSIVE && current->cacheConfig.bsize != head->cacheConfig.bsize ) {
+            snprintf( message, messageSize, "A hierarquia exclusiva precisa do mesmo <bsize> em todos os níveis, o da cache L%lu (%" PRIu32 ") é diferente do da cache L1 (%" PRIu32 ").", current->cacheConfig.level, current->cacheConfig.bsize, head->cacheConfig.bsize );
+            return false;
+        }
+
+        // Way masks have a bit per way and set masks a bit per group of sets
+        for ( unsigned int tenant = 0; current->cacheConfig.partitioned && tenant < PARTITION_MAX_TENANTS; tenant++ ) {
+            uint64_t  wayMask = current->cacheConfig.wayMasks[ tenant ];
+            uint64_t  setMask = current->cacheConfig.setMasks[ tenant ];
+            uint32_t  assoc = current->cacheConfig.assoc;
+            uint32_t  groups = current->cacheConfig.nsets < PARTITION_SET_GROUPS ? current->cacheConfig.nsets : PARTITION_SET_GROUPS;
+
+            if ( wayMask != 0 && ( assoc > 64 || ( assoc < 64 && ( wayMask >> assoc ) != 0 ) ) ) {
+                snprintf( message, messageSize, "A máscara de vias do núcleo %u na cache L%lu tem bits além das %" PRIu32 " vias do nível, até 64 vias são suportadas.", tenant, current->cacheConfig.level, assoc );
+                return false;
+            }
+
+            if ( setMask != 0 && groups < 64 && ( setMask >> groups ) != 0 ) {
+                snprintf( message, messageSize, "A máscara de conjuntos do núcleo %u na cache L%lu tem bits além dos %" PRIu32 " grupos de conjuntos do nível.", tenant, current->cacheConfig.level, groups );
+                return false;
+            }
         }
 
         currentLevel++;
         current = current->next;
         previousSize = size;
     }
+
+    return true;
 }
 
 /*
- * Destroys a list of cache configurations.
+ * Verifies if a list of cache configurations is valid, exits with an error message if it isn't.
+ */
+void verifyCacheConfig( cacheConfigList_t * head ) {
+    char message[ 256 ];
+
+    if ( !checkCacheConfig( head, message, sizeof( message ) ) ) {
+        fprintf( stderr, "%s\n", message );
+        exit( EXIT_FAILURE );
+    }
+}
+
+/*
+ * Destroys a list of cache configurations, and the hotspot profiles of its levels.
  */
 void destroyCacheConfigList( cacheConfigList_t * head ) {
     cacheConfigList_t * current = head;
@@ -136,7 +177,25 @@ void destroyCacheConfigList( cacheConfigList_t * head ) {
 
     while ( current != NULL ) {
         next = current->next;
+
+        if ( current->cacheConfig.hotspots != NULL ) {
+            destroyHotspotProfile( current->cacheConfig.hotspots );
+        }
+
         free( current );
         current = next;
     }
 }
+
+/*
+ * Counts the levels in a list of cache configurations.
+ */
+unsigned long countCacheLevels( cacheConfigList_t * head ) {
+    unsigned long count = 0;
+
+    for ( cacheConfigList_t * current = head; current != NULL; current = current->next ) {
+        count++;
+    }
+
+    return count;
+}
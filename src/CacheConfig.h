@@ -2,6 +2,14 @@
 #define CACHE_CONFIG_H
 
 #include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Tenants that a level can be partitioned between, the cores of a multi-core simulation, see TenantPartition.c
+#define PARTITION_MAX_TENANTS 64
+
+// Groups of sets selected by the bits of a set mask, caches with fewer sets have one group per set
+#define PARTITION_SET_GROUPS 64
 
 typedef struct _cacheConfig_t {
     uint32_t       nsets;
@@ -9,6 +17,28 @@ typedef struct _cacheConfig_t {
     uint32_t       assoc;
     int            replacementPolicy;
     unsigned long  level;
+    bool           exactMissClassification; // Classify misses with a MissClassifier, set for every level
+    uint64_t       seed;                    // Seed of the RANDOM replacement generators, set for every level
+    uint32_t       addressBits;             // Significant bits of 64-bit addresses, 0 for 32-bit addresses
+    bool           writeThrough;            // Writes go to the next level on hits too, instead of marking the line dirty
+    bool           noWriteAllocate;         // Write misses go to the next level without filling a line
+    double         hitLatency;              // Cycles of every access to the level, see estimatePerformance
+    double         missPenalty;             // Cycles added to every miss of the level besides the levels below it
+    double         accessEnergy;            // Energy of every access to the level, in nJ
+    double         memoryLatency;           // Cycles of every access to memory, set for every level
+    double         memoryEnergy;            // Energy of every access to memory, in nJ, set for every level
+    int            prefetcher;              // See prefetcherKind_t, PREFETCH_NONE by default
+    uint32_t       prefetchDegree;          // Blocks issued per prefetch trigger
+    uint32_t       prefetchDistance;        // Blocks ahead of the access that prefetches go
+    int            victimCache;             // See victimCacheKind_t, VICTIM_CACHE_NONE by default
+    uint32_t       victimEntries;           // Entries of the victim or miss cache
+    int            inclusionPolicy;         // See inclusionPolicy_t, INCLUSION_NINE by default, set for every level
+    bool           reportInclusion;         // Measure the effective capacity of the hierarchy, set for every level
+    bool           partitioned;             // Any tenant has a way or set mask
+    uint64_t       wayMasks[ PARTITION_MAX_TENANTS ]; // Ways each tenant may fill, 0 for all of them
+    uint64_t       setMasks[ PARTITION_MAX_TENANTS ]; // Groups of sets the blocks of each tenant map to, 0 for all of them
+    uint32_t       hotspotTop;              // Blocks of the top-K list of the hotspot profile, 0 if the level has none
+    struct _hotspotProfile_t * hotspots;    // Profile filled by the simulation and freed with the list, see HotspotProfile.c
 } cacheConfig_t;
 
 typedef struct _cacheConfigList_t {
@@ -18,7 +48,9 @@ typedef struct _cacheConfigList_t {
 
 void initializeCacheConfigList( cacheConfigList_t ** head, cacheConfig_t * cacheConfig );
 void pushCacheConfig( cacheConfigList_t ** head, cacheConfig_t * cacheConfig );
+bool checkCacheConfig( cacheConfigList_t * head, char * message, size_t messageSize );
 void verifyCacheConfig( cacheConfigList_t * head );
 void destroyCacheConfigList( cacheConfigList_t * head );
+unsigned long countCacheLevels( cacheConfigList_t * head );
 
 #endif
\ No newline at end of file
@@ -0,0 +1,447 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "CacheSimulator.h"
+#include "CompressedTrace.h"
+#include "FileHandler.h"
+#include "Parallel.h"
+
+/*
+ * Reads little-endian integers from a byte array, independently of the host byte order.
+ */
+static inline uint32_t readLittleEndian32( const uint8_t * data ) {
+    return ( uint32_t )data[ 0 ] | ( ( uint32_t )data[ 1 ] << 8 ) | ( ( uint32_t )data[ 2 ] << 16 ) | ( ( uint32_t )data[ 3 ] << 24 );
+}
+
+static inline uint64_t readLittleEndian64( const uint8_t * data ) {
+    return ( uint64_t )readLittleEndian32( data ) | ( ( uint64_t )readLittleEndian32( data + 4 ) << 32 );
+}
+
+/*
+ * Writes little-endian integers to a byte array, independently of the host byte order.
+ */
+static inline void writeLittleEndian32( uint8_t * data, uint32_t value ) {
+    data[ 0 ] = ( uint8_t )value;
+    data[ 1 ] = ( uint8_t )( value >> 8 );
+    data[ 2 ] = ( uint8_t )( value >> 16 );
+    data[ 3 ] = ( uint8_t )( value >> 24 );
+}
+
+static inline void writeLittleEndian64( uint8_t * data, uint64_t value ) {
+    writeLittleEndian32( data, ( uint32_t )value );
+    writeLittleEndian32( data + 4, ( uint32_t )( value >> 32 ) );
+}
+
+/*
+ * Maps signed deltas to unsigned numbers so small negative deltas are also encoded with few bytes.
+ */
+static inline uint32_t zigzagEncode( uint32_t delta ) {
+    return ( delta << 1 ) ^ ( uint32_t )( -( int32_t )( delta >> 31 ) );
+}
+
+static inline uint32_t zigzagDecode( uint32_t value ) {
+    return ( value >> 1 ) ^ ( uint32_t )( -( int32_t )( value & 1 ) );
+}
+
+static inline uint8_t * writeVarint( uint8_t * data, uint64_t value ) {
+    while ( value >= 0x80 ) {
+        *data++ = ( uint8_t )( value | 0x80 );
+        value >>= 7;
+    }
+
+    *data++ = ( uint8_t )value;
+
+    return data;
+}
+
+/*
+ * Reads a varint of at most 5 bytes, returns NULL if the varint is longer or runs past the end of the data.
+ */
+static inline const uint8_t * readVarint( const uint8_t * data, const uint8_t * end, uint64_t * value ) {
+    uint64_t result = 0;
+
+    for ( unsigned int shift = 0; shift < 35 && data < end; shift += 7 ) {
+        uint8_t byte = *data++;
+
+        result |= ( uint64_t )( byte & 0x7F ) << shift;
+
+        if ( ( byte & 0x80 ) == 0 ) {
+            *value = result;
+
+            return data;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Checks if a file is a compressed trace by its magic number and length.
+ *
+ * The file position is restored.
+ */
+bool isCompressedTrace( FILE * file ) {
+    char  magic[ 4 ];
+    long  position = ftell( file );
+    bool  compressed;
+
+    compressed = fread( magic, 1, sizeof( magic ), file ) == sizeof( magic ) && memcmp( magic, COMPRESSED_TRACE_MAGIC, sizeof( magic ) ) == 0;
+
+    fseek( file, position, SEEK_SET );
+
+    return compressed && getFileSize( file ) % 4 != 0;
+}
+
+/*
+ * Reads and validates the header and block index of a compressed trace.
+ *
+ * The blocks array of the trace is dynamically allocated, it's freed by destroyCompressedTrace.
+ */
+void readCompressedTraceIndex( FILE * file, char * filePath, compressedTrace_t * trace ) {
+    uint8_t   header[ COMPRESSED_TRACE_HEADER_SIZE ];
+    uint8_t   entry[ COMPRESSED_TRACE_INDEX_ENTRY_SIZE ];
+    size_t    fileSize = getFileSize( file );
+    uint64_t  offset;
+    uint64_t  addressCount = 0;
+
+    if ( fread( header, 1, sizeof( header ), file ) < sizeof( header ) || memcmp( header, COMPRESSED_TRACE_MAGIC, 4 ) != 0 ) {
+        fprintf( stderr, "%s: compressed trace header is corrupted.\n", filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( ( header[ 4 ] | ( header[ 5 ] << 8 ) ) != COMPRESSED_TRACE_VERSION ) {
+        fprintf( stderr, "%s: compressed trace version is not supported.\n", filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    trace->blockSize = readLittleEndian32( header + 8 );
+    trace->blockCount = readLittleEndian32( header + 12 );
+    trace->addressCount = readLittleEndian64( header + 16 );
+    trace->dataLength = readLittleEndian64( header + 24 );
+
+    offset = COMPRESSED_TRACE_HEADER_SIZE + ( uint64_t )trace->blockCount * COMPRESSED_TRACE_INDEX_ENTRY_SIZE;
+
+    // The file must be the data followed by 1 to 3 bytes of padding
+    if ( trace->blockSize == 0 || trace->dataLength < offset || trace->dataLength >= fileSize || fileSize - trace->dataLength > 3 ) {
+        fprintf( stderr, "%s: compressed trace header is corrupted.\n", filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    trace->blocks = malloc( sizeof( compressedBlock_t ) * ( trace->blockCount > 0 ? trace->blockCount : 1 ) );
+
+    if ( trace->blocks == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    // The blocks must follow each other with no gaps and add up to the address count
+    for ( uint32_t i = 0; i < trace->blockCount; i++ ) {
+        if ( fread( entry, 1, sizeof( entry ), file ) < sizeof( entry ) ) {
+            fprintf( stderr, "%s: compressed trace index is corrupted.\n", filePath );
+            exit( EXIT_FAILURE );
+        }
+
+        trace->blocks[ i ].offset = readLittleEndian64( entry );
+        trace->blocks[ i ].length = readLittleEndian32( entry + 8 );
+        trace->blocks[ i ].count = readLittleEndian32( entry + 12 );
+
+        if ( trace->blocks[ i ].offset != offset || trace->blocks[ i ].count > trace->blockSize ) {
+            fprintf( stderr, "%s: compressed trace index is corrupted.\n", filePath );
+            exit( EXIT_FAILURE );
+        }
+
+        offset += trace->blocks[ i ].length;
+        addressCount += trace->blocks[ i ].count;
+    }
+
+    if ( offset != trace->dataLength || addressCount != trace->addressCount ) {
+        fprintf( stderr, "%s: compressed trace index is corrupted.\n", filePath );
+        exit( EXIT_FAILURE );
+    }
+}
+
+/*
+ * Destroys the block index of a compressed trace.
+ */
+void destroyCompressedTrace( compressedTrace_t * trace ) {
+    free( trace->blocks );
+    trace->blocks = NULL;
+}
+
+/*
+ * Encodes a block of addresses.
+ *
+ * data must have room for COMPRESSED_BLOCK_MAX_SIZE( count ) bytes. Returns the length of the encoded block.
+ */
+size_t encodeCompressedBlock( const uint32_t * addresses, uint32_t count, uint8_t * data ) {
+    uint8_t *  current = data;
+    uint32_t   previous = 0;
+    uint32_t   previousDelta = 0;
+    uint32_t   i = 0;
+
+    while ( i < count ) {
+        uint32_t delta = addresses[ i ] - previous;
+
+        if ( delta == previousDelta ) {
+            uint32_t run = 1;
+
+            // Extend the run while the delta repeats
+            while ( i + run < count && addresses[ i + run ] - addresses[ i + run - 1 ] == previousDelta ) {
+                run++;
+            }
+
+            current = writeVarint( current, ( ( uint64_t )( run - 1 ) << 1 ) | 1 );
+
+            i += run;
+        } else {
+            current = writeVarint( current, ( uint64_t )zigzagEncode( delta ) << 1 );
+
+            previousDelta = delta;
+
+            i++;
+        }
+
+        previous = addresses[ i - 1 ];
+    }
+
+    return current - data;
+}
+
+/*
+ * Decodes a block of addresses.
+ *
+ * Returns false if the block is corrupted, that is, if it doesn't decode to exactly count addresses.
+ */
+bool decodeCompressedBlock( const uint8_t * data, size_t length, uint32_t * addresses, uint32_t count ) {
+    const uint8_t *  end = data + length;
+    uint32_t         previous = 0;
+    uint32_t         previousDelta = 0;
+    uint32_t         i = 0;
+    uint64_t         token;
+
+    while ( data < end ) {
+        // Fast path for 1 byte literals, the most common token in strided traces
+        if ( ( *data & 0x81 ) == 0 && i < count ) {
+            previousDelta = zigzagDecode( *data >> 1 );
+            previous += previousDelta;
+            addresses[ i++ ] = previous;
+            data++;
+
+            continue;
+        }
+
+        data = readVarint( data, end, &token );
+
+        if ( data == NULL ) {
+            return false;
+        }
+
+        if ( token & 1 ) {
+            uint64_t run = ( token >> 1 ) + 1;
+
+            if ( run > count - i ) {
+                return false;
+            }
+
+            for ( uint64_t j = 0; j < run; j++ ) {
+                previous += previousDelta;
+                addresses[ i++ ] = previous;
+            }
+        } else {
+            if ( i == count || ( token >> 1 ) > UINT32_MAX ) {
+                return false;
+            }
+
+            previousDelta = zigzagDecode( ( uint32_t )( token >> 1 ) );
+            previous += previousDelta;
+            addresses[ i++ ] = previous;
+        }
+    }
+
+    return i == count;
+}
+
+typedef struct _compressedTraceWriter_t {
+    uint32_t *  addresses;
+    size_t      size;
+    uint8_t **  blocks;
+    size_t *    lengths;
+} compressedTraceWriter_t;
+
+static void encodeCompressedBlockTask( void * context, unsigned int index ) {
+    compressedTraceWriter_t *  writer = context;
+    size_t                     first = ( size_t )index * COMPRESSED_TRACE_BLOCK_SIZE;
+    uint32_t                   count = writer->size - first < COMPRESSED_TRACE_BLOCK_SIZE ? ( uint32_t )( writer->size - first ) : COMPRESSED_TRACE_BLOCK_SIZE;
+
+    writer->blocks[ index ] = malloc( COMPRESSED_BLOCK_MAX_SIZE( count ) );
+
+    if ( writer->blocks[ index ] == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    writer->lengths[ index ] = encodeCompressedBlock( writer->addresses + first, count, writer->blocks[ index ] );
+}
+
+/*
+ * Writes an array of addresses to a compressed trace file.
+ *
+ * The blocks are encoded in parallel and then written in order.
+ */
+void writeCompressedTrace( char * filePath, uint32_t * addresses, size_t size ) {
+    compressedTraceWriter_t  writer = { .addresses = addresses, .size = size };
+    uint32_t                 blockCount = ( uint32_t )( ( size + COMPRESSED_TRACE_BLOCK_SIZE - 1 ) / COMPRESSED_TRACE_BLOCK_SIZE );
+    uint8_t                  header[ COMPRESSED_TRACE_HEADER_SIZE ] = { 0 };
+    uint8_t                  entry[ COMPRESSED_TRACE_INDEX_ENTRY_SIZE ];
+    const uint8_t            padding[ 3 ] = { 0 };
+    uint64_t                 offset = COMPRESSED_TRACE_HEADER_SIZE + ( uint64_t )blockCount * COMPRESSED_TRACE_INDEX_ENTRY_SIZE;
+    FILE *                   file;
+
+    writer.blocks = malloc( sizeof( uint8_t * ) * ( blockCount > 0 ? blockCount : 1 ) );
+    writer.lengths = malloc( sizeof( size_t ) * ( blockCount > 0 ? blockCount : 1 ) );
+
+    if ( writer.blocks == NULL || writer.lengths == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    parallelFor( blockCount, encodeCompressedBlockTask, &writer );
+
+    file = fopen( filePath, "wb" );
+
+    if ( file == NULL ) {
+        perror( filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    uint64_t dataLength = offset;
+
+    for ( uint32_t i = 0; i < blockCount; i++ ) {
+        dataLength += writer.lengths[ i ];
+    }
+
+    memcpy( header, COMPRESSED_TRACE_MAGIC, 4 );
+    header[ 4 ] = COMPRESSED_TRACE_VERSION & 0xFF;
+    header[ 5 ] = COMPRESSED_TRACE_VERSION >> 8;
+    writeLittleEndian32( header + 8, COMPRESSED_TRACE_BLOCK_SIZE );
+    writeLittleEndian32( header + 12, blockCount );
+    writeLittleEndian64( header + 16, size );
+    writeLittleEndian64( header + 24, dataLength );
+
+    if ( fwrite( header, 1, sizeof( header ), file ) < sizeof( header ) ) {
+        perror( filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( uint32_t i = 0; i < blockCount; i++ ) {
+        uint32_t count = i == blockCount - 1 ? ( uint32_t )( size - ( size_t )i * COMPRESSED_TRACE_BLOCK_SIZE ) : COMPRESSED_TRACE_BLOCK_SIZE;
+
+        writeLittleEndian64( entry, offset );
+        writeLittleEndian32( entry + 8, ( uint32_t )writer.lengths[ i ] );
+        writeLittleEndian32( entry + 12, count );
+
+        if ( fwrite( entry, 1, sizeof( entry ), file ) < sizeof( entry ) ) {
+            perror( filePath );
+            exit( EXIT_FAILURE );
+        }
+
+        offset += writer.lengths[ i ];
+    }
+
+    for ( uint32_t i = 0; i < blockCount; i++ ) {
+        if ( fwrite( writer.blocks[ i ], 1, writer.lengths[ i ], file ) < writer.lengths[ i ] ) {
+            perror( filePath );
+            exit( EXIT_FAILURE );
+        }
+
+        free( writer.blocks[ i ] );
+    }
+
+    // Pad the file so its length isn't a multiple of 4
+    if ( fwrite( padding, 1, dataLength % 4 == 3 ? 2 : 1, file ) < 1 ) {
+        perror( filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    fclose( file );
+
+    free( writer.blocks );
+    free( writer.lengths );
+}
+
+/*
+ * Opens a reader that decodes a compressed trace sequentially, keeping only one block in memory.
+ */
+void openCompressedTraceReader( compressedTraceReader_t * reader, FILE * file, char * filePath ) {
+    reader->file = file;
+    reader->filePath = filePath;
+    reader->block = 0;
+    reader->position = 0;
+    reader->decodedCount = 0;
+
+    readCompressedTraceIndex( file, filePath, &reader->trace );
+
+    reader->data = malloc( COMPRESSED_BLOCK_MAX_SIZE( reader->trace.blockSize ) );
+    reader->decoded = malloc( sizeof( uint32_t ) * reader->trace.blockSize );
+
+    if ( reader->data == NULL || reader->decoded == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+}
+
+/*
+ * Reads up to maxAddresses addresses from a compressed trace reader.
+ *
+ * Returns the number of addresses read, which is only less than maxAddresses at the end of the trace.
+ */
+size_t readCompressedAddresses( compressedTraceReader_t * reader, uint32_t * addresses, size_t maxAddresses ) {
+    size_t size = 0;
+
+    while ( size < maxAddresses ) {
+        // Decode the next block when the current one is exhausted
+        if ( reader->position == reader->decodedCount ) {
+            if ( reader->block == reader->trace.blockCount ) {
+                break;
+            }
+
+            compressedBlock_t * block = &reader->trace.blocks[ reader->block ];
+
+            if ( block->length > COMPRESSED_BLOCK_MAX_SIZE( reader->trace.blockSize )
+                 || fseek( reader->file, ( long )block->offset, SEEK_SET ) != 0
+                 || fread( reader->data, 1, block->length, reader->file ) < block->length
+                 || !decodeCompressedBlock( reader->data, block->length, reader->decoded, block->count ) ) {
+                fprintf( stderr, "%s: compressed trace block %" PRIu32 " is corrupted.\n", reader->filePath, reader->block );
+                exit( EXIT_FAILURE );
+            }
+
+            reader->block++;
+            reader->position = 0;
+            reader->decodedCount = block->count;
+
+            continue;
+        }
+
+        size_t available = reader->decodedCount - reader->position;
+        size_t copied = available < maxAddresses - size ? available : maxAddresses - size;
+
+        memcpy( addresses + size, reader->decoded + reader->position, copied * sizeof( uint32_t ) );
+
+        size += copied;
+        reader->position += copied;
+    }
+
+    return size;
+}
+
+/*
+ * Closes a compressed trace reader, the file itself is not closed.
+ */
+void closeCompressedTraceReader( compressedTraceReader_t * reader ) {
+    destroyCompressedTrace( &reader->trace );
+    free( reader->data );
+    free( reader->decoded );
+}
@@ -0,0 +1,73 @@
+#ifndef COMPRESSED_TRACE_H
+#define COMPRESSED_TRACE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+/*
+ * Compressed trace file layout, all fields are little-endian:
+ *
+ * Header (COMPRESSED_TRACE_HEADER_SIZE bytes):
+ *   magic (4 bytes, COMPRESSED_TRACE_MAGIC), version (u16), reserved (u16), block size in addresses (u32),
+ *   block count (u32), address count (u64), data length in bytes (u64).
+ * Index (COMPRESSED_TRACE_INDEX_ENTRY_SIZE bytes per block):
+ *   offset of the block in the file (u64), length of the block in bytes (u32), addresses in the block (u32).
+ * Blocks:
+ *   a sequence of varint tokens, each block is decoded independently of the others.
+ * Padding:
+ *   1 to 3 bytes so the length of the file is never a multiple of 4. A compressed trace is therefore never a valid
+ *   binary trace, and detecting it by its magic number can't change how a valid binary trace is read.
+ *
+ * Each token of a block is an unsigned LEB128 varint. If its lowest bit is 0 the rest of the token is a zigzag encoded
+ * delta from the previous address, if it's 1 the rest of the token plus 1 is a number of times the previous delta
+ * repeats. The previous address and delta are 0 at the beginning of a block.
+ */
+#define COMPRESSED_TRACE_MAGIC "ACTR"
+#define COMPRESSED_TRACE_VERSION 1
+#define COMPRESSED_TRACE_BLOCK_SIZE ( 1 << 16 )
+#define COMPRESSED_TRACE_HEADER_SIZE 32
+#define COMPRESSED_TRACE_INDEX_ENTRY_SIZE 16
+
+// Maximum length in bytes of an encoded block, every address takes at most a 5 byte token
+#define COMPRESSED_BLOCK_MAX_SIZE( count ) ( ( size_t )( count ) * 5 )
+
+typedef struct _compressedBlock_t {
+    uint64_t  offset;
+    uint32_t  length;
+    uint32_t  count;
+} compressedBlock_t;
+
+typedef struct _compressedTrace_t {
+    uint32_t             blockSize;
+    uint32_t             blockCount;
+    uint64_t             addressCount;
+    uint64_t             dataLength;
+    compressedBlock_t *  blocks;
+} compressedTrace_t;
+
+/*
+ * Reads the addresses of a compressed trace sequentially, one block at a time.
+ */
+typedef struct _compressedTraceReader_t {
+    FILE *             file;
+    char *             filePath;
+    compressedTrace_t  trace;
+    uint32_t           block;    // Next block to be decoded
+    uint8_t *          data;     // Encoded block
+    uint32_t *         decoded;  // Decoded block
+    uint32_t           position; // Next address of the decoded block to be read
+    uint32_t           decodedCount;
+} compressedTraceReader_t;
+
+bool isCompressedTrace( FILE * file );
+void readCompressedTraceIndex( FILE * file, char * filePath, compressedTrace_t * trace );
+void destroyCompressedTrace( compressedTrace_t * trace );
+size_t encodeCompressedBlock( const uint32_t * addresses, uint32_t count, uint8_t * data );
+bool decodeCompressedBlock( const uint8_t * data, size_t length, uint32_t * addresses, uint32_t count );
+void writeCompressedTrace( char * filePath, uint32_t * addresses, size_t size );
+void openCompressedTraceReader( compressedTraceReader_t * reader, FILE * file, char * filePath );
+size_t readCompressedAddresses( compressedTraceReader_t * reader, uint32_t * addresses, size_t maxAddresses );
+void closeCompressedTraceReader( compressedTraceReader_t * reader );
+
+#endif
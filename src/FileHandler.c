@@ -2,8 +2,42 @@
 #include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define HAS_MMAP 1
+#else
+#define HAS_MMAP 0
+#endif
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#include <immintrin.h>
+#define HAS_X86_SIMD 1
+#else
+#define HAS_X86_SIMD 0
+#endif
 
 #include "CacheSimulator.h"
+#include "FileHandler.h"
+#include "CompressedTrace.h"
+#include "Parallel.h"
+
+/*
+ * A memory mapped region returned to the caller in place of a malloc'd array.
+ *
+ * The mapped regions are kept in a list so releaseFile knows whether to munmap or free an array.
+ */
+typedef struct _mappedFile_t {
+    void *                  base;
+    size_t                  length;
+    struct _mappedFile_t *  next;
+} mappedFile_t;
+
+static mappedFile_t * mappedFiles = NULL;
 
 /*
  * Gets the size of a file.
@@ -53,131 +87,1116 @@ static inline uint32_t bigEndianToLittleEndian( uint32_t value ) {
 }
 
 /*
- * Reads a binary file containing 32-bit addressed and stores them in an array.
+ * Checks if the host is big-endian, in which case the values in binary files are already in the host byte order.
+ */
+static inline int isHostBigEndian( void ) {
+    #if defined( __BYTE_ORDER__ ) && defined( __ORDER_BIG_ENDIAN__ )
+    return __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+    #else
+    const uint32_t probe = 1;
+
+    return *( const unsigned char * )&probe == 0;
+    #endif
+}
+
+/*
+ * Converts an array of 32-bit big-endian values to little-endian one value at a time.
  *
- * The array is dynamically allocated, caller is responsible for freeing it.
- * 
- * Addresses is dereferenced with the newly allocated array and size is dereferenced with the number of elements in the array.
+ * Used for the tail of the vectorized conversions and on hosts without SIMD support.
  */
-void handleBinaryFile( char * filePath, uint32_t ** addresses, size_t * size ) {
-    FILE * file = fopen( filePath, "rb" );
-    
-    if ( file == NULL ) {
-        perror( filePath );
-        exit( EXIT_FAILURE );
+static void swapWordsScalar( uint32_t * words, size_t count ) {
+    for ( size_t i = 0; i < count; i++ ) {
+        words[ i ] = bigEndianToLittleEndian( words[ i ] );
+    }
+}
+
+#if HAS_X86_SIMD
+/*
+ * Converts an array of 32-bit big-endian values to little-endian 4 values at a time with SSSE3 byte shuffles.
+ */
+__attribute__(( target( "ssse3" ) ))
+static void swapWordsSSSE3( uint32_t * words, size_t count ) {
+    const __m128i  mask = _mm_setr_epi8( 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 );
+    size_t         i = 0;
+
+    for ( ; i + 4 <= count; i += 4 ) {
+        __m128i value = _mm_loadu_si128( ( __m128i * )( words + i ) );
+        _mm_storeu_si128( ( __m128i * )( words + i ), _mm_shuffle_epi8( value, mask ) );
+    }
+
+    swapWordsScalar( words + i, count - i );
+}
+
+/*
+ * Converts an array of 32-bit big-endian values to little-endian 16 values at a time with AVX2 byte shuffles.
+ *
+ * The loop is unrolled twice so two independent shuffles are in flight for each iteration.
+ */
+__attribute__(( target( "avx2" ) ))
+static void swapWordsAVX2( uint32_t * words, size_t count ) {
+    const __m256i  mask = _mm256_setr_epi8( 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 );
+    size_t         i = 0;
+
+    for ( ; i + 16 <= count; i += 16 ) {
+        __m256i low = _mm256_loadu_si256( ( __m256i * )( words + i ) );
+        __m256i high = _mm256_loadu_si256( ( __m256i * )( words + i + 8 ) );
+        _mm256_storeu_si256( ( __m256i * )( words + i ), _mm256_shuffle_epi8( low, mask ) );
+        _mm256_storeu_si256( ( __m256i * )( words + i + 8 ), _mm256_shuffle_epi8( high, mask ) );
+    }
+
+    swapWordsScalar( words + i, count - i );
+}
+#endif
+
+/*
+ * Converts an array of 32-bit big-endian values to the host byte order in place.
+ *
+ * The widest byte shuffle supported by the CPU running the program is picked at runtime, so the same executable runs
+ * on any x86 CPU. On big-endian hosts nothing has to be done.
+ */
+void bigEndianToHost( uint32_t * words, size_t count ) {
+    if ( isHostBigEndian() ) {
         return;
     }
-    
-    size_t fileSize = getFileSize( file );
-    *size = fileSize / 4;
 
-    // Checks if the file is composed of a whole number of 32-bit addresses
-    if ( fileSize % 4 != 0 ) {
-        fprintf( stderr, "%s: binary file is not composed of a whole number of 32-bit addressed.\n", filePath );
-        exit( EXIT_FAILURE );
+    #if HAS_X86_SIMD
+    if ( __builtin_cpu_supports( "avx2" ) ) {
+        swapWordsAVX2( words, count );
+        return;
     }
-    
-    *addresses = malloc( *size * sizeof( uint32_t ) );
 
-    if ( *addresses == NULL ) {
+    if ( __builtin_cpu_supports( "ssse3" ) ) {
+        swapWordsSSSE3( words, count );
+        return;
+    }
+    #endif
+
+    swapWordsScalar( words, count );
+}
+
+/*
+ * Converts an array of 64-bit big-endian values to the host byte order in place.
+ *
+ * Each value is two 32-bit big-endian words with the most significant first, so the words are converted with
+ * bigEndianToHost and then swapped.
+ */
+void bigEndianToHost64( uint64_t * values, size_t count ) {
+    if ( isHostBigEndian() ) {
+        return;
+    }
+
+    bigEndianToHost( ( uint32_t * )values, count * 2 );
+
+    for ( size_t i = 0; i < count; i++ ) {
+        values[ i ] = ( values[ i ] >> 32 ) | ( values[ i ] << 32 );
+    }
+}
+
+/*
+ * Maps a file in memory with private copy-on-write pages, so its values can be converted in place without changing
+ * the file.
+ *
+ * Returns NULL if the file can't be mapped, in which case the caller should fall back to reading the file.
+ */
+static void * mapFile( int fileDescriptor, size_t length ) {
+    #if HAS_MMAP
+    // Empty files can't be mapped
+    if ( length == 0 ) {
+        return NULL;
+    }
+
+    void * base = mmap( NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0 );
+
+    if ( base == MAP_FAILED ) {
+        return NULL;
+    }
+
+    // The file is read front to back exactly once, so aggressive read ahead is helpful
+    madvise( base, length, MADV_SEQUENTIAL );
+
+    mappedFile_t * mappedFile = malloc( sizeof( mappedFile_t ) );
+
+    if ( mappedFile == NULL ) {
         fputs( "Sem memória.\n", stderr );
         exit( EXIT_FAILURE );
     }
 
-    // Copies all the addresses to the array correcting the endianess
-    for ( size_t i = 0; i < *size; i++ ) {
-        uint32_t value;
-        
-        if ( fread( &value, sizeof( uint32_t ), 1, file ) < 1 ) {
-            perror( filePath );
-            exit( EXIT_FAILURE );
+    mappedFile->base = base;
+    mappedFile->length = length;
+    mappedFile->next = mappedFiles;
+    mappedFiles = mappedFile;
+
+    return base;
+    #else
+    ( void )fileDescriptor;
+    ( void )length;
+
+    return NULL;
+    #endif
+}
+
+/*
+ * Releases an array returned by any of the file handling functions.
+ *
+ * Arrays may be either memory mapped files or malloc'd arrays, so they must not be passed to free directly.
+ */
+void releaseFile( void * values ) {
+    mappedFile_t *  current = mappedFiles;
+    mappedFile_t *  previous = NULL;
+
+    while ( current != NULL ) {
+        if ( current->base == values ) {
+            if ( previous == NULL ) {
+                mappedFiles = current->next;
+            } else {
+                previous->next = current->next;
+            }
+
+            #if HAS_MMAP
+            munmap( current->base, current->length );
+            #endif
+
+            free( current );
+
+            return;
         }
-        
-        value = bigEndianToLittleEndian( value );
-        ( *addresses )[ i ] = value;
+
+        previous = current;
+        current = current->next;
     }
 
-    fclose( file );
+    free( values );
 }
 
 /*
- * Reads a text file containing 32-bit addresses in base 10 and stores them in an array.
+ * Reads a binary file containing addresses of valueSize bytes into an array with a single read.
  *
- * The array is dynamically allocated, caller is responsible for freeing it.
- * 
- * Values is dereferenced with the newly allocated array and size is dereferenced with the number of elements in the array.
+ * Used when the file can't be memory mapped.
  */
-void handleTextFile( char * filePath, uint32_t ** values, size_t * size ) {
-    FILE * file = fopen( filePath, "r" );
-    
-    if ( file == NULL ) {
+static void * readBinaryFile( FILE * file, char * filePath, size_t size, size_t valueSize ) {
+    // Allocate at least one element so a valid pointer is returned for empty files
+    void * addresses = malloc( ( size > 0 ? size : 1 ) * valueSize );
+
+    if ( addresses == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( fread( addresses, valueSize, size, file ) < size ) {
         perror( filePath );
         exit( EXIT_FAILURE );
     }
 
-    // The number of elements in the array is unknown since it can't be derived from the file size like in binary files, so 128 values are allocated initially
-    size_t allocatedSize = 128;
-    *values = malloc( allocatedSize * sizeof( uint32_t ) );
+    return addresses;
+}
 
-    if ( *values == NULL ) {
-        fputs( "Sem memória.\n", stderr );
+/*
+ * Loads a binary file containing big-endian addresses of valueSize bytes, 4 or 8, in an array in the host byte order.
+ *
+ * The file is memory mapped and its values are converted to the host byte order in place, so the trace isn't copied to
+ * a separate buffer. On little-endian hosts each page is copied on write as it's converted and its copy takes the place
+ * of the page of the file in the mapping, so the trace is in memory once, and on big-endian hosts nothing is written
+ * and nothing is copied. If the file can't be mapped it's read in a single call to fread instead.
+ */
+static void * loadBinaryFile( char * filePath, size_t valueSize, size_t * size ) {
+    FILE *  file = fopen( filePath, "rb" );
+    void *  addresses;
+    
+    if ( file == NULL ) {
+        perror( filePath );
         exit( EXIT_FAILURE );
     }
+    
+    size_t fileSize = getFileSize( file );
+    *size = fileSize / valueSize;
 
-    uint32_t value;
-    *size = 0;
+    // Checks if the file is composed of a whole number of addresses
+    if ( fileSize % valueSize != 0 ) {
+        fprintf( stderr, "%s: binary file is not composed of a whole number of %zu-bit addressed.\n", filePath, valueSize * 8 );
+        exit( EXIT_FAILURE );
+    }
 
-    // Reads all the values in the file and stores them in the array
-    while ( fscanf( file, "%u", &value ) > 0 ) {     
-        // Checks if there is space left in the allocated array, if there isn't, the array is reallocated with double the size
-        if ( *size + 1 > allocatedSize ) {
-            allocatedSize *= 2;
-            *values = realloc( *values, allocatedSize * sizeof( uint32_t ) );
+    #if HAS_MMAP
+    addresses = mapFile( fileno( file ), fileSize );
+    #else
+    addresses = NULL;
+    #endif
 
-            if ( *values == NULL ) {
-                fputs( "Sem memória.\n", stderr );
-                exit( EXIT_FAILURE );
-            }
-        }
+    if ( addresses == NULL ) {
+        addresses = readBinaryFile( file, filePath, *size, valueSize );
+    }
 
-        ( *values )[ *size ] = value;
-        ( *size )++;
-    };
+    // Correct the endianess of all the addresses at once
+    if ( valueSize == sizeof( uint64_t ) ) {
+        bigEndianToHost64( addresses, *size );
+    } else {
+        bigEndianToHost( addresses, *size );
+    }
 
     fclose( file );
+
+    return addresses;
 }
 
 /*
- * Reads a binary or text file containing 32-bit addresses and stores them in an array.
- *
- * The file type is automatically detected based on the file extension, .txt for text files and anything else or no
- * extension for binary files.
+ * Reads a binary file containing 32-bit addressed and stores them in an array.
  *
- * The array is dynamically allocated, caller is responsible for freeing it.
+ * The array must be released with releaseFile.
  * 
- * values is dereferenced with the newly allocated array and size is dereferenced with the number of elements in the array.
+ * Addresses is dereferenced with the newly allocated array and size is dereferenced with the number of elements in the array.
  */
-void handleFile( char * filePath, uint32_t ** values, size_t * size ) {
-    #if COMPLIANCE_LEVEL < 1
-    // Get the file extension string
-    char * extension = strrchr( filePath, '.' );
-    
-    if ( extension != NULL ) {
-        // Handle text files
-        if ( strcmp( extension, ".txt" ) == 0 ) {
-            handleTextFile( filePath, values, size );
-        // Handle binary files if the extension is not .txt
+void handleBinaryFile( char * filePath, uint32_t ** addresses, size_t * size ) {
+    *addresses = loadBinaryFile( filePath, sizeof( uint32_t ), size );
+}
+
+/*
+ * Reads a binary file containing 64-bit big-endian addresses and stores them in an array, like handleBinaryFile.
+ */
+void handleBinaryFile64( char * filePath, uint64_t ** addresses, size_t * size ) {
+    *addresses = loadBinaryFile( filePath, sizeof( uint64_t ), size );
+}
+
+/*
+ * Loads the contents of a file to be read only.
+ *
+ * The file is memory mapped, or read in a single call to fread if it can't be mapped. mapped is dereferenced with
+ * whether the file was mapped, which must be passed to unloadFileContents.
+ */
+static void * loadFileContents( FILE * file, char * filePath, size_t fileSize, bool * mapped ) {
+    void * contents = NULL;
+
+    #if HAS_MMAP
+    if ( fileSize > 0 ) {
+        contents = mmap( NULL, fileSize, PROT_READ, MAP_PRIVATE, fileno( file ), 0 );
+
+        if ( contents == MAP_FAILED ) {
+            contents = NULL;
         } else {
-            handleBinaryFile( filePath, values, size );
+            madvise( contents, fileSize, MADV_SEQUENTIAL );
         }
-    // No file extension
-    } else {
-        handleBinaryFile( filePath, values, size );
     }
-    #else
-    /* If the compliance level is strict, only handle binary files, since text files are not supported, all files are
-     * treated as binary, even if they have a .txt extension.
-     */
-    handleBinaryFile( filePath, values, size );
     #endif
-}
\ No newline at end of file
+
+    *mapped = contents != NULL;
+
+    if ( !*mapped ) {
+        contents = malloc( fileSize > 0 ? fileSize : 1 );
+
+        if ( contents == NULL ) {
+            fputs( "Sem memória.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+
+        rewind( file );
+
+        if ( fread( contents, 1, fileSize, file ) < fileSize ) {
+            perror( filePath );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    return contents;
+}
+
+/*
+ * Unloads the contents of a file loaded with loadFileContents.
+ */
+static void unloadFileContents( void * contents, size_t fileSize, bool mapped ) {
+    if ( mapped ) {
+        #if HAS_MMAP
+        munmap( contents, fileSize );
+        #endif
+    } else {
+        ( void )fileSize;
+
+        free( contents );
+    }
+}
+
+// Minimum number of bytes of a text file parsed by each thread, smaller files are parsed by fewer threads
+#define TEXT_PIECE_MIN_SIZE ( 1 << 20 )
+
+/*
+ * A piece of a text file parsed by a single thread.
+ *
+ * Pieces always start at the beginning of a number, so they can be parsed independently of each other.
+ */
+typedef struct _textPiece_t {
+    const char *  begin;
+    const char *  end;
+    size_t        count;     // Number of numbers found when counting
+    size_t        offset;    // Position of the first number of the piece in the values array
+    size_t        parsed;    // Number of numbers actually parsed
+    bool          truncated; // Parsing stopped at something that is not a number
+} textPiece_t;
+
+typedef struct _textFile_t {
+    textPiece_t *  pieces;
+    void *         values;
+    size_t         valueSize; // 4 for 32-bit values, 8 for 64-bit values
+} textFile_t;
+
+/*
+ * Checks if a character is a white-space character, the same characters skipped by fscanf.
+ */
+static inline bool isTextSpace( char c ) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool isDecimalDigit( char c ) {
+    return ( unsigned char )( c - '0' ) < 10;
+}
+
+/*
+ * Gets the value of a hexadecimal digit or 16 if the character is not a hexadecimal digit.
+ */
+static inline uint32_t hexDigitValue( char c ) {
+    if ( isDecimalDigit( c ) ) {
+        return c - '0';
+    }
+
+    c |= 0x20; // ASCII lowercase
+
+    if ( c >= 'a' && c <= 'f' ) {
+        return c - 'a' + 10;
+    }
+
+    return 16;
+}
+
+/*
+ * Parses 8 decimal digits at once with SWAR (SIMD within a register) arithmetic.
+ *
+ * Returns false without parsing if any of the 8 characters is not a decimal digit. The characters are loaded as a
+ * little-endian word, so this is only used on little-endian hosts.
+ */
+static inline bool parseEightDigits( const char * text, uint32_t * value ) {
+    uint64_t word;
+
+    memcpy( &word, text, sizeof( word ) );
+
+    // All bytes must be between 0x30 and 0x39
+    if ( ( ( word & 0xF0F0F0F0F0F0F0F0 ) | ( ( ( word + 0x0606060606060606 ) & 0xF0F0F0F0F0F0F0F0 ) >> 4 ) ) != 0x3333333333333333 ) {
+        return false;
+    }
+
+    word -= 0x3030303030303030;
+    word = ( word * 10 ) + ( word >> 8 );
+    word = ( ( ( word & 0x000000FF000000FF ) * ( 100 + ( 1000000ULL << 32 ) ) ) + ( ( ( word >> 16 ) & 0x000000FF000000FF ) * ( 1 + ( 10000ULL << 32 ) ) ) ) >> 32;
+
+    *value = ( uint32_t )word;
+
+    return true;
+}
+
+/*
+ * Counts the numbers in a piece of a text file by counting the transitions from white-space to anything else.
+ */
+static size_t countTextNumbers( const char * begin, const char * end ) {
+    size_t  count = 0;
+    bool    previousSpace = true;
+
+    for ( const char * c = begin; c < end; c++ ) {
+        bool space = isTextSpace( *c );
+
+        count += previousSpace & !space;
+        previousSpace = space;
+    }
+
+    return count;
+}
+
+/*
+ * Parses the decimal and hexadecimal (with a "0x" prefix) numbers of a piece of a text file.
+ *
+ * Like fscanf, parsing stops at the first thing that is not a number. A number immediately followed by something that
+ * is not white-space is still parsed. Numbers are parsed in 64 bits and stored in values of valueSize bytes, so 32-bit
+ * values wrap around like they would if they were parsed in 32 bits.
+ */
+static void parseTextPiece( textPiece_t * piece, void * values, size_t valueSize ) {
+    const char *  c = piece->begin;
+    const char *  end = piece->end;
+    size_t        parsed = 0;
+
+    piece->truncated = false;
+
+    while ( true ) {
+        while ( c < end && isTextSpace( *c ) ) {
+            c++;
+        }
+
+        if ( c == end ) {
+            break;
+        }
+
+        if ( !isDecimalDigit( *c ) ) {
+            piece->truncated = true;
+            break;
+        }
+
+        uint64_t value = 0;
+
+        if ( c[ 0 ] == '0' && c + 2 < end && ( c[ 1 ] | 0x20 ) == 'x' && hexDigitValue( c[ 2 ] ) < 16 ) {
+            uint32_t digit;
+
+            for ( c += 2; c < end && ( digit = hexDigitValue( *c ) ) < 16; c++ ) {
+                value = ( value << 4 ) | digit;
+            }
+        } else {
+            uint32_t eightDigits;
+
+            #if defined( __BYTE_ORDER__ ) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            if ( c + 8 <= end && parseEightDigits( c, &eightDigits ) ) {
+                value = eightDigits;
+                c += 8;
+            }
+            #else
+            ( void )eightDigits;
+            #endif
+
+            for ( ; c < end && isDecimalDigit( *c ); c++ ) {
+                value = value * 10 + ( *c - '0' );
+            }
+        }
+
+        if ( valueSize == sizeof( uint64_t ) ) {
+            ( ( uint64_t * )values )[ parsed ] = value;
+        } else {
+            ( ( uint32_t * )values )[ parsed ] = ( uint32_t )value;
+        }
+
+        parsed++;
+
+        if ( c < end && !isTextSpace( *c ) ) {
+            piece->truncated = true;
+            break;
+        }
+    }
+
+    piece->parsed = parsed;
+}
+
+static void countTextPieceTask( void * context, unsigned int index ) {
+    textFile_t * textFile = context;
+
+    textFile->pieces[ index ].count = countTextNumbers( textFile->pieces[ index ].begin, textFile->pieces[ index ].end );
+}
+
+static void parseTextPieceTask( void * context, unsigned int index ) {
+    textFile_t * textFile = context;
+
+    parseTextPiece( &textFile->pieces[ index ], ( char * )textFile->values + textFile->pieces[ index ].offset * textFile->valueSize, textFile->valueSize );
+}
+
+/*
+ * Parses the numbers in the text of a text file into an array.
+ *
+ * The text is split in pieces at white-space, and the pieces are parsed in two passes on multiple threads. The first
+ * pass counts the numbers of each piece so the array can be allocated once and every piece knows where its numbers go,
+ * the second pass parses the numbers straight into the array, of values of valueSize bytes.
+ */
+static void * parseText( const char * text, size_t length, size_t valueSize, size_t * size ) {
+    textFile_t    textFile = { .valueSize = valueSize };
+    unsigned int  pieceCount = getThreadCount();
+    size_t        total = 0;
+
+    if ( pieceCount > length / TEXT_PIECE_MIN_SIZE ) {
+        pieceCount = length / TEXT_PIECE_MIN_SIZE > 0 ? ( unsigned int )( length / TEXT_PIECE_MIN_SIZE ) : 1;
+    }
+
+    textFile.pieces = malloc( sizeof( textPiece_t ) * pieceCount );
+
+    if ( textFile.pieces == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    // Split the text in pieces of about the same size, moving each split point forward to the end of a number
+    const char * begin = text;
+    const char * end = text + length;
+
+    for ( unsigned int i = 0; i < pieceCount; i++ ) {
+        const char * pieceEnd = i == pieceCount - 1 ? end : text + length / pieceCount * ( i + 1 );
+
+        if ( pieceEnd < begin ) {
+            pieceEnd = begin;
+        }
+
+        while ( pieceEnd < end && !isTextSpace( *pieceEnd ) ) {
+            pieceEnd++;
+        }
+
+        textFile.pieces[ i ].begin = begin;
+        textFile.pieces[ i ].end = pieceEnd;
+
+        begin = pieceEnd;
+    }
+
+    parallelFor( pieceCount, countTextPieceTask, &textFile );
+
+    for ( unsigned int i = 0; i < pieceCount; i++ ) {
+        textFile.pieces[ i ].offset = total;
+        total += textFile.pieces[ i ].count;
+    }
+
+    // Allocate at least one element so a valid pointer is returned for empty files
+    textFile.values = malloc( ( total > 0 ? total : 1 ) * valueSize );
+
+    if ( textFile.values == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    parallelFor( pieceCount, parseTextPieceTask, &textFile );
+
+    // The values end at the first piece where parsing stopped early, the numbers after it are discarded
+    *size = total;
+
+    for ( unsigned int i = 0; i < pieceCount; i++ ) {
+        if ( textFile.pieces[ i ].truncated ) {
+            *size = textFile.pieces[ i ].offset + textFile.pieces[ i ].parsed;
+            break;
+        }
+    }
+
+    free( textFile.pieces );
+
+    return textFile.values;
+}
+
+/*
+ * Parses the numbers of a piece of text read from a stream into an array of 32-bit values, like the numbers of a text
+ * file, see parseTextPiece. values must have room for a number for every 2 characters of the text.
+ *
+ * Unless last is set, the text isn't the end of the file and its last number may go on in the text read after it, so
+ * it is left for the next piece, unless it takes the whole text. Returns the number of values parsed and sets consumed
+ * to the length of the text they took, and truncated if parsing stopped at something that is not a number.
+ */
+size_t parseTextChunk( const char * text, size_t length, bool last, uint32_t * values, size_t * consumed, bool * truncated ) {
+    textPiece_t piece = { .begin = text, .end = text + length };
+
+    while ( !last && piece.end > text && !isTextSpace( piece.end[ -1 ] ) ) {
+        piece.end--;
+    }
+
+    if ( piece.end == text ) {
+        piece.end = text + length;
+    }
+
+    parseTextPiece( &piece, values, sizeof( uint32_t ) );
+
+    *consumed = ( size_t )( piece.end - text );
+    *truncated = piece.truncated;
+
+    return piece.parsed;
+}
+
+/*
+ * Loads a text file containing addresses in base 10 or base 16 (with a "0x" prefix) in an array of values of valueSize
+ * bytes.
+ *
+ * The file is memory mapped, or read in a single call to fread if it can't be mapped, and parsed on multiple threads.
+ */
+static void * loadTextFile( char * filePath, size_t valueSize, size_t * size ) {
+    FILE *  file = fopen( filePath, "rb" );
+    
+    if ( file == NULL ) {
+        perror( filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    size_t  fileSize = getFileSize( file );
+    bool    mapped;
+    char *  text = loadFileContents( file, filePath, fileSize, &mapped );
+    void *  values = parseText( text, fileSize, valueSize, size );
+
+    unloadFileContents( text, fileSize, mapped );
+
+    fclose( file );
+
+    return values;
+}
+
+/*
+ * Reads a text file containing 32-bit addresses in base 10 or base 16 (with a "0x" prefix) and stores them in an
+ * array.
+ *
+ * The array is dynamically allocated, caller is responsible for releasing it with releaseFile.
+ * 
+ * Values is dereferenced with the newly allocated array and size is dereferenced with the number of elements in the array.
+ */
+void handleTextFile( char * filePath, uint32_t ** values, size_t * size ) {
+    *values = loadTextFile( filePath, sizeof( uint32_t ), size );
+}
+
+/*
+ * Reads a text file containing 64-bit addresses and stores them in an array, like handleTextFile.
+ */
+void handleTextFile64( char * filePath, uint64_t ** values, size_t * size ) {
+    *values = loadTextFile( filePath, sizeof( uint64_t ), size );
+}
+
+typedef struct _compressedFile_t {
+    compressedTrace_t *  trace;
+    const uint8_t *      data;
+    uint32_t *           addresses;
+    uint64_t *           offsets; // Position of the first address of each block in the addresses array
+    char *               filePath;
+} compressedFile_t;
+
+static void decodeCompressedBlockTask( void * context, unsigned int index ) {
+    compressedFile_t *   compressedFile = context;
+    compressedBlock_t *  block = &compressedFile->trace->blocks[ index ];
+
+    if ( !decodeCompressedBlock( compressedFile->data + block->offset, block->length, compressedFile->addresses + compressedFile->offsets[ index ], block->count ) ) {
+        fprintf( stderr, "%s: compressed trace block %u is corrupted.\n", compressedFile->filePath, index );
+        exit( EXIT_FAILURE );
+    }
+}
+
+/*
+ * Reads a compressed trace file and stores its addresses in an array.
+ *
+ * The blocks are decoded in parallel straight into the array, since the block index tells where the addresses of each
+ * block go. See CompressedTrace.h for the file format.
+ *
+ * The array must be released with releaseFile.
+ *
+ * Addresses is dereferenced with the newly allocated array and size is dereferenced with the number of elements in the array.
+ */
+void handleCompressedFile( char * filePath, uint32_t ** addresses, size_t * size ) {
+    FILE *             file = fopen( filePath, "rb" );
+    compressedTrace_t  trace;
+    compressedFile_t   compressedFile = { .trace = &trace, .filePath = filePath };
+    uint64_t           offset = 0;
+
+    if ( file == NULL ) {
+        perror( filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    readCompressedTraceIndex( file, filePath, &trace );
+
+    if ( trace.addressCount > SIZE_MAX / sizeof( uint32_t ) ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    size_t  fileSize = getFileSize( file );
+    bool    mapped;
+
+    compressedFile.data = loadFileContents( file, filePath, fileSize, &mapped );
+
+    *size = ( size_t )trace.addressCount;
+
+    // Allocate at least one element so a valid pointer is returned for empty traces
+    compressedFile.addresses = malloc( ( *size > 0 ? *size : 1 ) * sizeof( uint32_t ) );
+    compressedFile.offsets = malloc( sizeof( uint64_t ) * ( trace.blockCount > 0 ? trace.blockCount : 1 ) );
+
+    if ( compressedFile.addresses == NULL || compressedFile.offsets == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( uint32_t i = 0; i < trace.blockCount; i++ ) {
+        compressedFile.offsets[ i ] = offset;
+        offset += trace.blocks[ i ].count;
+    }
+
+    parallelFor( trace.blockCount, decodeCompressedBlockTask, &compressedFile );
+
+    *addresses = compressedFile.addresses;
+
+    unloadFileContents( ( void * )compressedFile.data, fileSize, mapped );
+
+    free( compressedFile.offsets );
+    destroyCompressedTrace( &trace );
+
+    fclose( file );
+}
+
+/*
+ * Checks if a file is a compressed trace, see isCompressedTrace.
+ */
+bool isCompressedFile( char * filePath ) {
+    FILE * file = fopen( filePath, "rb" );
+
+    if ( file == NULL ) {
+        perror( filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    bool compressed = isCompressedTrace( file );
+
+    fclose( file );
+
+    return compressed;
+}
+
+/*
+ * Reads a binary, text or compressed file containing 32-bit addresses and stores them in an array.
+ *
+ * Compressed traces are detected by their magic number. Otherwise the file type is detected based on the file
+ * extension, .txt for text files and anything else or no extension for binary files.
+ *
+ * The array must be released with releaseFile.
+ * 
+ * values is dereferenced with the newly allocated array and size is dereferenced with the number of elements in the array.
+ */
+void handleFile( char * filePath, uint32_t ** values, size_t * size ) {
+    #if COMPLIANCE_LEVEL < 2
+    /* Compressed traces are never valid binary traces, since their length is not a multiple of 4, so they can be
+     * detected in the strict compliance level.
+     */
+    if ( isCompressedFile( filePath ) ) {
+        handleCompressedFile( filePath, values, size );
+        return;
+    }
+    #endif
+
+    #if COMPLIANCE_LEVEL < 1
+    // Get the file extension string
+    char * extension = strrchr( filePath, '.' );
+    
+    if ( extension != NULL ) {
+        // Handle text files
+        if ( strcmp( extension, ".txt" ) == 0 ) {
+            handleTextFile( filePath, values, size );
+        // Handle binary files if the extension is not .txt
+        } else {
+            handleBinaryFile( filePath, values, size );
+        }
+    // No file extension
+    } else {
+        handleBinaryFile( filePath, values, size );
+    }
+    #else
+    /* If the compliance level is strict, only handle binary files, since text files are not supported, all files are
+     * treated as binary, even if they have a .txt extension.
+     */
+    handleBinaryFile( filePath, values, size );
+    #endif
+}
+
+/*
+ * Reads a binary or text file containing 64-bit addresses and stores them in an array, like handleFile.
+ *
+ * Binary files have 8 bytes per address in big-endian byte order. Compressed traces only hold 32-bit addresses, so
+ * they are rejected.
+ */
+void handleFile64( char * filePath, uint64_t ** values, size_t * size ) {
+    if ( isCompressedFile( filePath ) ) {
+        fprintf( stderr, "%s: traces comprimidos só guardam endereços de 32 bits.\n", filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    #if COMPLIANCE_LEVEL < 1
+    char * extension = strrchr( filePath, '.' );
+
+    if ( extension != NULL && strcmp( extension, ".txt" ) == 0 ) {
+        handleTextFile64( filePath, values, size );
+        return;
+    }
+    #endif
+
+    handleBinaryFile64( filePath, values, size );
+}
+
+/*
+ * Converts a record of a binary read/write trace, read as a 64-bit big-endian value, to a traceRecord_t. index is the
+ * index of the record in the file, for the error message of an invalid operation.
+ */
+static traceRecord_t decodeBinaryRecord( char * filePath, uint64_t value, size_t index ) {
+    traceRecord_t record = {
+        .address = ( uint32_t )( value >> 32 ),
+        .size = ( uint16_t )( value >> 16 ),
+        .operation = ( uint8_t )( value >> 8 ),
+        .reserved = 0
+    };
+
+    if ( record.operation != TRACE_READ && record.operation != TRACE_WRITE ) {
+        fprintf( stderr, "%s: operação inválida no registro %zu.\n", filePath, index + 1 );
+        exit( EXIT_FAILURE );
+    }
+
+    return record;
+}
+
+/*
+ * Converts the records of a binary read/write trace, read as 64-bit big-endian values, to traceRecord_t in place.
+ */
+static void decodeBinaryRecords( char * filePath, traceRecord_t * records, size_t count ) {
+    for ( size_t i = 0; i < count; i++ ) {
+        uint64_t value;
+
+        memcpy( &value, &records[ i ], sizeof( value ) );
+
+        records[ i ] = decodeBinaryRecord( filePath, value, i );
+    }
+}
+
+/*
+ * Splits the records of a binary timed read/write trace, read as pairs of 64-bit values, the timestamp followed by the
+ * record, into an array of timestamps and traceRecord_t records in place at the start of the values.
+ *
+ * Record i is written over value i, which is always a value already read, since the values of records before i take
+ * the first 2 * i values.
+ */
+static void decodeTimedBinaryRecords( char * filePath, uint64_t * values, uint64_t * timestamps, size_t count ) {
+    traceRecord_t * records = ( traceRecord_t * )values;
+
+    for ( size_t i = 0; i < count; i++ ) {
+        uint64_t timestamp = values[ 2 * i ];
+        uint64_t value = values[ 2 * i + 1 ];
+
+        timestamps[ i ] = timestamp;
+        records[ i ] = decodeBinaryRecord( filePath, value, i );
+    }
+}
+
+#if COMPLIANCE_LEVEL < 1
+/*
+ * Parses a decimal or hexadecimal (with a "0x" prefix) number of a text read/write trace after any white-space.
+ *
+ * Returns false if there isn't a number, text is moved past the number otherwise.
+ */
+static bool parseRecordNumber( const char ** text, const char * end, uint64_t * value ) {
+    const char *  c = *text;
+    uint32_t      digit;
+
+    while ( c < end && isTextSpace( *c ) ) {
+        c++;
+    }
+
+    if ( c == end || !isDecimalDigit( *c ) ) {
+        return false;
+    }
+
+    *value = 0;
+
+    if ( c[ 0 ] == '0' && c + 2 < end && ( c[ 1 ] | 0x20 ) == 'x' && hexDigitValue( c[ 2 ] ) < 16 ) {
+        for ( c += 2; c < end && ( digit = hexDigitValue( *c ) ) < 16; c++ ) {
+            *value = ( *value << 4 ) | digit;
+        }
+    } else {
+        for ( ; c < end && isDecimalDigit( *c ); c++ ) {
+            *value = *value * 10 + ( uint64_t )( *c - '0' );
+        }
+    }
+
+    *text = c;
+
+    return true;
+}
+
+/*
+ * Parses the records of a text read/write trace, one per line as an operation, R or W, an address and a size.
+ *
+ * If timestamps isn't NULL the trace is timed, each line starts with a timestamp before the operation, and it's
+ * dereferenced with a newly allocated array of the timestamps of the records.
+ *
+ * Like the text traces of addresses, parsing stops at the first record that can't be parsed.
+ */
+static traceRecord_t * parseRecordText( const char * text, size_t length, size_t * size, uint64_t ** timestamps ) {
+    const char *     c = text;
+    const char *     end = text + length;
+    size_t           capacity = 1024;
+    traceRecord_t *  records = malloc( sizeof( traceRecord_t ) * capacity );
+    uint64_t *       times = timestamps != NULL ? malloc( sizeof( uint64_t ) * capacity ) : NULL;
+
+    *size = 0;
+
+    while ( records != NULL && ( timestamps == NULL || times != NULL ) ) {
+        uint64_t address;
+        uint64_t accessSize;
+        uint64_t timestamp = 0;
+
+        if ( timestamps != NULL && !parseRecordNumber( &c, end, &timestamp ) ) {
+            break;
+        }
+
+        while ( c < end && isTextSpace( *c ) ) {
+            c++;
+        }
+
+        if ( c == end || ( ( *c | 0x20 ) != 'r' && ( *c | 0x20 ) != 'w' ) ) {
+            break;
+        }
+
+        uint8_t operation = ( *c | 0x20 ) == 'w' ? TRACE_WRITE : TRACE_READ;
+
+        c++;
+
+        if ( !parseRecordNumber( &c, end, &address ) || !parseRecordNumber( &c, end, &accessSize ) ) {
+            break;
+        }
+
+        if ( *size == capacity ) {
+            capacity *= 2;
+            records = realloc( records, sizeof( traceRecord_t ) * capacity );
+
+            if ( timestamps != NULL ) {
+                times = realloc( times, sizeof( uint64_t ) * capacity );
+            }
+
+            if ( records == NULL || ( timestamps != NULL && times == NULL ) ) {
+                break;
+            }
+        }
+
+        if ( timestamps != NULL ) {
+            times[ *size ] = timestamp;
+        }
+
+        records[ ( *size )++ ] = ( traceRecord_t ){
+            .address = ( uint32_t )address,
+            .size = ( uint16_t )accessSize,
+            .operation = operation,
+            .reserved = 0
+        };
+    }
+
+    if ( records == NULL || ( timestamps != NULL && times == NULL ) ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( timestamps != NULL ) {
+        *timestamps = times;
+    }
+
+    return records;
+}
+#endif
+
+/*
+ * Reads a read/write trace and stores its records in an array.
+ *
+ * Binary files have 8 bytes per record: the address (u32), the size in bytes (u16), the operation, 0 for a read and 1
+ * for a write (u8), and a reserved byte, in big-endian byte order like the traces of addresses. Text files, detected
+ * by the .txt extension in the relaxed compliance level, have one record per line, like "W 0x1000 4". Compressed traces
+ * hold no operations, so they are rejected.
+ *
+ * The array must be released with releaseFile.
+ *
+ * records is dereferenced with the newly allocated array and size is dereferenced with the number of records.
+ */
+void handleRecordFile( char * filePath, traceRecord_t ** records, size_t * size ) {
+    if ( isCompressedFile( filePath ) ) {
+        fprintf( stderr, "%s: traces comprimidos não guardam a operação dos acessos.\n", filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    #if COMPLIANCE_LEVEL < 1
+    char * extension = strrchr( filePath, '.' );
+
+    if ( extension != NULL && strcmp( extension, ".txt" ) == 0 ) {
+        FILE * file = fopen( filePath, "rb" );
+
+        if ( file == NULL ) {
+            perror( filePath );
+            exit( EXIT_FAILURE );
+        }
+
+        size_t  fileSize = getFileSize( file );
+        bool    mapped;
+        char *  text = loadFileContents( file, filePath, fileSize, &mapped );
+
+        *records = parseRecordText( text, fileSize, size, NULL );
+
+        unloadFileContents( text, fileSize, mapped );
+
+        fclose( file );
+
+        return;
+    }
+    #endif
+
+    *records = loadBinaryFile( filePath, sizeof( traceRecord_t ), size );
+
+    decodeBinaryRecords( filePath, *records, *size );
+}
+
+/*
+ * Checks that the timestamps of a timed read/write trace don't decrease.
+ */
+static void checkTimestampOrder( char * filePath, const uint64_t * timestamps, size_t count ) {
+    for ( size_t i = 1; i < count; i++ ) {
+        if ( timestamps[ i ] < timestamps[ i - 1 ] ) {
+            fprintf( stderr, "%s: timestamp fora de ordem no registro %zu.\n", filePath, i + 1 );
+            exit( EXIT_FAILURE );
+        }
+    }
+}
+
+/*
+ * Reads a timed read/write trace, for the multi-core simulations interleaved by timestamp, and stores its records and
+ * their timestamps in two arrays.
+ *
+ * Binary files have 16 bytes per record: the timestamp (u64) followed by a record like the ones of handleRecordFile,
+ * in big-endian byte order. Text files, detected by the .txt extension in the relaxed compliance level, have one record
+ * per line, like "120 W 0x1000 4". Timestamps must not decrease along the trace.
+ *
+ * The records must be released with releaseFile, the timestamps with free.
+ *
+ * records and timestamps are dereferenced with the newly allocated arrays and size is dereferenced with the number of
+ * records.
+ */
+void handleTimedRecordFile( char * filePath, traceRecord_t ** records, uint64_t ** timestamps, size_t * size ) {
+    size_t      valueCount;
+    uint64_t *  values;
+
+    if ( isCompressedFile( filePath ) ) {
+        fprintf( stderr, "%s: traces comprimidos não guardam a operação dos acessos.\n", filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    #if COMPLIANCE_LEVEL < 1
+    char * extension = strrchr( filePath, '.' );
+
+    if ( extension != NULL && strcmp( extension, ".txt" ) == 0 ) {
+        FILE * file = fopen( filePath, "rb" );
+
+        if ( file == NULL ) {
+            perror( filePath );
+            exit( EXIT_FAILURE );
+        }
+
+        size_t  fileSize = getFileSize( file );
+        bool    mapped;
+        char *  text = loadFileContents( file, filePath, fileSize, &mapped );
+
+        *records = parseRecordText( text, fileSize, size, timestamps );
+
+        unloadFileContents( text, fileSize, mapped );
+
+        fclose( file );
+
+        checkTimestampOrder( filePath, *timestamps, *size );
+
+        return;
+    }
+    #endif
+
+    values = loadBinaryFile( filePath, sizeof( uint64_t ), &valueCount );
+
+    if ( valueCount % 2 != 0 ) {
+        fprintf( stderr, "%s: o arquivo não é composto por um número inteiro de registros com timestamp.\n", filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    *size = valueCount / 2;
+    *timestamps = malloc( sizeof( uint64_t ) * ( *size > 0 ? *size : 1 ) );
+
+    if ( *timestamps == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    decodeTimedBinaryRecords( filePath, values, *timestamps, *size );
+
+    *records = ( traceRecord_t * )values;
+
+    checkTimestampOrder( filePath, *timestamps, *size );
+}
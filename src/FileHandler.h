@@ -1,9 +1,26 @@
 #ifndef FILE_HANDLER_H
 #define FILE_HANDLER_H
 
+#include <stdio.h>
+#include <stdbool.h>
 #include <inttypes.h>
 
+#include "Simulator.h"
+
+size_t getFileSize( FILE * file );
+void bigEndianToHost( uint32_t * words, size_t count );
+void bigEndianToHost64( uint64_t * values, size_t count );
+void releaseFile( void * values );
 void handleBinaryFile( char * filename, uint32_t ** addresses, size_t * size );
+void handleBinaryFile64( char * filename, uint64_t ** addresses, size_t * size );
 void handleTextFile( char * filename, uint32_t ** values, size_t * size );
+void handleTextFile64( char * filename, uint64_t ** values, size_t * size );
+size_t parseTextChunk( const char * text, size_t length, bool last, uint32_t * values, size_t * consumed, bool * truncated );
+void handleCompressedFile( char * filename, uint32_t ** addresses, size_t * size );
+bool isCompressedFile( char * filename );
 void handleFile( char * filename, uint32_t ** values, size_t * size );
+void handleFile64( char * filename, uint64_t ** values, size_t * size );
+void handleRecordFile( char * filename, traceRecord_t ** records, size_t * size );
+void handleTimedRecordFile( char * filename, traceRecord_t ** records, uint64_t ** timestamps, size_t * size );
+
 #endif
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "FirstTouch.h"
+
+// Buckets of the page table of a new set
+#define FIRST_TOUCH_INITIAL_CAPACITY 64
+
+/*
+ * Fibonacci hashing of a page number, like blockMapBucket.
+ */
+static inline uint32_t firstTouchBucket( firstTouch_t * firstTouch, uint64_t pageNumber ) {
+    return ( uint32_t )( ( pageNumber * UINT64_C( 0x9E3779B97F4A7C15 ) ) >> firstTouch->shift );
+}
+
+static void allocatePageTable( firstTouch_t * firstTouch, uint32_t capacity ) {
+    firstTouch->capacity = capacity;
+    firstTouch->size = 0;
+    firstTouch->shift = 64;
+
+    while ( capacity > 1 ) {
+        capacity >>= 1;
+        firstTouch->shift--;
+    }
+
+    firstTouch->pageNumbers = malloc( sizeof( uint64_t ) * firstTouch->capacity );
+    firstTouch->pages = calloc( firstTouch->capacity, sizeof( uint64_t * ) );
+
+    if ( firstTouch->pageNumbers == NULL || firstTouch->pages == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+}
+
+/*
+ * Initializes an empty set of touched blocks.
+ */
+firstTouch_t * initializeFirstTouch( void ) {
+    firstTouch_t * firstTouch = malloc( sizeof( firstTouch_t ) );
+
+    if ( firstTouch == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    allocatePageTable( firstTouch, FIRST_TOUCH_INITIAL_CAPACITY );
+
+    firstTouch->blocks = 0;
+    firstTouch->lastPageNumber = 0;
+    firstTouch->lastPage = NULL;
+
+    return firstTouch;
+}
+
+/*
+ * Stores a page in the first empty bucket of its page number, which must not be in the table.
+ */
+static void insertPage( firstTouch_t * firstTouch, uint64_t pageNumber, uint64_t * page ) {
+    uint32_t bucket = firstTouchBucket( firstTouch, pageNumber );
+
+    while ( firstTouch->pages[ bucket ] != NULL ) {
+        bucket = ( bucket + 1 ) & ( firstTouch->capacity - 1 );
+    }
+
+    firstTouch->pageNumbers[ bucket ] = pageNumber;
+    firstTouch->pages[ bucket ] = page;
+    firstTouch->size++;
+}
+
+/*
+ * Doubles the capacity of the page table, keeping the load factor at or below 1/2.
+ */
+static void growPageTable( firstTouch_t * firstTouch ) {
+    uint64_t *   pageNumbers = firstTouch->pageNumbers;
+    uint64_t **  pages = firstTouch->pages;
+    uint32_t     capacity = firstTouch->capacity;
+
+    if ( capacity >= ( UINT32_C( 1 ) << 31 ) ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    allocatePageTable( firstTouch, capacity * 2 );
+
+    for ( uint32_t i = 0; i < capacity; i++ ) {
+        if ( pages[ i ] != NULL ) {
+            insertPage( firstTouch, pageNumbers[ i ], pages[ i ] );
+        }
+    }
+
+    free( pageNumbers );
+    free( pages );
+}
+
+/*
+ * Finds the bitmap of a page, allocating it if none of its blocks has been touched.
+ */
+static uint64_t * findPage( firstTouch_t * firstTouch, uint64_t pageNumber ) {
+    uint32_t    bucket = firstTouchBucket( firstTouch, pageNumber );
+    uint64_t *  page;
+
+    while ( firstTouch->pages[ bucket ] != NULL ) {
+        if ( firstTouch->pageNumbers[ bucket ] == pageNumber ) {
+            return firstTouch->pages[ bucket ];
+        }
+
+        bucket = ( bucket + 1 ) & ( firstTouch->capacity - 1 );
+    }
+
+    page = calloc( ( ( size_t )1 << FIRST_TOUCH_PAGE_BITS ) / 64, sizeof( uint64_t ) );
+
+    if ( page == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( ( firstTouch->size + 1 ) * 2 > firstTouch->capacity ) {
+        growPageTable( firstTouch );
+    }
+
+    insertPage( firstTouch, pageNumber, page );
+
+    return page;
+}
+
+/*
+ * Marks a block as touched, returns true if it's the first time the block is touched.
+ */
+bool touchBlock( firstTouch_t * firstTouch, uint64_t block ) {
+    uint64_t  pageNumber = block >> FIRST_TOUCH_PAGE_BITS;
+    uint32_t  bit = ( uint32_t )block & ( ( UINT32_C( 1 ) << FIRST_TOUCH_PAGE_BITS ) - 1 );
+    uint64_t  mask = UINT64_C( 1 ) << ( bit & 63 );
+
+    if ( firstTouch->lastPage == NULL || firstTouch->lastPageNumber != pageNumber ) {
+        firstTouch->lastPage = findPage( firstTouch, pageNumber );
+        firstTouch->lastPageNumber = pageNumber;
+    }
+
+    if ( firstTouch->lastPage[ bit >> 6 ] & mask ) {
+        return false;
+    }
+
+    firstTouch->lastPage[ bit >> 6 ] |= mask;
+    firstTouch->blocks++;
+
+    return true;
+}
+
+void destroyFirstTouch( firstTouch_t * firstTouch ) {
+    for ( uint32_t i = 0; i < firstTouch->capacity; i++ ) {
+        free( firstTouch->pages[ i ] );
+    }
+
+    free( firstTouch->pageNumbers );
+    free( firstTouch->pages );
+    free( firstTouch );
+}
@@ -0,0 +1,30 @@
+#ifndef FIRST_TOUCH_H
+#define FIRST_TOUCH_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+// Number of bits of the block addresses covered by each page of the first touch bitmap
+#define FIRST_TOUCH_PAGE_BITS 16
+
+/*
+ * Set of the blocks that have been touched, a bitmap over the block space split in pages that are only allocated when
+ * a block in them is touched. Pages are found by an open addressing hash table of page numbers, so the blocks of 64-bit
+ * addresses are tracked too, and the last page touched is kept aside since consecutive blocks share their page.
+ */
+typedef struct _firstTouch_t {
+    uint64_t *   pageNumbers;
+    uint64_t **  pages;           // Bitmap of each bucket, NULL for empty buckets
+    uint64_t     blocks;          // Blocks touched
+    uint32_t     capacity;        // Always a power of 2
+    uint32_t     size;
+    uint32_t     shift;
+    uint64_t     lastPageNumber;
+    uint64_t *   lastPage;        // NULL until a block is touched
+} firstTouch_t;
+
+firstTouch_t * initializeFirstTouch( void );
+bool touchBlock( firstTouch_t * firstTouch, uint64_t block );
+void destroyFirstTouch( firstTouch_t * firstTouch );
+
+#endif
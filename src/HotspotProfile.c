@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "HotspotProfile.h"
+#include "CacheConfig.h"
+#include "Simulator.h"
+
+// Odd multipliers of the multiplicative hashes of the rows of the sketch, the high bits of the product are the column
+static const uint64_t sketchMultipliers[ HOTSPOT_SKETCH_DEPTH ] = {
+    UINT64_C( 0x9E3779B97F4A7C15 ), UINT64_C( 0xC2B2AE3D27D4EB4F ), UINT64_C( 0x165667B19E3779F9 ), UINT64_C( 0xD6E8FEB86659FD93 )
+};
+
+/*
+ * Allocates an empty hotspot profile for every level of a hierarchy with a top-K list, into the hotspots of its
+ * configuration.
+ */
+void initializeHotspotProfiles( cacheConfigList_t * cacheConfigList ) {
+    for ( cacheConfigList_t * current = cacheConfigList; current != NULL; current = current->next ) {
+        cacheConfig_t * cacheConfig = &current->cacheConfig;
+
+        if ( cacheConfig->hotspotTop == 0 ) {
+            continue;
+        }
+
+        hotspotProfile_t * profile = malloc( sizeof( hotspotProfile_t ) );
+
+        if ( profile == NULL ) {
+            fputs( "Sem memória.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+
+        profile->nsets = cacheConfig->nsets;
+        profile->offsetBits = log2PowerOf2( cacheConfig->bsize );
+        profile->top = cacheConfig->hotspotTop;
+        profile->count = 0;
+        profile->sets = calloc( cacheConfig->nsets, sizeof( hotspotSet_t ) );
+        profile->sketch = calloc( ( size_t )HOTSPOT_SKETCH_DEPTH * HOTSPOT_SKETCH_WIDTH, sizeof( uint64_t ) );
+        profile->heap = malloc( sizeof( hotspotBlock_t ) * profile->top );
+
+        if ( profile->sets == NULL || profile->sketch == NULL || profile->heap == NULL ) {
+            fputs( "Sem memória.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+
+        cacheConfig->hotspots = profile;
+    }
+}
+
+/*
+ * Moves an entry of the heap down until it has no child with fewer misses.
+ */
+static void siftHotspotDown( hotspotProfile_t * profile, uint32_t index ) {
+    hotspotBlock_t * heap = profile->heap;
+
+    for ( ;; ) {
+        uint32_t  smallest = index;
+        uint32_t  left = 2 * index + 1;
+        uint32_t  right = left + 1;
+
+        if ( left < profile->count && heap[ left ].misses < heap[ smallest ].misses ) {
+            smallest = left;
+        }
+
+        if ( right < profile->count && heap[ right ].misses < heap[ smallest ].misses ) {
+            smallest = right;
+        }
+
+        if ( smallest == index ) {
+            return;
+        }
+
+        hotspotBlock_t swap = heap[ index ];
+
+        heap[ index ] = heap[ smallest ];
+        heap[ smallest ] = swap;
+        index = smallest;
+    }
+}
+
+/*
+ * Moves an entry of the heap up until its parent has no more misses than it.
+ */
+static void siftHotspotUp( hotspotProfile_t * profile, uint32_t index ) {
+    hotspotBlock_t * heap = profile->heap;
+
+    while ( index > 0 && heap[ ( index - 1 ) / 2 ].misses > heap[ index ].misses ) {
+        hotspotBlock_t swap = heap[ index ];
+
+        heap[ index ] = heap[ ( index - 1 ) / 2 ];
+        heap[ ( index - 1 ) / 2 ] = swap;
+        index = ( index - 1 ) / 2;
+    }
+}
+
+/*
+ * Counts a demand miss of a profiled level in the set it maps to and in the estimate of its block.
+ *
+ * The conservative update only raises the counters of the block that are below its new estimate, which keeps the
+ * other blocks that share them from being overestimated. Since the estimate of a block never decreases, a block in the
+ * heap always has a new estimate above the heap minimum, so the heap is only searched when the block may be in it or
+ * may enter it.
+ */
+void recordHotspotMiss( hotspotProfile_t * profile, uint32_t setIndex, uint64_t address ) {
+    uint64_t    block = address >> profile->offsetBits;
+    uint64_t *  counters[ HOTSPOT_SKETCH_DEPTH ];
+    uint64_t    estimate = UINT64_MAX;
+
+    profile->sets[ setIndex ].misses++;
+
+    for ( unsigned int row = 0; row < HOTSPOT_SKETCH_DEPTH; row++ ) {
+        size_t column = ( size_t )( ( block * sketchMultipliers[ row ] ) >> ( 64 - HOTSPOT_SKETCH_BITS ) );
+
+        counters[ row ] = &profile->sketch[ ( size_t )row * HOTSPOT_SKETCH_WIDTH + column ];
+
+        if ( *counters[ row ] < estimate ) {
+            estimate = *counters[ row ];
+        }
+    }
+
+    estimate++;
+
+    for ( unsigned int row = 0; row < HOTSPOT_SKETCH_DEPTH; row++ ) {
+        if ( *counters[ row ] < estimate ) {
+            *counters[ row ] = estimate;
+        }
+    }
+
+    if ( profile->count == profile->top && estimate <= profile->heap[ 0 ].misses ) {
+        return;
+    }
+
+    for ( uint32_t i = 0; i < profile->count; i++ ) {
+        if ( profile->heap[ i ].block == block ) {
+            profile->heap[ i ].misses = estimate;
+
+            siftHotspotDown( profile, i );
+
+            return;
+        }
+    }
+
+    if ( profile->count < profile->top ) {
+        profile->heap[ profile->count ] = ( hotspotBlock_t ){ .block = block, .misses = estimate };
+
+        siftHotspotUp( profile, profile->count++ );
+    } else {
+        profile->heap[ 0 ] = ( hotspotBlock_t ){ .block = block, .misses = estimate };
+
+        siftHotspotDown( profile, 0 );
+    }
+}
+
+static int compareHotspotBlocks( const void * a, const void * b ) {
+    const hotspotBlock_t *  first = a;
+    const hotspotBlock_t *  second = b;
+
+    if ( first->misses != second->misses ) {
+        return first->misses > second->misses ? -1 : 1;
+    }
+
+    return ( first->block > second->block ) - ( first->block < second->block );
+}
+
+/*
+ * Sorts the top-K list of a profile from the most missed block, ties by address. The heap can't take more misses after
+ * it is sorted.
+ */
+void sortHotspotBlocks( hotspotProfile_t * profile ) {
+    qsort( profile->heap, profile->count, sizeof( hotspotBlock_t ), compareHotspotBlocks );
+}
+
+void destroyHotspotProfile( hotspotProfile_t * profile ) {
+    free( profile->sets );
+    free( profile->sketch );
+    free( profile->heap );
+    free( profile );
+}
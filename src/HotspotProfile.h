@@ -0,0 +1,58 @@
+#ifndef HOTSPOT_PROFILE_H
+#define HOTSPOT_PROFILE_H
+
+#include <inttypes.h>
+
+#include "CacheConfig.h"
+
+// Rows of the count-min sketch, each with its own hash of the block address
+#define HOTSPOT_SKETCH_DEPTH 4
+
+// Counters of each row of the count-min sketch, 2 to this power
+#define HOTSPOT_SKETCH_BITS 12
+#define HOTSPOT_SKETCH_WIDTH ( 1 << HOTSPOT_SKETCH_BITS )
+
+// Largest number of blocks of the top-K list, which is searched linearly
+#define HOTSPOT_MAX_TOP 256
+
+/*
+ * Accesses of a set of a profiled level.
+ */
+typedef struct _hotspotSet_t {
+    uint64_t  hits;
+    uint64_t  misses;
+    uint64_t  evictions;  // Valid lines replaced, by demand misses and by fills that are not demand accesses alike
+} hotspotSet_t;
+
+/*
+ * A block of the top-K list and its estimated number of misses.
+ */
+typedef struct _hotspotBlock_t {
+    uint64_t  block;   // Address of the block without its offset bits
+    uint64_t  misses;
+} hotspotBlock_t;
+
+/*
+ * Where the accesses of a cache level hit and miss: a histogram of the hits, misses and evictions of each set, and the
+ * K blocks with the most misses.
+ *
+ * The misses of each block are estimated by a count-min sketch with conservative update, which never underestimates
+ * them, and the K blocks with the largest estimates are kept in a min-heap. Its memory doesn't depend on the number of
+ * distinct blocks of the trace. Only demand accesses are counted, like in result_t.
+ */
+typedef struct _hotspotProfile_t {
+    uint32_t          nsets;
+    uint32_t          offsetBits;
+    uint32_t          top;     // K
+    uint32_t          count;   // Blocks in the heap
+    hotspotSet_t *    sets;
+    uint64_t *        sketch;  // HOTSPOT_SKETCH_DEPTH rows of HOTSPOT_SKETCH_WIDTH counters
+    hotspotBlock_t *  heap;    // Min-heap by misses, sorted by misses from the most missed after sortHotspotBlocks
+} hotspotProfile_t;
+
+void initializeHotspotProfiles( cacheConfigList_t * cacheConfigList );
+void recordHotspotMiss( hotspotProfile_t * profile, uint32_t setIndex, uint64_t address );
+void sortHotspotBlocks( hotspotProfile_t * profile );
+void destroyHotspotProfile( hotspotProfile_t * profile );
+
+#endif
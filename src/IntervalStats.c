@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "IntervalStats.h"
+#include "Simulator.h"
+#include "CacheConfig.h"
+#include "Performance.h"
+
+static inline void writeLittleEndian32( uint8_t * data, uint32_t value ) {
+    data[ 0 ] = ( uint8_t )value;
+    data[ 1 ] = ( uint8_t )( value >> 8 );
+    data[ 2 ] = ( uint8_t )( value >> 16 );
+    data[ 3 ] = ( uint8_t )( value >> 24 );
+}
+
+static inline void writeLittleEndian64( uint8_t * data, uint64_t value ) {
+    writeLittleEndian32( data, ( uint32_t )value );
+    writeLittleEndian32( data + 4, ( uint32_t )( value >> 32 ) );
+}
+
+/*
+ * Allocates the interval statistics of a hierarchy of levels levels, for intervals of length accesses of the trace.
+ *
+ * The buffer of the intervals is allocated at once for a trace of accesses accesses, so simulating it never allocates
+ * memory. If the length of the trace isn't known in advance, accesses is 0 and the buffer grows as needed.
+ */
+intervalStats_t * initializeIntervalStats( uint64_t length, unsigned long levels, uint64_t accesses ) {
+    intervalStats_t * stats = malloc( sizeof( intervalStats_t ) );
+
+    if ( stats == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    stats->length = length;
+    stats->remaining = length;
+    stats->accesses = 0;
+    stats->levels = levels;
+    stats->count = 0;
+    stats->capacity = accesses > 0 ? ( size_t )( ( accesses + length - 1 ) / length ) : INTERVAL_STATS_INITIAL_CAPACITY;
+    stats->deltas = malloc( sizeof( result_t ) * levels * stats->capacity );
+    stats->previous = calloc( levels, sizeof( result_t ) );
+    stats->current = malloc( sizeof( result_t ) * levels );
+
+    if ( stats->deltas == NULL || stats->previous == NULL || stats->current == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    return stats;
+}
+
+/*
+ * Closes the current interval with the statistics of the levels at its end and starts the next one.
+ */
+static void recordInterval( intervalStats_t * stats, const result_t * results ) {
+    if ( stats->count == stats->capacity ) {
+        stats->capacity *= 2;
+        stats->deltas = realloc( stats->deltas, sizeof( result_t ) * stats->levels * stats->capacity );
+
+        if ( stats->deltas == NULL ) {
+            fputs( "Sem memória.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    result_t * deltas = &stats->deltas[ stats->count * stats->levels ];
+
+    for ( unsigned long level = 0; level < stats->levels; level++ ) {
+        deltas[ level ] = results[ level ];
+        deltas[ level ].uniqueBytes = 0;
+
+        subtractResult( &deltas[ level ], &stats->previous[ level ] );
+
+        stats->previous[ level ] = results[ level ];
+    }
+
+    stats->count++;
+    stats->remaining = stats->length;
+}
+
+/*
+ * Simulates the next chunk of addresses of a simulation like simulateChunk, closing the intervals that end in it.
+ *
+ * The chunk is cut at the ends of the intervals and each piece goes through the kernels of the levels as a whole, so
+ * the intervals cost nothing per address.
+ */
+void simulateIntervalChunk( simulation_t * simulation, intervalStats_t * stats, uint32_t * addresses, size_t addressesSize ) {
+    while ( addressesSize > 0 ) {
+        size_t count = addressesSize < stats->remaining ? addressesSize : ( size_t )stats->remaining;
+
+        simulateChunk( simulation, addresses, count );
+
+        addresses += count;
+        addressesSize -= count;
+        stats->remaining -= count;
+
+        if ( stats->remaining == 0 ) {
+            snapshotSimulation( simulation, stats->current );
+            recordInterval( stats, stats->current );
+        }
+    }
+}
+
+/*
+ * Closes the last interval, which may be shorter than the others, with the final statistics of the levels.
+ */
+void finishIntervals( intervalStats_t * stats, const result_t * results ) {
+    stats->accesses = stats->count * stats->length + ( stats->length - stats->remaining );
+
+    if ( stats->remaining < stats->length ) {
+        recordInterval( stats, results );
+    }
+}
+
+/*
+ * Simulates the behaviour of a cache accessing an array of addresses like simulateConfiguration, recording the
+ * statistics of each interval in stats.
+ *
+ * The results array is dynamically allocated, caller is responsible for freeing it.
+ */
+result_t * simulateIntervals( uint32_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList, intervalStats_t * stats ) {
+    simulation_t *  simulation = initializeSimulation( cacheConfigList );
+    result_t *      results;
+
+    simulateIntervalChunk( simulation, stats, addresses, addressesSize );
+
+    results = finishSimulation( simulation );
+
+    finishIntervals( stats, results );
+
+    return results;
+}
+
+/*
+ * Simulates the behaviour of a cache accessing the records of a read/write trace like simulateRecords, recording the
+ * statistics of each interval in stats.
+ *
+ * Records go through the hierarchy one at a time, so the end of an interval is found by counting down its records.
+ *
+ * The results array is dynamically allocated, caller is responsible for freeing it.
+ */
+result_t * simulateRecordIntervals( traceRecord_t * records, size_t recordsSize, cacheConfigList_t * cacheConfigList, intervalStats_t * stats ) {
+    cache_t *   cache = initializeCache( cacheConfigList );
+    result_t *  results;
+
+    for ( size_t i = 0; i < recordsSize; i++ ) {
+        accessRecord( cache, &records[ i ] );
+
+        if ( --stats->remaining == 0 ) {
+            snapshotCache( cache, stats->current );
+            recordInterval( stats, stats->current );
+        }
+    }
+
+    results = collectResults( cache );
+
+    destroyCache( cache );
+
+    finishIntervals( stats, results );
+
+    return results;
+}
+
+/*
+ * Writes the counters of a level in an interval to a CSV file, see writeIntervalStats.
+ */
+static void writeIntervalLevelCSV( FILE * file, const result_t * result, bool traffic, bool prefetching, bool victimCaching, bool inclusion ) {
+    uint64_t misses = result->compulsoryMisses + result->capacityMisses + result->conflictMisses;
+
+    fprintf( file, ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.6f",
+             result->accesses, result->hits, misses, result->compulsoryMisses, result->capacityMisses, result->conflictMisses,
+             result->accesses > 0 ? ( double )misses / result->accesses : 0.0 );
+
+    if ( traffic ) {
+        fprintf( file, ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64, result->writes, result->writeBacks, result->bytesRead,
+                 result->bytesWritten );
+    }
+
+    if ( prefetching ) {
+        fprintf( file, ",%" PRIu64 ",%" PRIu64 ",%" PRIu64, result->prefetches, result->usefulPrefetches, result->latePrefetches );
+    }
+
+    if ( victimCaching ) {
+        fprintf( file, ",%" PRIu64 ",%" PRIu64, result->victimProbes, result->victimHits );
+    }
+
+    if ( inclusion ) {
+        fprintf( file, ",%" PRIu64, result->backInvalidations );
+    }
+}
+
+/*
+ * Writes the intervals as CSV, one line per interval with its number, its first access and its number of accesses
+ * followed by the columns of each level.
+ */
+static void writeIntervalCSV( intervalStats_t * stats, cacheConfigList_t * cacheConfigList, bool traffic, FILE * file ) {
+    bool          prefetching = hasPrefetcher( cacheConfigList );
+    bool          victimCaching = hasVictimCache( cacheConfigList );
+    bool          inclusion = cacheConfigList->cacheConfig.reportInclusion;
+    const char *  columns[] = { "accesses", "hits", "misses", "compulsory_misses", "capacity_misses", "conflict_misses", "miss_rate" };
+    const char *  trafficColumns[] = { "writes", "write_backs", "bytes_read", "bytes_written" };
+    const char *  prefetchColumns[] = { "prefetches", "useful_prefetches", "late_prefetches" };
+    const char *  victimColumns[] = { "victim_probes", "victim_hits" };
+
+    fputs( "interval,first_access,trace_accesses", file );
+
+    for ( unsigned long level = 1; level <= stats->levels; level++ ) {
+        for ( size_t i = 0; i < sizeof( columns ) / sizeof( columns[ 0 ] ); i++ ) {
+            fprintf( file, ",L%lu_%s", level, columns[ i ] );
+        }
+
+        for ( size_t i = 0; traffic && i < sizeof( trafficColumns ) / sizeof( trafficColumns[ 0 ] ); i++ ) {
+            fprintf( file, ",L%lu_%s", level, trafficColumns[ i ] );
+        }
+
+        for ( size_t i = 0; prefetching && i < sizeof( prefetchColumns ) / sizeof( prefetchColumns[ 0 ] ); i++ ) {
+            fprintf( file, ",L%lu_%s", level, prefetchColumns[ i ] );
+        }
+
+        for ( size_t i = 0; victimCaching && i < sizeof( victimColumns ) / sizeof( victimColumns[ 0 ] ); i++ ) {
+            fprintf( file, ",L%lu_%s", level, victimColumns[ i ] );
+        }
+
+        if ( inclusion ) {
+            fprintf( file, ",L%lu_back_invalidations", level );
+        }
+    }
+
+    fputc( '\n', file );
+
+    for ( size_t interval = 0; interval < stats->count; interval++ ) {
+        uint64_t  first = interval * stats->length;
+        uint64_t  accesses = stats->accesses - first < stats->length ? stats->accesses - first : stats->length;
+
+        fprintf( file, "%zu,%" PRIu64 ",%" PRIu64, interval, first, accesses );
+
+        for ( unsigned long level = 0; level < stats->levels; level++ ) {
+            writeIntervalLevelCSV( file, &stats->deltas[ interval * stats->levels + level ], traffic, prefetching, victimCaching, inclusion );
+        }
+
+        fputc( '\n', file );
+    }
+}
+
+/*
+ * Writes the intervals in the binary layout described at INTERVAL_STATS_MAGIC.
+ */
+static void writeIntervalBinary( intervalStats_t * stats, FILE * file, char * filePath ) {
+    uint8_t  header[ INTERVAL_STATS_HEADER_SIZE ] = { 0 };
+    uint8_t  fields[ INTERVAL_STATS_FIELDS * 8 ];
+
+    memcpy( header, INTERVAL_STATS_MAGIC, 4 );
+    header[ 4 ] = INTERVAL_STATS_VERSION & 0xFF;
+    header[ 5 ] = INTERVAL_STATS_VERSION >> 8;
+    header[ 6 ] = ( uint8_t )stats->levels;
+    header[ 7 ] = ( uint8_t )( stats->levels >> 8 );
+    writeLittleEndian32( header + 8, INTERVAL_STATS_FIELDS );
+    writeLittleEndian64( header + 16, stats->length );
+    writeLittleEndian64( header + 24, stats->count );
+    writeLittleEndian64( header + 32, stats->accesses );
+
+    if ( fwrite( header, 1, sizeof( header ), file ) < sizeof( header ) ) {
+        perror( filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( size_t i = 0; i < stats->count * stats->levels; i++ ) {
+        const result_t *  result = &stats->deltas[ i ];
+        const uint64_t    values[ INTERVAL_STATS_FIELDS ] = {
+            result->hits, result->capacityMisses, result->conflictMisses, result->compulsoryMisses, result->accesses,
+            result->writes, result->writeBacks, result->bytesRead, result->bytesWritten, result->prefetches,
+            result->usefulPrefetches, result->latePrefetches, result->victimProbes, result->victimHits,
+            result->backInvalidations
+        };
+
+        for ( size_t field = 0; field < INTERVAL_STATS_FIELDS; field++ ) {
+            writeLittleEndian64( fields + field * 8, values[ field ] );
+        }
+
+        if ( fwrite( fields, 1, sizeof( fields ), file ) < sizeof( fields ) ) {
+            perror( filePath );
+            exit( EXIT_FAILURE );
+        }
+    }
+}
+
+/*
+ * Writes the statistics of every interval to a file in the given format, see intervalFormat_t.
+ *
+ * The CSV file only has the traffic columns if traffic is set, and the prefetching, victim cache and inclusion columns
+ * if the hierarchy has them, like the output of the simulation. The binary file always has every counter.
+ */
+void writeIntervalStats( intervalStats_t * stats, cacheConfigList_t * cacheConfigList, bool traffic, int format, char * filePath ) {
+    FILE * file = fopen( filePath, format == INTERVAL_CSV ? "w" : "wb" );
+
+    if ( file == NULL ) {
+        perror( filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( format == INTERVAL_CSV ) {
+        writeIntervalCSV( stats, cacheConfigList, traffic, file );
+    } else {
+        writeIntervalBinary( stats, file, filePath );
+    }
+
+    if ( fclose( file ) != 0 ) {
+        perror( filePath );
+        exit( EXIT_FAILURE );
+    }
+}
+
+void destroyIntervalStats( intervalStats_t * stats ) {
+    free( stats->deltas );
+    free( stats->previous );
+    free( stats->current );
+    free( stats );
+}
+
+/*
+ * Gets the name of an interval file format, as given in the command line.
+ */
+const char * intervalFormatName( int format ) {
+    return format == INTERVAL_CSV ? "CSV" : "BIN";
+}
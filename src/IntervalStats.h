@@ -0,0 +1,65 @@
+#ifndef INTERVAL_STATS_H
+#define INTERVAL_STATS_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "CacheConfig.h"
+#include "Simulator.h"
+
+enum intervalFormat_t {
+    INTERVAL_CSV,    // One line per interval, with the columns of each level side by side
+    INTERVAL_BINARY  // See INTERVAL_STATS_MAGIC
+};
+
+/*
+ * Binary interval file layout, all fields are little-endian:
+ *
+ * Header (INTERVAL_STATS_HEADER_SIZE bytes):
+ *   magic (4 bytes, INTERVAL_STATS_MAGIC), version (u16), levels (u16), fields per level (u32), reserved (u32),
+ *   accesses of each interval (u64), interval count (u64), accesses of the trace (u64).
+ * Intervals:
+ *   for each interval, for each level from the highest to the lowest, INTERVAL_STATS_FIELDS u64 counters in the order
+ *   of result_t: hits, capacity misses, conflict misses, compulsory misses, accesses, writes, write-backs, bytes read,
+ *   bytes written, prefetches, useful prefetches, late prefetches, victim probes, victim hits and back-invalidations.
+ *
+ * The accesses of the trace are its addresses or its records, every interval but the last has the same number of them.
+ */
+#define INTERVAL_STATS_MAGIC "CSIV"
+#define INTERVAL_STATS_VERSION 1
+#define INTERVAL_STATS_HEADER_SIZE 40
+#define INTERVAL_STATS_FIELDS 15
+
+// Intervals preallocated when the length of the trace is not known in advance
+#define INTERVAL_STATS_INITIAL_CAPACITY 1024
+
+/*
+ * Statistics of every level of a cache hierarchy over consecutive intervals of a trace.
+ *
+ * The simulation counts down the accesses left in the current interval, and at the end of each interval the statistics
+ * of the levels are copied and their difference to the previous copy is stored, so the hierarchy itself is unaware of
+ * the intervals.
+ */
+typedef struct _intervalStats_t {
+    uint64_t       length;     // Accesses of the trace in each interval
+    uint64_t       remaining;  // Accesses left in the current interval
+    uint64_t       accesses;   // Accesses of the trace, only known after finishIntervals
+    unsigned long  levels;
+    size_t         count;
+    size_t         capacity;
+    result_t *     deltas;     // levels results of each interval, one interval after the other
+    result_t *     previous;   // Statistics of the levels at the end of the previous interval
+    result_t *     current;
+} intervalStats_t;
+
+intervalStats_t * initializeIntervalStats( uint64_t length, unsigned long levels, uint64_t accesses );
+void simulateIntervalChunk( simulation_t * simulation, intervalStats_t * stats, uint32_t * addresses, size_t addressesSize );
+void finishIntervals( intervalStats_t * stats, const result_t * results );
+result_t * simulateIntervals( uint32_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList, intervalStats_t * stats );
+result_t * simulateRecordIntervals( traceRecord_t * records, size_t recordsSize, cacheConfigList_t * cacheConfigList, intervalStats_t * stats );
+void writeIntervalStats( intervalStats_t * stats, cacheConfigList_t * cacheConfigList, bool traffic, int format, char * filePath );
+void destroyIntervalStats( intervalStats_t * stats );
+const char * intervalFormatName( int format );
+
+#endif
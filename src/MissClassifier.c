@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "MissClassifier.h"
+#include "BlockMap.h"
+#include "Simulator.h"
+
+/*
+ * Initializes the miss classifier of a cache level with bsize bytes per block and a total number of lines.
+ */
+missClassifier_t * initializeMissClassifier( uint32_t bsize, uint32_t lines ) {
+    missClassifier_t * classifier = malloc( sizeof( missClassifier_t ) );
+
+    if ( classifier == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    classifier->offsetBits = log2PowerOf2( bsize );
+    classifier->capacity = lines;
+    classifier->lines = 0;
+    classifier->head = SHADOW_LINE_NONE;
+    classifier->tail = SHADOW_LINE_NONE;
+
+    classifier->firstTouch = initializeFirstTouch();
+    classifier->blocks = malloc( sizeof( uint32_t ) * lines );
+    classifier->previous = malloc( sizeof( uint32_t ) * lines );
+    classifier->next = malloc( sizeof( uint32_t ) * lines );
+
+    if ( classifier->blocks == NULL || classifier->previous == NULL || classifier->next == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    initializeBlockMap( &classifier->lineOfBlock, lines < ( UINT32_C( 1 ) << 30 ) ? lines * 2 : lines );
+
+    return classifier;
+}
+
+static inline void unlinkShadowLine( missClassifier_t * classifier, uint32_t line ) {
+    uint32_t previous = classifier->previous[ line ];
+    uint32_t next = classifier->next[ line ];
+
+    if ( previous != SHADOW_LINE_NONE ) {
+        classifier->next[ previous ] = next;
+    } else {
+        classifier->head = next;
+    }
+
+    if ( next != SHADOW_LINE_NONE ) {
+        classifier->previous[ next ] = previous;
+    } else {
+        classifier->tail = previous;
+    }
+}
+
+static inline void pushShadowLine( missClassifier_t * classifier, uint32_t line ) {
+    classifier->previous[ line ] = SHADOW_LINE_NONE;
+    classifier->next[ line ] = classifier->head;
+
+    if ( classifier->head != SHADOW_LINE_NONE ) {
+        classifier->previous[ classifier->head ] = line;
+    } else {
+        classifier->tail = line;
+    }
+
+    classifier->head = line;
+}
+
+/*
+ * Accesses an address in the shadow cache and returns the kind of miss the access is if it misses in the real cache.
+ *
+ * Must be called for every access to the cache level, hits included, so the shadow cache sees the same accesses as
+ * the real cache.
+ */
+int classifyAccess( missClassifier_t * classifier, uint32_t address ) {
+    uint32_t    block = address >> classifier->offsetBits;
+    uint32_t *  line = blockMapFind( &classifier->lineOfBlock, block );
+    uint32_t    newLine;
+
+    if ( line != NULL ) {
+        // Shadow hit, move the line to the front of the list
+        if ( *line != classifier->head ) {
+            uint32_t hitLine = *line;
+
+            unlinkShadowLine( classifier, hitLine );
+            pushShadowLine( classifier, hitLine );
+        }
+
+        return CONFLICT_MISS;
+    }
+
+    // Shadow miss, take a free line or evict the least recently used one
+    if ( classifier->lines < classifier->capacity ) {
+        newLine = classifier->lines++;
+    } else {
+        newLine = classifier->tail;
+
+        unlinkShadowLine( classifier, newLine );
+        blockMapRemove( &classifier->lineOfBlock, classifier->blocks[ newLine ] );
+    }
+
+    classifier->blocks[ newLine ] = block;
+    pushShadowLine( classifier, newLine );
+    blockMapInsert( &classifier->lineOfBlock, block, newLine );
+
+    return touchBlock( classifier->firstTouch, block ) ? COMPULSORY_MISS : CAPACITY_MISS;
+}
+
+void destroyMissClassifier( missClassifier_t * classifier ) {
+    destroyFirstTouch( classifier->firstTouch );
+    free( classifier->blocks );
+    free( classifier->previous );
+    free( classifier->next );
+    destroyBlockMap( &classifier->lineOfBlock );
+    free( classifier );
+}
@@ -0,0 +1,46 @@
+#ifndef MISS_CLASSIFIER_H
+#define MISS_CLASSIFIER_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "BlockMap.h"
+#include "FirstTouch.h"
+
+// Marks the end of the shadow cache list
+#define SHADOW_LINE_NONE UINT32_MAX
+
+/*
+ * Kind of miss an access would be if it misses in the cache, by the textbook 3C definitions.
+ */
+enum missKind_t {
+    COMPULSORY_MISS,  // First access to the block
+    CAPACITY_MISS,    // Also misses in a fully associative LRU cache of the same capacity
+    CONFLICT_MISS     // Hits in a fully associative LRU cache of the same capacity
+};
+
+/*
+ * Classifies the misses of a cache level exactly.
+ *
+ * Blocks that have been accessed are tracked by a firstTouch_t. A shadow fully associative LRU cache with the same
+ * number of lines as the cache is kept as a doubly linked list of lines indexed by a block map, so each access takes
+ * constant time.
+ */
+typedef struct _missClassifier_t {
+    uint32_t        offsetBits;
+    firstTouch_t *  firstTouch;
+    uint32_t        capacity;  // Lines of the shadow cache
+    uint32_t        lines;     // Lines in use
+    uint32_t *      blocks;    // Block of each line
+    uint32_t *      previous;  // Next more recently used line
+    uint32_t *      next;      // Next less recently used line
+    uint32_t        head;      // Most recently used line
+    uint32_t        tail;      // Least recently used line
+    blockMap_t      lineOfBlock;
+} missClassifier_t;
+
+missClassifier_t * initializeMissClassifier( uint32_t bsize, uint32_t lines );
+int classifyAccess( missClassifier_t * classifier, uint32_t address );
+void destroyMissClassifier( missClassifier_t * classifier );
+
+#endif
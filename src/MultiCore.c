@@ -0,0 +1,436 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "CacheSimulator.h"
+#include "FileHandler.h"
+#include "Simulator.h"
+#include "CacheConfig.h"
+#include "BlockMap.h"
+#include "MultiCore.h"
+
+/*
+ * A core of a multi-core simulation: its trace, its private levels and the blocks other cores took from it.
+ */
+typedef struct _core_t {
+    cache_t *           cache;        // First private level, the last private level leads to the shared level
+    traceRecord_t *     records;
+    uint64_t *          timestamps;   // NULL unless the cores are interleaved by timestamp
+    size_t              size;
+    size_t              next;         // Next record to be accessed
+    blockMap_t          invalidated;  // Blocks invalidated by other cores and not missed since, see accessCoreBlock
+    coherenceResult_t   coherence;
+} core_t;
+
+/*
+ * State of a multi-core simulation.
+ */
+typedef struct _multiCore_t {
+    core_t *       cores;
+    unsigned int   coreCount;
+    unsigned long  privateLevels;
+    cache_t *      shared;
+    int            protocol;
+    uint32_t       bsize;         // Block size of every level, also the granularity of the coherence protocol
+} multiCore_t;
+
+/*
+ * Checks that a hierarchy can be simulated by simulateMultiCore, exiting with an error if it can't.
+ *
+ * The hierarchy needs at least two levels, every level but the last private to each core and the last shared. All the
+ * levels must have the same block size, which is the block size of the coherence protocol. Prefetchers, victim caches
+ * and inclusion policies move blocks in and out of the private levels behind the back of the protocol, so they aren't
+ * supported.
+ */
+void checkMultiCoreConfig( cacheConfigList_t * cacheConfigList ) {
+    if ( cacheConfigList->next == NULL ) {
+        fputs( "Erro: a simulação multi-core precisa de pelo menos 2 níveis, os privados de cada núcleo e o último compartilhado.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( cacheConfigList_t * current = cacheConfigList; current != NULL; current = current->next ) {
+        cacheConfig_t * cacheConfig = &current->cacheConfig;
+
+        if ( cacheConfig->bsize != cacheConfigList->cacheConfig.bsize ) {
+            fputs( "Erro: todos os níveis da simulação multi-core devem ter o mesmo tamanho de bloco.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+
+        if ( cacheConfig->prefetcher != PREFETCH_NONE || cacheConfig->victimCache != VICTIM_CACHE_NONE || cacheConfig->reportInclusion ) {
+            fputs( "Erro: as opções --prefetch, --victim e --inclusion não podem ser usadas com --core.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+    }
+}
+
+/*
+ * Finds the flags of the copies of a block in the private levels of a core, ORed together, returning whether any
+ * level holds it.
+ */
+static bool findCoreBlock( multiCore_t * multiCore, core_t * core, uint64_t block, uint8_t * flags ) {
+    cache_t *  level = core->cache;
+    bool       present = false;
+
+    *flags = 0;
+
+    for ( unsigned long i = 0; i < multiCore->privateLevels; i++, level = level->nextLevel ) {
+        size_t line = findBlockLine( level, block );
+
+        if ( line != NO_LINE ) {
+            *flags |= level->lineFlags[ line ];
+            present = true;
+        }
+    }
+
+    return present;
+}
+
+/*
+ * Clears and then sets flags of the copies of a block in the private levels of a core.
+ */
+static void updateCoreBlock( multiCore_t * multiCore, core_t * core, uint64_t block, uint8_t clear, uint8_t set ) {
+    cache_t * level = core->cache;
+
+    for ( unsigned long i = 0; i < multiCore->privateLevels; i++, level = level->nextLevel ) {
+        size_t line = findBlockLine( level, block );
+
+        if ( line != NO_LINE ) {
+            level->lineFlags[ line ] = ( uint8_t )( ( level->lineFlags[ line ] & ~clear ) | set );
+        }
+    }
+}
+
+/*
+ * Invalidates the copies of a block in the private levels of a core, returning their flags ORed together.
+ */
+static uint8_t invalidateCoreBlock( multiCore_t * multiCore, core_t * core, uint64_t block ) {
+    cache_t *  level = core->cache;
+    uint8_t    flags = 0;
+
+    for ( unsigned long i = 0; i < multiCore->privateLevels; i++, level = level->nextLevel ) {
+        size_t line = findBlockLine( level, block );
+
+        if ( line != NO_LINE ) {
+            flags |= invalidateLine( level, line );
+        }
+    }
+
+    return flags;
+}
+
+/*
+ * Writes a dirty block of a core to the shared level, on behalf of another core that accessed it.
+ */
+static void flushCoreBlock( multiCore_t * multiCore, core_t * core, uint64_t block ) {
+    core->coherence.flushes++;
+
+    multiCore->shared->partition->tenant = ( unsigned int )( core - multiCore->cores );
+
+    accessCacheRange( multiCore->shared, block, true, multiCore->bsize );
+}
+
+/*
+ * Snoops the private levels of every core other than requester for a block that requester is about to read or write
+ * without holding it, or to write while holding it as shared, returning whether any other core holds it after the
+ * snoop.
+ *
+ * A write invalidates every other copy, writing dirty copies to the shared level first. A read makes every other copy
+ * shared: a modified copy is written to the shared level and becomes clean in MESI, and stays dirty as the owner of the
+ * block in MOESI.
+ */
+static bool snoopCores( multiCore_t * multiCore, core_t * requester, uint64_t block, bool write ) {
+    bool shared = false;
+
+    for ( unsigned int i = 0; i < multiCore->coreCount; i++ ) {
+        core_t *  core = &multiCore->cores[ i ];
+        uint8_t   flags;
+
+        if ( core == requester || !findCoreBlock( multiCore, core, block, &flags ) ) {
+            continue;
+        }
+
+        if ( write ) {
+            if ( invalidateCoreBlock( multiCore, core, block ) & LINE_DIRTY ) {
+                flushCoreBlock( multiCore, core, block );
+            }
+
+            core->coherence.invalidations++;
+            blockMapInsert( &core->invalidated, ( uint32_t )( block / multiCore->bsize ), 0 );
+        } else if ( ( flags & LINE_DIRTY ) != 0 && multiCore->protocol == COHERENCE_MESI ) {
+            flushCoreBlock( multiCore, core, block );
+            updateCoreBlock( multiCore, core, block, LINE_DIRTY, LINE_SHARED );
+
+            shared = true;
+        } else {
+            updateCoreBlock( multiCore, core, block, 0, LINE_SHARED );
+
+            shared = true;
+        }
+    }
+
+    return shared;
+}
+
+/*
+ * Reads or writes size bytes of a block from address on in the private levels of a core, keeping the block coherent
+ * with the other cores.
+ *
+ * The state of a block in a core follows from the flags of its copies: modified if dirty and not shared, owned if
+ * dirty and shared, exclusive if clean and not shared and shared if clean and shared. Reads of a block the core holds
+ * and writes of a block it holds exclusively don't need the other cores. A miss to a block the core lost to a write
+ * of another core is a sharing miss.
+ */
+static void accessCoreBlock( multiCore_t * multiCore, core_t * core, uint64_t address, bool write, uint64_t size ) {
+    uint64_t  block = address & ~( uint64_t )( multiCore->bsize - 1 );
+    uint8_t   flags;
+    bool      present = findCoreBlock( multiCore, core, block, &flags );
+    bool      shared = false;
+
+    if ( !present ) {
+        uint32_t key = ( uint32_t )( block / multiCore->bsize );
+
+        if ( blockMapFind( &core->invalidated, key ) != NULL ) {
+            core->coherence.sharingMisses++;
+            blockMapRemove( &core->invalidated, key );
+        }
+    }
+
+    if ( write && present && ( flags & LINE_SHARED ) != 0 ) {
+        core->coherence.upgrades++;
+    }
+
+    if ( !present || ( write && ( flags & LINE_SHARED ) != 0 ) ) {
+        shared = snoopCores( multiCore, core, block, write );
+    }
+
+    multiCore->shared->partition->tenant = ( unsigned int )( core - multiCore->cores );
+
+    accessCacheRange( core->cache, address, write, size );
+
+    if ( write ) {
+        updateCoreBlock( multiCore, core, block, LINE_SHARED, 0 );
+    } else if ( shared ) {
+        updateCoreBlock( multiCore, core, block, 0, LINE_SHARED );
+    }
+}
+
+/*
+ * Accesses the next record of a core, one block at a time like accessCacheRange.
+ */
+static void accessCoreRecord( multiCore_t * multiCore, core_t * core ) {
+    traceRecord_t *  record = &core->records[ core->next++ ];
+    uint64_t         address = record->address;
+    uint64_t         size = record->size > 0 ? record->size : 1;
+    uint64_t         end;
+
+    if ( size > ( UINT64_C( 1 ) << 32 ) - address ) {
+        size = ( UINT64_C( 1 ) << 32 ) - address;
+    }
+
+    for ( end = address + size; address < end; ) {
+        uint64_t blockEnd = ( address | ( multiCore->bsize - 1 ) ) + 1;
+        uint64_t pieceEnd = blockEnd < end ? blockEnd : end;
+
+        accessCoreBlock( multiCore, core, address, record->operation == TRACE_WRITE, pieceEnd - address );
+
+        address = pieceEnd;
+    }
+}
+
+/*
+ * Simulates cores running the read/write traces of tracePaths at the same time, core i running the trace i, each with
+ * its own private levels, every level of the configuration but the last, and all of them sharing the last level. The
+ * hierarchy must pass checkMultiCoreConfig.
+ *
+ * The private levels of the cores are kept coherent by a snooping protocol, MESI or MOESI, with the block size of the
+ * levels as its granularity. Blocks always come from the shared level, even when another core holds a copy, and a
+ * dirty copy another core needs is written to the shared level first, so the shared level always has the data.
+ *
+ * Each core is a tenant of the partitions of the levels, see tenantPartition_t, and the use of the shared level by each
+ * core is counted whether it's partitioned or not.
+ *
+ * The records of the cores are interleaved round-robin, skipping the cores whose trace is over, or by timestamp, in
+ * which case the traces are timed traces, see handleTimedRecordFile, and ties go to the lowest core. Records are
+ * accessed like in simulateRecords.
+ *
+ * The result is dynamically allocated, caller is responsible for freeing it with destroyMultiCoreResult.
+ */
+multiCoreResult_t * simulateMultiCore( char ** tracePaths, unsigned int cores, cacheConfigList_t * cacheConfigList, int protocol, int interleaving ) {
+    multiCore_t          multiCore;
+    multiCoreResult_t *  result = malloc( sizeof( multiCoreResult_t ) );
+    cacheConfigList_t *  lastPrivate = cacheConfigList;
+    size_t               remaining = 0;
+
+    multiCore.cores = malloc( sizeof( core_t ) * cores );
+
+    if ( result == NULL || multiCore.cores == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    multiCore.coreCount = cores;
+    multiCore.privateLevels = countCacheLevels( cacheConfigList ) - 1;
+    multiCore.protocol = protocol;
+    multiCore.bsize = cacheConfigList->cacheConfig.bsize;
+
+    while ( lastPrivate->next->next != NULL ) {
+        lastPrivate = lastPrivate->next;
+    }
+
+    multiCore.shared = initializeCache( lastPrivate->next );
+    multiCore.shared->directMapped = false;
+
+    // The shared level always counts the use of each core, even if it isn't partitioned
+    if ( multiCore.shared->partition == NULL ) {
+        multiCore.shared->partition = initializeTenantPartition( &multiCore.shared->cacheConfig, ( size_t )multiCore.shared->cacheConfig.nsets * multiCore.shared->cacheConfig.assoc );
+    }
+
+    // The private levels of each core are built from the configuration cut before the last level
+    cacheConfigList_t * sharedConfig = lastPrivate->next;
+
+    lastPrivate->next = NULL;
+
+    for ( unsigned int i = 0; i < cores; i++ ) {
+        core_t * core = &multiCore.cores[ i ];
+
+        core->cache = initializeCache( cacheConfigList );
+        core->cache->directMapped = false;
+        core->timestamps = NULL;
+        core->next = 0;
+        core->coherence = ( coherenceResult_t ){ 0 };
+
+        // Each core is the only tenant of its private levels, the last of them leads to the shared level
+        for ( cache_t * level = core->cache; level != multiCore.shared; level = level->nextLevel ) {
+            if ( level->partition != NULL ) {
+                level->partition->tenant = i;
+            }
+
+            if ( level->nextLevel == NULL ) {
+                level->nextLevel = multiCore.shared;
+            }
+        }
+
+        if ( interleaving == INTERLEAVE_TIMESTAMP ) {
+            handleTimedRecordFile( tracePaths[ i ], &core->records, &core->timestamps, &core->size );
+        } else {
+            handleRecordFile( tracePaths[ i ], &core->records, &core->size );
+        }
+
+        core->coherence.records = core->size;
+        remaining += core->size;
+
+        initializeBlockMap( &core->invalidated, 1024 );
+    }
+
+    lastPrivate->next = sharedConfig;
+
+    while ( remaining > 0 ) {
+        if ( interleaving == INTERLEAVE_TIMESTAMP ) {
+            core_t * earliest = NULL;
+
+            for ( unsigned int i = 0; i < cores; i++ ) {
+                core_t * core = &multiCore.cores[ i ];
+
+                if ( core->next < core->size && ( earliest == NULL || core->timestamps[ core->next ] < earliest->timestamps[ earliest->next ] ) ) {
+                    earliest = core;
+                }
+            }
+
+            accessCoreRecord( &multiCore, earliest );
+            remaining--;
+        } else {
+            for ( unsigned int i = 0; i < cores; i++ ) {
+                if ( multiCore.cores[ i ].next < multiCore.cores[ i ].size ) {
+                    accessCoreRecord( &multiCore, &multiCore.cores[ i ] );
+                    remaining--;
+                }
+            }
+        }
+    }
+
+    result->cores = cores;
+    result->privateLevels = multiCore.privateLevels;
+    result->privateResults = malloc( sizeof( result_t ) * cores * multiCore.privateLevels );
+    result->coherence = malloc( sizeof( coherenceResult_t ) * cores );
+    result->sharedTenants = malloc( sizeof( tenantResult_t ) * cores );
+
+    if ( result->privateResults == NULL || result->coherence == NULL || result->sharedTenants == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( unsigned int i = 0; i < cores; i++ ) {
+        core_t *   core = &multiCore.cores[ i ];
+        cache_t *  level = core->cache;
+
+        for ( unsigned long j = 0; j < multiCore.privateLevels; j++ ) {
+            result->privateResults[ i * multiCore.privateLevels + j ] = level->result;
+
+            // The shared level is destroyed once, after every core
+            if ( level->nextLevel == multiCore.shared ) {
+                level->nextLevel = NULL;
+            } else {
+                level = level->nextLevel;
+            }
+        }
+
+        result->coherence[ i ] = core->coherence;
+
+        destroyCache( core->cache );
+        destroyBlockMap( &core->invalidated );
+        releaseFile( core->records );
+        free( core->timestamps );
+    }
+
+    result->shared = multiCore.shared->result;
+
+    countTenantLines( multiCore.shared );
+
+    for ( unsigned int i = 0; i < cores; i++ ) {
+        result->sharedTenants[ i ] = multiCore.shared->partition->results[ i ];
+    }
+
+    destroyCache( multiCore.shared );
+    free( multiCore.cores );
+
+    return result;
+}
+
+/*
+ * Frees the result of a multi-core simulation.
+ */
+void destroyMultiCoreResult( multiCoreResult_t * result ) {
+    free( result->privateResults );
+    free( result->coherence );
+    free( result->sharedTenants );
+    free( result );
+}
+
+/*
+ * Gets the name that selects a coherence protocol in the --coherence option.
+ */
+const char * coherenceProtocolName( int protocol ) {
+    switch ( protocol ) {
+        case COHERENCE_MESI:
+            return "MESI";
+        case COHERENCE_MOESI:
+            return "MOESI";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+/*
+ * Gets the name that selects an interleaving of the cores in the --interleave option.
+ */
+const char * interleavingName( int interleaving ) {
+    switch ( interleaving ) {
+        case INTERLEAVE_ROUND_ROBIN:
+            return "RR";
+        case INTERLEAVE_TIMESTAMP:
+            return "TIME";
+        default:
+            return "UNKNOWN";
+    }
+}
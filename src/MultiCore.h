@@ -0,0 +1,52 @@
+#ifndef MULTI_CORE_H
+#define MULTI_CORE_H
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#include "CacheConfig.h"
+#include "Simulator.h"
+
+// Largest number of cores of a multi-core simulation, each with its own trace and its own tenant of the partitions
+#define MULTI_CORE_MAX_CORES PARTITION_MAX_TENANTS
+
+enum coherenceProtocol_t {
+    COHERENCE_MESI,  // A read of a block modified by another core makes that core write it to the shared level
+    COHERENCE_MOESI  // A read of a block modified by another core leaves that core as its owner, still dirty
+};
+
+enum interleaving_t {
+    INTERLEAVE_ROUND_ROBIN,  // One record of each core at a time, in the order of the cores
+    INTERLEAVE_TIMESTAMP     // The record with the lowest timestamp first, see handleTimedRecordFile
+};
+
+/*
+ * Coherence statistics of a core of a multi-core simulation.
+ */
+typedef struct _coherenceResult_t {
+    uint64_t  records;        // Records of the trace of the core
+    uint64_t  invalidations;  // Blocks of the core invalidated by writes of other cores
+    uint64_t  sharingMisses;  // Misses of the private levels of the core to blocks invalidated by other cores
+    uint64_t  upgrades;       // Writes to blocks the core held as shared, which invalidate the copies of other cores
+    uint64_t  flushes;        // Dirty blocks written to the shared level because another core accessed them
+} coherenceResult_t;
+
+/*
+ * Results of a multi-core simulation: every level but the last is private to each core, the last level is shared.
+ */
+typedef struct _multiCoreResult_t {
+    unsigned int          cores;
+    unsigned long         privateLevels;
+    result_t *            privateResults;  // privateLevels results of each core, one core after the other
+    coherenceResult_t *   coherence;       // One per core
+    result_t              shared;
+    tenantResult_t *      sharedTenants;   // One per core, its accesses, hits and lines in the shared level
+} multiCoreResult_t;
+
+void checkMultiCoreConfig( cacheConfigList_t * cacheConfigList );
+multiCoreResult_t * simulateMultiCore( char ** tracePaths, unsigned int cores, cacheConfigList_t * cacheConfigList, int protocol, int interleaving );
+void destroyMultiCoreResult( multiCoreResult_t * result );
+const char * coherenceProtocolName( int protocol );
+const char * interleavingName( int interleaving );
+
+#endif
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "Parallel.h"
+
+// Number of worker threads, 0 means the number of online processors is used
+static unsigned int threadCount = 0;
+
+/*
+ * Shared state of a parallelFor call, the tasks are handed to the workers one at a time so uneven tasks are balanced.
+ */
+typedef struct _parallelFor_t {
+    parallelTask_t  task;
+    void *          context;
+    unsigned int    taskCount;
+    atomic_uint     nextTask;
+} parallelFor_t;
+
+/*
+ * Gets the number of worker threads used by parallel work.
+ *
+ * Defaults to the number of online processors.
+ */
+unsigned int getThreadCount( void ) {
+    if ( threadCount != 0 ) {
+        return threadCount;
+    }
+
+    #if defined( _SC_NPROCESSORS_ONLN )
+    long processors = sysconf( _SC_NPROCESSORS_ONLN );
+
+    return processors > 0 ? ( unsigned int )processors : 1;
+    #elif defined( _WIN32 )
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo( &systemInfo );
+
+    return systemInfo.dwNumberOfProcessors > 0 ? systemInfo.dwNumberOfProcessors : 1;
+    #else
+    return 1;
+    #endif
+}
+
+/*
+ * Sets the number of worker threads used by parallel work, 0 restores the default.
+ */
+void setThreadCount( unsigned int count ) {
+    threadCount = count;
+}
+
+/*
+ * Worker thread, runs tasks until there are no tasks left.
+ */
+static void * runTasks( void * argument ) {
+    parallelFor_t *  parallel = argument;
+    unsigned int     index;
+
+    while ( ( index = atomic_fetch_add( &parallel->nextTask, 1 ) ) < parallel->taskCount ) {
+        parallel->task( parallel->context, index );
+    }
+
+    return NULL;
+}
+
+/*
+ * Runs task for every index from 0 to taskCount - 1 on up to getThreadCount() threads and waits for all of them.
+ *
+ * The calling thread also runs tasks, so no threads are created when there is a single task or a single thread.
+ */
+void parallelFor( unsigned int taskCount, parallelTask_t task, void * context ) {
+    parallelFor_t  parallel = { .task = task, .context = context, .taskCount = taskCount };
+    unsigned int   workers = getThreadCount();
+    pthread_t *    threads;
+
+    atomic_init( &parallel.nextTask, 0 );
+
+    if ( workers > taskCount ) {
+        workers = taskCount;
+    }
+
+    if ( workers <= 1 ) {
+        runTasks( &parallel );
+
+        return;
+    }
+
+    threads = malloc( sizeof( pthread_t ) * ( workers - 1 ) );
+
+    if ( threads == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( unsigned int i = 0; i < workers - 1; i++ ) {
+        if ( pthread_create( &threads[ i ], NULL, runTasks, &parallel ) != 0 ) {
+            fputs( "Erro: não foi possível criar uma thread de trabalho.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    runTasks( &parallel );
+
+    for ( unsigned int i = 0; i < workers - 1; i++ ) {
+        pthread_join( threads[ i ], NULL );
+    }
+
+    free( threads );
+}
@@ -0,0 +1,10 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+typedef void ( * parallelTask_t )( void * context, unsigned int index );
+
+unsigned int getThreadCount( void );
+void setThreadCount( unsigned int threadCount );
+void parallelFor( unsigned int taskCount, parallelTask_t task, void * context );
+
+#endif
@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "Performance.h"
+#include "Simulator.h"
+#include "CacheConfig.h"
+
+/*
+ * Checks if any latency or energy parameter of a cache hierarchy was set, so its performance is worth reporting.
+ */
+bool hasPerformanceModel( cacheConfigList_t * cacheConfigList ) {
+    for ( cacheConfigList_t * current = cacheConfigList; current != NULL; current = current->next ) {
+        cacheConfig_t * cacheConfig = &current->cacheConfig;
+
+        if ( cacheConfig->hitLatency > 0 || cacheConfig->missPenalty > 0 || cacheConfig->accessEnergy > 0
+            || cacheConfig->memoryLatency > 0 || cacheConfig->memoryEnergy > 0 ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Estimates the cycles and energy of the accesses of a simulation from the statistics of each level.
+ *
+ * Every access to a level takes its hit latency, hits and misses alike, and accesses are not overlapped. The stall
+ * cycles of a level are the miss penalty of each of its misses plus the hit latency of each access to the next level,
+ * or the memory latency of each access to memory for the last level. Memory is accessed by the misses and write-backs
+ * of the last level. The AMAT is the hit latency of the first level plus the stall cycles of all levels, per access to
+ * the first level.
+ *
+ * levels has one entry per level, from the highest to the lowest level.
+ */
+void estimatePerformance( cacheConfigList_t * cacheConfigList, const result_t * results, performance_t * performance, levelPerformance_t * levels ) {
+    size_t i = 0;
+
+    performance->cycles = results[ 0 ].accesses * cacheConfigList->cacheConfig.hitLatency;
+    performance->energy = 0;
+    performance->memoryEnergy = 0;
+
+    for ( cacheConfigList_t * current = cacheConfigList; current != NULL; current = current->next, i++ ) {
+        cacheConfig_t *   cacheConfig = &current->cacheConfig;
+        const result_t *  result = &results[ i ];
+        uint64_t          misses = result->compulsoryMisses + result->capacityMisses + result->conflictMisses;
+
+        levels[ i ].stallCycles = misses * cacheConfig->missPenalty;
+        levels[ i ].energy = result->accesses * cacheConfig->accessEnergy;
+
+        if ( current->next != NULL ) {
+            levels[ i ].stallCycles += results[ i + 1 ].accesses * current->next->cacheConfig.hitLatency;
+        } else {
+            uint64_t memoryAccesses = misses + result->writeBacks;
+
+            levels[ i ].stallCycles += memoryAccesses * cacheConfig->memoryLatency;
+            performance->memoryEnergy = memoryAccesses * cacheConfig->memoryEnergy;
+        }
+
+        performance->cycles += levels[ i ].stallCycles;
+        performance->energy += levels[ i ].energy;
+    }
+
+    performance->energy += performance->memoryEnergy;
+    performance->amat = results[ 0 ].accesses > 0 ? performance->cycles / results[ 0 ].accesses : 0.0;
+}
+
+/*
+ * Checks if any level of a cache hierarchy has a prefetcher, so its effectiveness is worth reporting.
+ */
+bool hasPrefetcher( cacheConfigList_t * cacheConfigList ) {
+    for ( cacheConfigList_t * current = cacheConfigList; current != NULL; current = current->next ) {
+        if ( current->cacheConfig.prefetcher != PREFETCH_NONE ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Checks if any level of a cache hierarchy has a victim or miss cache.
+ */
+bool hasVictimCache( cacheConfigList_t * cacheConfigList ) {
+    for ( cacheConfigList_t * current = cacheConfigList; current != NULL; current = current->next ) {
+        if ( current->cacheConfig.victimCache != VICTIM_CACHE_NONE ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Computes the effectiveness of the prefetcher of a cache level from its statistics.
+ *
+ * Each useful prefetch is a miss the level would have had without its prefetcher, so the coverage is the useful
+ * prefetches over themselves plus the demand misses left. A useful prefetch is late if its block was used less than
+ * PREFETCH_TIMELY_DISTANCE accesses to the level after it was prefetched, too soon for the block to have arrived.
+ */
+void computePrefetchStatistics( const cacheConfig_t * cacheConfig, const result_t * result, prefetchStatistics_t * statistics ) {
+    uint64_t misses = result->compulsoryMisses + result->capacityMisses + result->conflictMisses;
+
+    statistics->accuracy = result->prefetches > 0 ? ( double )result->usefulPrefetches / result->prefetches : 0.0;
+    statistics->coverage = result->usefulPrefetches + misses > 0 ? ( double )result->usefulPrefetches / ( result->usefulPrefetches + misses ) : 0.0;
+    statistics->timeliness = result->usefulPrefetches > 0 ? ( double )( result->usefulPrefetches - result->latePrefetches ) / result->usefulPrefetches : 0.0;
+    statistics->traffic = result->prefetches * cacheConfig->bsize;
+}
@@ -0,0 +1,45 @@
+#ifndef PERFORMANCE_H
+#define PERFORMANCE_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "CacheConfig.h"
+#include "Simulator.h"
+
+/*
+ * Estimated cost of a cache level.
+ */
+typedef struct _levelPerformance_t {
+    double  stallCycles;  // Cycles spent on the misses of the level, in the levels below it or in memory
+    double  energy;       // Energy of the accesses to the level, in nJ
+} levelPerformance_t;
+
+/*
+ * Estimated cost of a cache hierarchy.
+ */
+typedef struct _performance_t {
+    double  amat;          // Average memory access time of the accesses to the first level, in cycles
+    double  cycles;        // Cycles of all accesses
+    double  energy;        // Energy of all levels and memory, in nJ
+    double  memoryEnergy;  // Energy of the accesses to memory, in nJ
+} performance_t;
+
+/*
+ * Effectiveness of the prefetcher of a cache level.
+ */
+typedef struct _prefetchStatistics_t {
+    double    accuracy;    // Useful prefetches per prefetch
+    double    coverage;    // Useful prefetches per miss the level would have without its prefetcher
+    double    timeliness;  // Useful prefetches that were not late per useful prefetch
+    uint64_t  traffic;     // Bytes read from the next level by the prefetches
+} prefetchStatistics_t;
+
+bool hasPerformanceModel( cacheConfigList_t * cacheConfigList );
+void estimatePerformance( cacheConfigList_t * cacheConfigList, const result_t * results, performance_t * performance, levelPerformance_t * levels );
+
+bool hasPrefetcher( cacheConfigList_t * cacheConfigList );
+bool hasVictimCache( cacheConfigList_t * cacheConfigList );
+void computePrefetchStatistics( const cacheConfig_t * cacheConfig, const result_t * result, prefetchStatistics_t * statistics );
+
+#endif
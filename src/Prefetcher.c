@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "Prefetcher.h"
+
+/*
+ * Initializes the prefetcher of a cache level with a number of lines, whose blocks have offsetBits bits of offset.
+ *
+ * addressBits is the number of significant bits of the addresses, 0 for 32-bit addresses, so blocks past the end of
+ * the address space are never prefetched.
+ */
+prefetcher_t * initializePrefetcher( int kind, uint32_t degree, uint32_t distance, uint32_t offsetBits, uint32_t addressBits, size_t lines ) {
+    prefetcher_t * prefetcher = malloc( sizeof( prefetcher_t ) );
+
+    if ( prefetcher == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    uint32_t blockBits = ( addressBits > 32 ? addressBits : 32 ) - offsetBits;
+
+    prefetcher->kind = kind;
+    prefetcher->degree = degree;
+    prefetcher->distance = distance;
+    prefetcher->regionShift = offsetBits < PREFETCH_REGION_BITS ? PREFETCH_REGION_BITS - offsetBits : 0;
+    prefetcher->maxBlock = blockBits >= 64 ? UINT64_MAX : ( UINT64_C( 1 ) << blockBits ) - 1;
+    prefetcher->accesses = 0;
+    prefetcher->strides = calloc( PREFETCH_TABLE_SIZE, sizeof( strideEntry_t ) );
+    prefetcher->streams = calloc( PREFETCH_STREAM_COUNT, sizeof( streamEntry_t ) );
+    prefetcher->issued = calloc( lines, sizeof( uint64_t ) );
+
+    if ( prefetcher->strides == NULL || prefetcher->streams == NULL || prefetcher->issued == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    return prefetcher;
+}
+
+/*
+ * Adds the block at an offset of a number of blocks from another to the candidates, unless it's outside the address
+ * space. Returns the new number of candidates.
+ */
+static size_t addCandidate( prefetcher_t * prefetcher, uint64_t * candidates, size_t count, uint64_t block, int64_t offset ) {
+    if ( offset >= 0 ? prefetcher->maxBlock - block < ( uint64_t )offset : block < ( uint64_t )-offset ) {
+        return count;
+    }
+
+    candidates[ count ] = block + ( uint64_t )offset;
+
+    return count + 1;
+}
+
+/*
+ * Trains the stride table with an access and picks the blocks ahead of it once the same stride is seen twice in a row
+ * in its region.
+ */
+static size_t trainStride( prefetcher_t * prefetcher, uint64_t block, uint64_t * candidates ) {
+    uint64_t         region = block >> prefetcher->regionShift;
+    strideEntry_t *  entry = &prefetcher->strides[ region % PREFETCH_TABLE_SIZE ];
+    size_t           count = 0;
+
+    if ( !entry->valid || entry->region != region ) {
+        *entry = ( strideEntry_t ){ .region = region, .lastBlock = block, .stride = 0, .confidence = 0, .valid = true };
+
+        return 0;
+    }
+
+    int64_t stride = ( int64_t )( block - entry->lastBlock );
+
+    if ( stride == 0 ) {
+        return 0;
+    }
+
+    if ( stride == entry->stride ) {
+        entry->confidence += entry->confidence < PREFETCH_STRIDE_CONFIDENCE_MAX;
+    } else {
+        entry->stride = stride;
+        entry->confidence = 0;
+    }
+
+    entry->lastBlock = block;
+
+    if ( entry->confidence >= 1 ) {
+        for ( uint32_t i = 0; i < prefetcher->degree; i++ ) {
+            count = addCandidate( prefetcher, candidates, count, block, stride * ( int64_t )( prefetcher->distance + i ) );
+        }
+    }
+
+    return count;
+}
+
+/*
+ * Trains the stream detector with an access and picks the next blocks of its stream, up to distance blocks ahead of
+ * the access. A miss near the last block of a training stream sets its direction, misses that don't belong to any
+ * stream start a new one, replacing the least recently used stream.
+ */
+static size_t trainStream( prefetcher_t * prefetcher, uint64_t block, bool miss, uint64_t * candidates ) {
+    streamEntry_t *  victim = NULL;
+    size_t           count = 0;
+
+    for ( size_t i = 0; i < PREFETCH_STREAM_COUNT; i++ ) {
+        streamEntry_t *  stream = &prefetcher->streams[ i ];
+        int64_t          delta = ( int64_t )( block - stream->lastBlock );
+
+        // Prefer an unused stream as the victim, then the least recently used one
+        if ( victim == NULL || ( victim->valid && ( !stream->valid || stream->lastUse < victim->lastUse ) ) ) {
+            victim = stream;
+        }
+
+        if ( !stream->valid ) {
+            continue;
+        }
+
+        if ( stream->direction == 0 ) {
+            if ( !miss || delta == 0 || delta < -PREFETCH_STREAM_WINDOW || delta > PREFETCH_STREAM_WINDOW ) {
+                continue;
+            }
+
+            stream->direction = delta > 0 ? 1 : -1;
+            stream->prefetchedBlock = block;
+        } else {
+            // Accesses ahead of the last block, up to the farthest prefetch or distance blocks, advance the stream
+            int64_t ahead = delta * stream->direction;
+            int64_t prefetched = ( int64_t )( stream->prefetchedBlock - stream->lastBlock ) * stream->direction;
+
+            if ( ahead <= 0 || ( ahead > prefetched && ahead > ( int64_t )prefetcher->distance ) ) {
+                continue;
+            }
+
+            if ( ahead > prefetched ) {
+                stream->prefetchedBlock = block;
+            }
+        }
+
+        stream->lastBlock = block;
+        stream->lastUse = prefetcher->accesses;
+
+        while ( count < prefetcher->degree && ( int64_t )( stream->prefetchedBlock - block ) * stream->direction < ( int64_t )prefetcher->distance ) {
+            size_t added = addCandidate( prefetcher, candidates, count, stream->prefetchedBlock, stream->direction );
+
+            if ( added == count ) {
+                break;
+            }
+
+            stream->prefetchedBlock = candidates[ count ];
+            count = added;
+        }
+
+        return count;
+    }
+
+    if ( miss ) {
+        *victim = ( streamEntry_t ){ .lastBlock = block, .prefetchedBlock = block, .direction = 0, .lastUse = prefetcher->accesses, .valid = true };
+    }
+
+    return 0;
+}
+
+/*
+ * Trains a prefetcher with a demand access to a block of its level and writes the blocks to be prefetched to
+ * candidates, which must fit degree blocks. miss is whether the access missed and prefetchHit whether it was the first
+ * use of a prefetched line. Returns the number of candidates, which may already be in the level.
+ */
+size_t trainPrefetcher( prefetcher_t * prefetcher, uint64_t block, bool miss, bool prefetchHit, uint64_t * candidates ) {
+    size_t count = 0;
+
+    prefetcher->accesses++;
+
+    switch ( prefetcher->kind ) {
+        case PREFETCH_NEXT:
+            if ( miss || prefetchHit ) {
+                for ( uint32_t i = 0; i < prefetcher->degree; i++ ) {
+                    count = addCandidate( prefetcher, candidates, count, block, ( int64_t )( prefetcher->distance + i ) );
+                }
+            }
+            break;
+        case PREFETCH_STRIDE:
+            count = trainStride( prefetcher, block, candidates );
+            break;
+        case PREFETCH_STREAM:
+            count = trainStream( prefetcher, block, miss, candidates );
+            break;
+        default:
+            break;
+    }
+
+    return count;
+}
+
+/*
+ * Gets the name that selects a kind of prefetcher in the --prefetch option.
+ */
+const char * prefetcherName( int kind ) {
+    switch ( kind ) {
+        case PREFETCH_NEXT:
+            return "NEXT";
+        case PREFETCH_STRIDE:
+            return "STRIDE";
+        case PREFETCH_STREAM:
+            return "STREAM";
+        default:
+            return "NONE";
+    }
+}
+
+/*
+ * Destroys a prefetcher.
+ */
+void destroyPrefetcher( prefetcher_t * prefetcher ) {
+    free( prefetcher->strides );
+    free( prefetcher->streams );
+    free( prefetcher->issued );
+    free( prefetcher );
+}
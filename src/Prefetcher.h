@@ -0,0 +1,79 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Largest number of blocks a prefetcher issues per access
+#define PREFETCH_MAX_DEGREE 64
+
+// Entries of the stride table, indexed by region
+#define PREFETCH_TABLE_SIZE 64
+
+// Bits of the addresses covered by each region of the stride table, the traces carry no program counter
+#define PREFETCH_REGION_BITS 12
+
+// Streams tracked by the stream prefetcher
+#define PREFETCH_STREAM_COUNT 16
+
+// Blocks between two misses that start a stream, in either direction
+#define PREFETCH_STREAM_WINDOW 2
+
+// Saturation value of the confidence of the stride table entries, a stride seen twice in a row has a confidence of 1
+#define PREFETCH_STRIDE_CONFIDENCE_MAX 3
+
+// Accesses to a level that a prefetch must come before the first use of its block to be timely
+#define PREFETCH_TIMELY_DISTANCE 16
+
+enum prefetcherKind_t {
+    PREFETCH_NONE,
+    PREFETCH_NEXT,    // Next-N-line, tagged: triggered by misses and by the first use of prefetched lines
+    PREFETCH_STRIDE,  // Stride table indexed by region
+    PREFETCH_STREAM   // Stream detector that runs ahead of ascending and descending streams of misses
+};
+
+typedef struct _strideEntry_t {
+    uint64_t  region;
+    uint64_t  lastBlock;
+    int64_t   stride;
+    uint32_t  confidence;
+    bool      valid;
+} strideEntry_t;
+
+/*
+ * A stream of the stream prefetcher. A stream is trained by its first two misses, which set its direction, and then
+ * prefetches ahead of the last block accessed in it.
+ */
+typedef struct _streamEntry_t {
+    uint64_t  lastBlock;
+    uint64_t  prefetchedBlock; // Farthest block prefetched
+    int       direction;       // 1 or -1, 0 while training
+    uint64_t  lastUse;         // For the LRU replacement of streams
+    bool      valid;
+} streamEntry_t;
+
+/*
+ * A hardware prefetcher attached to a cache level, which picks blocks to be prefetched from the demand accesses of the
+ * level. Blocks are block numbers, addresses without their offset bits.
+ *
+ * degree is the number of blocks issued per trigger and distance how far ahead of the access the prefetches go.
+ */
+typedef struct _prefetcher_t {
+    int              kind;
+    uint32_t         degree;
+    uint32_t         distance;
+    uint32_t         regionShift;   // Bits of a block number that are not part of its region
+    uint64_t         maxBlock;      // Largest block number of the address space
+    uint64_t         accesses;      // Trainings, the clock of the streams
+    strideEntry_t *  strides;
+    streamEntry_t *  streams;
+    uint64_t *       issued;        // Accesses to the level when each of its lines was prefetched
+} prefetcher_t;
+
+prefetcher_t * initializePrefetcher( int kind, uint32_t degree, uint32_t distance, uint32_t offsetBits, uint32_t addressBits, size_t lines );
+size_t trainPrefetcher( prefetcher_t * prefetcher, uint64_t block, bool miss, bool prefetchHit, uint64_t * candidates );
+const char * prefetcherName( int kind );
+void destroyPrefetcher( prefetcher_t * prefetcher );
+
+#endif
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include "SeedRuns.h"
+#include "Simulator.h"
+#include "CacheConfig.h"
+#include "Parallel.h"
+
+/*
+ * Shared state of a multi-seed simulation.
+ */
+typedef struct _seedRun_t {
+    uint32_t *           addresses;
+    size_t               addressesSize;
+    cacheConfigList_t *  cacheConfigList;
+    unsigned long        levels;
+    result_t *           results;  // Statistics of each run, run major
+} seedRun_t;
+
+/*
+ * Two-sided 95% critical values of the Student's t distribution for 1 to 30 degrees of freedom, the normal
+ * distribution value is used for more.
+ */
+static const double studentT95[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+/*
+ * Simulates the hierarchy with the seed of one run, the seed of the hierarchy plus the index of the run.
+ *
+ * Each run has its own copy of the configuration list, so the runs don't share any state.
+ */
+static void simulateSeed( void * context, unsigned int index ) {
+    seedRun_t *          run = context;
+    cacheConfigList_t *  cacheConfigList = NULL;
+    result_t *           results;
+
+    for ( cacheConfigList_t * current = run->cacheConfigList; current != NULL; current = current->next ) {
+        cacheConfig_t cacheConfig = current->cacheConfig;
+
+        cacheConfig.seed += index;
+
+        pushCacheConfig( &cacheConfigList, &cacheConfig );
+    }
+
+    results = simulate( run->addresses, run->addressesSize, cacheConfigList );
+
+    for ( unsigned long level = 0; level < run->levels; level++ ) {
+        run->results[ ( size_t )index * run->levels + level ] = results[ level ];
+    }
+
+    free( results );
+    destroyCacheConfigList( cacheConfigList );
+}
+
+/*
+ * Computes the mean, standard deviation and confidence interval of count values.
+ */
+static seedStatistic_t computeStatistic( const double * values, unsigned int count ) {
+    seedStatistic_t  statistic = { .mean = 0, .stddev = 0, .confidence = 0 };
+    double           squares = 0;
+
+    for ( unsigned int i = 0; i < count; i++ ) {
+        statistic.mean += values[ i ];
+    }
+
+    statistic.mean /= count;
+
+    for ( unsigned int i = 0; i < count; i++ ) {
+        squares += ( values[ i ] - statistic.mean ) * ( values[ i ] - statistic.mean );
+    }
+
+    statistic.stddev = sqrt( squares / ( count - 1 ) );
+    statistic.confidence = ( count - 1 <= sizeof( studentT95 ) / sizeof( studentT95[ 0 ] ) ? studentT95[ count - 2 ] : 1.960 )
+                           * statistic.stddev / sqrt( count );
+
+    return statistic;
+}
+
+/*
+ * Simulates a cache hierarchy with seedCount different seeds in parallel and summarizes the statistics of each level.
+ *
+ * The runs use consecutive seeds starting from the seed of the hierarchy, so a multi-seed simulation is reproducible
+ * and its first run is the same as a simulation with the same seed. Only RANDOM replacement depends on the seed, the
+ * runs of other policies are all the same. seedCount must be at least 2.
+ *
+ * The summaries array is dynamically allocated, caller is responsible for freeing it.
+ */
+seedSummary_t * simulateSeeds( uint32_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList, unsigned int seedCount ) {
+    seedRun_t        run = { .addresses = addresses, .addressesSize = addressesSize, .cacheConfigList = cacheConfigList };
+    seedSummary_t *  summaries;
+    double *         values[ 7 ];
+
+    run.levels = countCacheLevels( cacheConfigList );
+    run.results = malloc( sizeof( result_t ) * seedCount * run.levels );
+    summaries = malloc( sizeof( seedSummary_t ) * run.levels );
+
+    for ( size_t i = 0; i < sizeof( values ) / sizeof( values[ 0 ] ); i++ ) {
+        values[ i ] = malloc( sizeof( double ) * seedCount );
+
+        if ( values[ i ] == NULL ) {
+            fputs( "Sem memória.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    if ( run.results == NULL || summaries == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    parallelFor( seedCount, simulateSeed, &run );
+
+    for ( unsigned long level = 0; level < run.levels; level++ ) {
+        for ( unsigned int i = 0; i < seedCount; i++ ) {
+            result_t *  result = &run.results[ ( size_t )i * run.levels + level ];
+            uint64_t    misses = result->compulsoryMisses + result->capacityMisses + result->conflictMisses;
+
+            values[ 0 ][ i ] = ( double )misses;
+            values[ 1 ][ i ] = ( double )result->compulsoryMisses;
+            values[ 2 ][ i ] = ( double )result->capacityMisses;
+            values[ 3 ][ i ] = ( double )result->conflictMisses;
+            values[ 4 ][ i ] = result->accesses > 0 ? ( double )result->hits / result->accesses : 0.0;
+            values[ 5 ][ i ] = result->accesses > 0 ? ( double )misses / result->accesses : 0.0;
+            values[ 6 ][ i ] = ( double )result->accesses;
+        }
+
+        summaries[ level ].accesses = computeStatistic( values[ 6 ], seedCount );
+        summaries[ level ].misses = computeStatistic( values[ 0 ], seedCount );
+        summaries[ level ].compulsoryMisses = computeStatistic( values[ 1 ], seedCount );
+        summaries[ level ].capacityMisses = computeStatistic( values[ 2 ], seedCount );
+        summaries[ level ].conflictMisses = computeStatistic( values[ 3 ], seedCount );
+        summaries[ level ].hitRate = computeStatistic( values[ 4 ], seedCount );
+        summaries[ level ].missRate = computeStatistic( values[ 5 ], seedCount );
+    }
+
+    for ( size_t i = 0; i < sizeof( values ) / sizeof( values[ 0 ] ); i++ ) {
+        free( values[ i ] );
+    }
+
+    free( run.results );
+
+    return summaries;
+}
@@ -0,0 +1,34 @@
+#ifndef SEED_RUNS_H
+#define SEED_RUNS_H
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#include "CacheConfig.h"
+#include "Simulator.h"
+
+/*
+ * Statistic of a value over the runs of a multi-seed simulation.
+ */
+typedef struct _seedStatistic_t {
+    double  mean;
+    double  stddev;      // Sample standard deviation
+    double  confidence;  // Half width of the 95% confidence interval of the mean
+} seedStatistic_t;
+
+/*
+ * Statistics of a cache level over the runs of a multi-seed simulation.
+ */
+typedef struct _seedSummary_t {
+    seedStatistic_t  accesses;  // Only the same in every run for the first level
+    seedStatistic_t  misses;
+    seedStatistic_t  compulsoryMisses;
+    seedStatistic_t  capacityMisses;
+    seedStatistic_t  conflictMisses;
+    seedStatistic_t  hitRate;
+    seedStatistic_t  missRate;
+} seedSummary_t;
+
+seedSummary_t * simulateSeeds( uint32_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList, unsigned int seedCount );
+
+#endif
@@ -0,0 +1,315 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "SetPartition.h"
+#include "Simulator.h"
+#include "CacheConfig.h"
+#include "Parallel.h"
+
+// Trace index of a range whose lines never all become valid
+#define NEVER_FULL SIZE_MAX
+
+/*
+ * Shared state of a set partitioned simulation.
+ *
+ * The trace is split in chunks, one per thread, and the sets of the cache in ranges. The addresses of each range are
+ * scattered to a contiguous region of the partition, ordered by chunk and then by their order in the chunk, so each
+ * region holds the accesses to its sets in trace order.
+ */
+typedef struct _setPartition_t {
+    uint32_t *  addresses;
+    size_t      addressesSize;
+    cache_t *   cache;
+    uint32_t    offsetBits;
+    uint32_t    indexMask;
+    uint32_t    rangeShift;    // Shift from a set index to its range
+    unsigned    rangeCount;
+    unsigned    chunkCount;
+    size_t      chunkSize;
+    size_t *    counts;        // Addresses of each range in each chunk, chunk major
+    size_t *    offsets;       // Position of the addresses of each range from each chunk in the partition, chunk major
+    size_t *    regionStarts;  // First position of each range in the partition, plus the end of the partition
+    uint32_t *  partition;
+    size_t *    fullIndices;   // Trace index that fills the last empty line of each range
+    size_t *    boundaries;    // Accesses of each range up to the trace index that fills the cache
+    result_t *  results;       // Statistics of each range
+} setPartition_t;
+
+static inline unsigned int rangeOf( setPartition_t * run, uint32_t address ) {
+    return ( ( address >> run->offsetBits ) & run->indexMask ) >> run->rangeShift;
+}
+
+/*
+ * Counts the addresses of each range in a chunk of the trace.
+ */
+static void countChunk( void * context, unsigned int chunk ) {
+    setPartition_t *  run = context;
+    size_t            first = ( size_t )chunk * run->chunkSize;
+    size_t            last = first + run->chunkSize < run->addressesSize ? first + run->chunkSize : run->addressesSize;
+    size_t *          counts = &run->counts[ ( size_t )chunk * run->rangeCount ];
+
+    for ( size_t i = first; i < last; i++ ) {
+        counts[ rangeOf( run, run->addresses[ i ] ) ]++;
+    }
+}
+
+/*
+ * Scatters the addresses of a chunk of the trace to the regions of their ranges.
+ */
+static void scatterChunk( void * context, unsigned int chunk ) {
+    setPartition_t *  run = context;
+    size_t            first = ( size_t )chunk * run->chunkSize;
+    size_t            last = first + run->chunkSize < run->addressesSize ? first + run->chunkSize : run->addressesSize;
+    size_t *          offsets = &run->offsets[ ( size_t )chunk * run->rangeCount ];
+
+    for ( size_t i = first; i < last; i++ ) {
+        run->partition[ offsets[ rangeOf( run, run->addresses[ i ] ) ]++ ] = run->addresses[ i ];
+    }
+}
+
+/*
+ * Converts the position of an address in the region of a range to its index in the trace.
+ */
+static size_t traceIndexOf( setPartition_t * run, unsigned int range, size_t position ) {
+    unsigned int chunk = 0;
+
+    // Find the chunk of the address, then the address in the chunk
+    while ( position >= run->counts[ ( size_t )chunk * run->rangeCount + range ] ) {
+        position -= run->counts[ ( size_t )chunk * run->rangeCount + range ];
+        chunk++;
+    }
+
+    for ( size_t i = ( size_t )chunk * run->chunkSize; ; i++ ) {
+        if ( rangeOf( run, run->addresses[ i ] ) == range ) {
+            if ( position == 0 ) {
+                return i;
+            }
+
+            position--;
+        }
+    }
+}
+
+/*
+ * Finds the trace index at which the last empty line of a range is filled.
+ *
+ * Until a set is full no line of it is replaced, so the set holds exactly the distinct blocks accessed in it and the
+ * fills can be found without simulating the replacement policy. The scan stops as soon as the range is full, which is
+ * usually early in the trace. The tags of the range are used as scratch space and are invalidated again at the end.
+ */
+static void findRangeFullIndex( void * context, unsigned int range ) {
+    setPartition_t *  run = context;
+    uint32_t          assoc = run->cache->cacheConfig.assoc;
+    uint32_t          firstSet = range << run->rangeShift;
+    uint32_t          setCount = UINT32_C( 1 ) << run->rangeShift;
+    uint32_t *        tags = run->cache->tags;
+    uint32_t *        filled = calloc( setCount, sizeof( uint32_t ) );
+    size_t            emptyLines = ( size_t )setCount * assoc;
+    uint32_t          tagShift = run->cache->tagShift;
+
+    if ( filled == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    run->fullIndices[ range ] = NEVER_FULL;
+
+    for ( size_t position = run->regionStarts[ range ]; position < run->regionStarts[ range + 1 ]; position++ ) {
+        uint32_t    address = run->partition[ position ];
+        uint32_t    set = ( address >> run->offsetBits ) & run->indexMask;
+        uint32_t    tag = ( uint32_t )( ( uint64_t )address >> tagShift );
+        uint32_t *  setTags = &tags[ ( size_t )set * assoc ];
+        uint32_t *  setFilled = &filled[ set - firstSet ];
+        uint32_t    way = 0;
+
+        if ( *setFilled == assoc ) {
+            continue;
+        }
+
+        while ( way < *setFilled && setTags[ way ] != tag ) {
+            way++;
+        }
+
+        if ( way == *setFilled ) {
+            setTags[ ( *setFilled )++ ] = tag;
+
+            if ( --emptyLines == 0 ) {
+                run->fullIndices[ range ] = traceIndexOf( run, range, position - run->regionStarts[ range ] );
+                break;
+            }
+        }
+    }
+
+    for ( size_t i = ( size_t )firstSet * assoc; i < ( size_t )( firstSet + setCount ) * assoc; i++ ) {
+        tags[ i ] = INVALID_TAG;
+    }
+
+    free( filled );
+}
+
+/*
+ * Simulates the sets of a range.
+ *
+ * Each range is simulated by a copy of the cache structure that shares the lines of the cache, since ranges never
+ * touch the lines of other ranges. Misses that replace a line are capacity misses once every line of the whole cache
+ * is valid, so the accesses before the boundary are simulated as if the cache had empty lines and the accesses after
+ * it as if it were full.
+ */
+static void simulateRange( void * context, unsigned int range ) {
+    setPartition_t *  run = context;
+    cache_t           view = *run->cache;
+    uint32_t *        region = &run->partition[ run->regionStarts[ range ] ];
+    size_t            regionSize = run->regionStarts[ range + 1 ] - run->regionStarts[ range ];
+    size_t            boundary = run->boundaries[ range ];
+
+    view.validLines = 0;
+    view.lruCounter = 0;
+    view.fifoCounter = 0;
+    view.nextLevel = NULL;
+    view.result = ( result_t ){ .hits = 0, .capacityMisses = 0, .conflictMisses = 0, .compulsoryMisses = 0, .accesses = 0 };
+
+    accessCacheChunk( &view, region, boundary );
+
+    // Every line of the cache is valid from here on, in this range and in all the others
+    view.validLines = view.cacheConfig.nsets * view.cacheConfig.assoc;
+
+    accessCacheChunk( &view, region + boundary, regionSize - boundary );
+
+    run->results[ range ] = view.result;
+}
+
+static bool isSetLocalPolicy( int replacementPolicy ) {
+    return replacementPolicy == LRU || replacementPolicy == FIFO || replacementPolicy == PLRU || replacementPolicy == NRU
+        || replacementPolicy == SRRIP;
+}
+
+/*
+ * Checks if a cache configuration can be simulated in parallel by set with the same results as simulate.
+ *
+ * Only single level caches with more than one set and a policy whose state is local to each set can, the sets of a
+ * level of a hierarchy aren't independent from the other levels. RANDOM replacement draws from a single generator in
+ * trace order, BRRIP and DIP count insertions across sets and DIP also shares its policy selector. Exact miss
+ * classification needs the whole trace in order. Direct mapped caches have their own kernel.
+ */
+bool isSetPartitionable( cacheConfigList_t * cacheConfigList, size_t addressesSize ) {
+    cacheConfig_t * cacheConfig = &cacheConfigList->cacheConfig;
+
+    return cacheConfigList->next == NULL && cacheConfig->nsets > 1 && isSetLocalPolicy( cacheConfig->replacementPolicy )
+        && !cacheConfig->exactMissClassification && cacheConfig->prefetcher == PREFETCH_NONE
+        && cacheConfig->victimCache == VICTIM_CACHE_NONE && !cacheConfig->reportInclusion && !cacheConfig->partitioned
+        && cacheConfig->hotspots == NULL && !isDirectMapping( cacheConfigList )
+        && addressesSize >= SET_PARTITION_MIN_SIZE && getThreadCount() > 1;
+}
+
+/*
+ * Simulates a single level cache accessing an array of addresses with the sets split among threads.
+ *
+ * The trace is partitioned by set range with a parallel two pass scatter, then each range is simulated by a thread.
+ * The only state shared by all sets is the number of valid lines, which decides between capacity and conflict misses,
+ * so the trace index at which the cache becomes full is found first and every range classifies its misses by it. The
+ * results are the same as simulate's.
+ *
+ * The results array is dynamically allocated, caller is responsible for freeing it.
+ */
+result_t * simulateSetPartitioned( uint32_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList ) {
+    setPartition_t  run;
+    unsigned int    threads = getThreadCount();
+    uint32_t        nsets = cacheConfigList->cacheConfig.nsets;
+    unsigned int    rangeCount = 1;
+    size_t          fullIndex = 0;
+    result_t *      results = malloc( sizeof( result_t ) );
+
+    while ( rangeCount * 2 <= nsets && rangeCount * 2 <= threads * SET_PARTITION_RANGES_PER_THREAD ) {
+        rangeCount *= 2;
+    }
+
+    run.addresses = addresses;
+    run.addressesSize = addressesSize;
+    run.cache = initializeCache( cacheConfigList );
+    run.offsetBits = run.cache->offsetBits;
+    run.indexMask = run.cache->indexMask;
+    run.rangeShift = log2PowerOf2( nsets ) - log2PowerOf2( rangeCount );
+    run.rangeCount = rangeCount;
+    run.chunkCount = threads;
+    run.chunkSize = ( addressesSize + threads - 1 ) / threads;
+    run.counts = calloc( ( size_t )threads * rangeCount, sizeof( size_t ) );
+    run.offsets = malloc( sizeof( size_t ) * threads * rangeCount );
+    run.regionStarts = malloc( sizeof( size_t ) * ( rangeCount + 1 ) );
+    run.partition = malloc( sizeof( uint32_t ) * addressesSize );
+    run.fullIndices = malloc( sizeof( size_t ) * rangeCount );
+    run.boundaries = malloc( sizeof( size_t ) * rangeCount );
+    run.results = malloc( sizeof( result_t ) * rangeCount );
+
+    if ( results == NULL || run.counts == NULL || run.offsets == NULL || run.regionStarts == NULL || run.partition == NULL
+         || run.fullIndices == NULL || run.boundaries == NULL || run.results == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    parallelFor( run.chunkCount, countChunk, &run );
+
+    // Each range takes a region of the partition, and each chunk a slice of the region
+    size_t position = 0;
+
+    for ( unsigned int range = 0; range < rangeCount; range++ ) {
+        run.regionStarts[ range ] = position;
+
+        for ( unsigned int chunk = 0; chunk < run.chunkCount; chunk++ ) {
+            run.offsets[ ( size_t )chunk * rangeCount + range ] = position;
+            position += run.counts[ ( size_t )chunk * rangeCount + range ];
+        }
+    }
+
+    run.regionStarts[ rangeCount ] = position;
+
+    parallelFor( run.chunkCount, scatterChunk, &run );
+    parallelFor( rangeCount, findRangeFullIndex, &run );
+
+    // The cache is full once all of its ranges are
+    for ( unsigned int range = 0; range < rangeCount; range++ ) {
+        if ( run.fullIndices[ range ] > fullIndex ) {
+            fullIndex = run.fullIndices[ range ];
+        }
+    }
+
+    // Count the accesses of each range up to the index that fills the cache, which are the accesses of the chunks before
+    // it plus the accesses of its own chunk up to it
+    for ( unsigned int range = 0; range < rangeCount; range++ ) {
+        run.boundaries[ range ] = fullIndex == NEVER_FULL ? run.regionStarts[ range + 1 ] - run.regionStarts[ range ] : 0;
+    }
+
+    if ( fullIndex != NEVER_FULL ) {
+        unsigned int fullChunk = ( unsigned int )( fullIndex / run.chunkSize );
+
+        for ( unsigned int range = 0; range < rangeCount; range++ ) {
+            for ( unsigned int chunk = 0; chunk < fullChunk; chunk++ ) {
+                run.boundaries[ range ] += run.counts[ ( size_t )chunk * rangeCount + range ];
+            }
+        }
+
+        for ( size_t i = ( size_t )fullChunk * run.chunkSize; i <= fullIndex; i++ ) {
+            run.boundaries[ rangeOf( &run, addresses[ i ] ) ]++;
+        }
+    }
+
+    parallelFor( rangeCount, simulateRange, &run );
+
+    results[ 0 ] = ( result_t ){ .hits = 0, .capacityMisses = 0, .conflictMisses = 0, .compulsoryMisses = 0, .accesses = 0 };
+
+    for ( unsigned int range = 0; range < rangeCount; range++ ) {
+        accumulateResult( &results[ 0 ], &run.results[ range ] );
+    }
+
+    destroyCache( run.cache );
+    free( run.counts );
+    free( run.offsets );
+    free( run.regionStarts );
+    free( run.partition );
+    free( run.fullIndices );
+    free( run.boundaries );
+    free( run.results );
+
+    return results;
+}
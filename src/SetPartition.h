@@ -0,0 +1,20 @@
+#ifndef SET_PARTITION_H
+#define SET_PARTITION_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "CacheConfig.h"
+#include "Simulator.h"
+
+// Minimum number of addresses for a trace to be simulated in parallel by set, smaller traces aren't worth the copy
+#define SET_PARTITION_MIN_SIZE ( 1 << 20 )
+
+// Number of set ranges per thread, more ranges than threads balance sets with uneven numbers of accesses
+#define SET_PARTITION_RANGES_PER_THREAD 4
+
+bool isSetPartitionable( cacheConfigList_t * cacheConfigList, size_t addressesSize );
+result_t * simulateSetPartitioned( uint32_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList );
+
+#endif
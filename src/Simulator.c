@@ -5,9 +5,19 @@
 #include <stdio.h>
 #include <limits.h>
 
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#include <immintrin.h>
+#define HAS_X86_SIMD 1
+#else
+#define HAS_X86_SIMD 0
+#endif
+
 #include "CacheSimulator.h"
 #include "Simulator.h"
 #include "CacheConfig.h"
+#include "BlockMap.h"
+#include "Parallel.h"
+#include "SetPartition.h"
 
 /*
  * Calculate the base 2 logarithm of a number that is a power of 2.
@@ -60,46 +70,62 @@ unsigned int log2PowerOf2( unsigned int n ) {
 }
 
 /*
- * This function simulates a directly mapped cache.
+ * This function initializes the state of a directly mapped cache.
+ *
+ * The state is kept between calls to accessDirectMappedCache, so a trace can be simulated in chunks.
+ */
+directMappedCache_t * initializeDirectMappedCache( uint32_t bsize, uint32_t nsets ) {
+    directMappedCache_t * cache = malloc( sizeof( directMappedCache_t ) );
+
+    if ( cache == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    cache->nsets = nsets;
+    cache->offsetBits = log2PowerOf2( bsize );
+    cache->indexBits = log2PowerOf2( nsets );
+    cache->result = ( result_t ){ .hits = 0, .capacityMisses = 0, .conflictMisses = 0, .compulsoryMisses = 0, .accesses = 0 };
+
+    // The arrays are zero initialized, so all lines start invalid
+    cache->valid = calloc( nsets, sizeof( bool ) );
+    cache->tags = calloc( nsets, sizeof( uint32_t ) );
+    cache->tagsHigh = NULL;
+
+    if ( cache->valid == NULL || cache->tags == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    return cache;
+}
+
+/*
+ * This function simulates a directly mapped cache accessing an array of addresses.
  *
  * Unlike the the other simulations, while using this function the replacement policy is not applicable and is not taken.
- * 
- * Any valid number of sets and block size can be used.
+ * All misses that are not compulsory are counted as conflict misses.
  */
-result_t simulateDirectMapping( uint32_t * addresses, size_t addressesSize, uint32_t bsize, uint32_t nsets ) {
+void accessDirectMappedCache( directMappedCache_t * cache, uint32_t * addresses, size_t addressesSize ) {
     uint32_t  tag;
     uint32_t  indice;
-    int       missCompulsorio = 0;
-    int       missConflito = 0;
-    int       hit = 0;
-    int       miss = 0;
-    int       nBitsOffset = log2PowerOf2( bsize );
-    int       nBitsIndice = log2PowerOf2( nsets );
-
-    // Intellisense (MSVC) doesn't support variable length arrays, so a placeholder is used in the editor.
-    #ifndef __INTELLISENSE__
-    bool cacheVal[ nsets ];
-    uint32_t cacheTag[ nsets ];
-    #else
-    bool cacheVal[ 1 ];
-    uint32_t cacheTag[ 1 ];
-    #endif
-
-    /* Initialize the arrays with zero. It appears all test compilations initialized them with 0 already, but this is
-    not guaranteed behaviour, so they are explicitly initialized. */
-    memset( cacheVal, 0, sizeof( cacheVal ) );
-    memset( cacheTag, 0, sizeof( cacheTag ) );
+    uint64_t  missCompulsorio = 0;
+    uint64_t  missConflito = 0;
+    uint64_t  hit = 0;
+    uint32_t  nBitsOffset = cache->offsetBits;
+    uint32_t  nBitsIndice = cache->indexBits;
+    bool *    cacheVal = cache->valid;
+    uint32_t * cacheTag = cache->tags;
     
     for ( size_t i = 0; i < addressesSize; i++ ) {
 
-        tag = addresses[ i ] >> ( nBitsIndice + nBitsOffset );
+        tag = ( uint32_t )( ( uint64_t )addresses[ i ] >> ( nBitsIndice + nBitsOffset ) );
         indice = ( addresses[ i ] >> nBitsOffset ) & ( ( 1 << nBitsIndice ) - 1 );
 
         // para o mapeamento direto
         if ( cacheVal[ indice ] == 0 ) {
 
             missCompulsorio++;
-            miss++;
             cacheTag[ indice ] = tag;
             cacheVal[ indice ] = 1;
             // estas duas últimas instruções representam o tratamento da falta.
@@ -110,7 +136,6 @@ result_t simulateDirectMapping( uint32_t * addresses, size_t addressesSize, uint
 
         } else {
             
-            miss++;
             missConflito++;
             cacheVal[ indice ] = 1;
             cacheTag[ indice ] = tag;
@@ -119,13 +144,255 @@ result_t simulateDirectMapping( uint32_t * addresses, size_t addressesSize, uint
     
     }
 
-    result_t result = { .hits = hit, .compulsoryMisses = missCompulsorio, .capacityMisses = 0, .conflictMisses = missConflito, .accesses = addressesSize };
+    cache->result.hits += hit;
+    cache->result.compulsoryMisses += missCompulsorio;
+    cache->result.conflictMisses += missConflito;
+    cache->result.accesses += addressesSize;
+}
+
+/*
+ * This function destroys the state of a directly mapped cache.
+ */
+void destroyDirectMappedCache( directMappedCache_t * cache ) {
+    free( cache->valid );
+    free( cache->tags );
+    free( cache->tagsHigh );
+    free( cache );
+}
+
+/*
+ * Checks if a cache configuration is simulated as a directly mapped cache.
+ *
+ * Only single level caches with an associativity of 1 are simulated by simulateDirectMapping, unless their misses are
+ * classified exactly, they have a prefetcher or a victim cache, they report their inclusion, they are partitioned or they
+ * are profiled.
+ */
+bool isDirectMapping( cacheConfigList_t * cacheConfigList ) {
+    return cacheConfigList->cacheConfig.assoc == 1 && cacheConfigList->next == NULL && !cacheConfigList->cacheConfig.exactMissClassification
+        && cacheConfigList->cacheConfig.prefetcher == PREFETCH_NONE && cacheConfigList->cacheConfig.victimCache == VICTIM_CACHE_NONE
+        && !cacheConfigList->cacheConfig.reportInclusion && !cacheConfigList->cacheConfig.partitioned
+        && cacheConfigList->cacheConfig.hotspots == NULL;
+}
+
+/*
+ * This function simulates a directly mapped cache.
+ *
+ * Unlike the the other simulations, while using this function the replacement policy is not applicable and is not taken.
+ * 
+ * Any valid number of sets and block size can be used.
+ */
+result_t simulateDirectMapping( uint32_t * addresses, size_t addressesSize, uint32_t bsize, uint32_t nsets ) {
+    directMappedCache_t *  cache = initializeDirectMappedCache( bsize, nsets );
+    result_t               result;
+
+    accessDirectMappedCache( cache, addresses, addressesSize );
+
+    result = cache->result;
+
+    destroyDirectMappedCache( cache );
     
     return result;
 }
 
+/*
+ * This function simulates a directly mapped cache accessing an array of 64-bit addresses, with the same miss
+ * classification as simulateDirectMapping, so the results are the same for addresses that fit in 32 bits.
+ */
+result_t simulateDirectMapping64( uint64_t * addresses, size_t addressesSize, uint32_t bsize, uint32_t nsets ) {
+    directMappedCache_t *  cache = initializeDirectMappedCache( bsize, nsets );
+    uint32_t               tagShift = cache->indexBits + cache->offsetBits;
+    uint64_t               indexMask = ( UINT64_C( 1 ) << cache->indexBits ) - 1;
+    result_t               result;
+
+    cache->tagsHigh = calloc( nsets, sizeof( uint32_t ) );
+
+    if ( cache->tagsHigh == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( size_t i = 0; i < addressesSize; i++ ) {
+        uint64_t  tag = addresses[ i ] >> tagShift;
+        uint32_t  index = ( uint32_t )( ( addresses[ i ] >> cache->offsetBits ) & indexMask );
+
+        if ( !cache->valid[ index ] ) {
+            cache->result.compulsoryMisses++;
+            cache->valid[ index ] = true;
+        } else if ( cache->tags[ index ] == ( uint32_t )tag && cache->tagsHigh[ index ] == ( uint32_t )( tag >> 32 ) ) {
+            cache->result.hits++;
+            continue;
+        } else {
+            cache->result.conflictMisses++;
+        }
+
+        cache->tags[ index ] = ( uint32_t )tag;
+        cache->tagsHigh[ index ] = ( uint32_t )( tag >> 32 );
+    }
+
+    cache->result.accesses += addressesSize;
+
+    result = cache->result;
+
+    destroyDirectMappedCache( cache );
+
+    return result;
+}
+
+/*
+ * Finds the first way of a set with a tag one way at a time.
+ */
+static uint32_t findWayScalar( const uint32_t * tags, uint32_t count, uint32_t tag ) {
+    for ( uint32_t i = 0; i < count; i++ ) {
+        if ( tags[ i ] == tag ) {
+            return i;
+        }
+    }
+
+    return count;
+}
+
+#if HAS_X86_SIMD
+/*
+ * Finds the first way of a set with a tag comparing 16 ways at a time with SSE2.
+ *
+ * The masks of the 4 compares of a group are merged before branching, so sets of up to 16 ways take a single branch.
+ */
+__attribute__(( target( "sse2" ) ))
+static uint32_t findWaySSE2( const uint32_t * tags, uint32_t count, uint32_t tag ) {
+    const __m128i  needle = _mm_set1_epi32( ( int )tag );
+    uint32_t       i = 0;
+
+    for ( ; i + 16 <= count; i += 16 ) {
+        uint32_t mask = ( uint32_t )_mm_movemask_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_loadu_si128( ( const __m128i * )( tags + i ) ), needle ) ) )
+                      | ( uint32_t )_mm_movemask_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_loadu_si128( ( const __m128i * )( tags + i + 4 ) ), needle ) ) ) << 4
+                      | ( uint32_t )_mm_movemask_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_loadu_si128( ( const __m128i * )( tags + i + 8 ) ), needle ) ) ) << 8
+                      | ( uint32_t )_mm_movemask_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_loadu_si128( ( const __m128i * )( tags + i + 12 ) ), needle ) ) ) << 12;
+
+        if ( mask != 0 ) {
+            return i + ( uint32_t )__builtin_ctz( mask );
+        }
+    }
+
+    for ( ; i + 4 <= count; i += 4 ) {
+        uint32_t mask = ( uint32_t )_mm_movemask_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_loadu_si128( ( const __m128i * )( tags + i ) ), needle ) ) );
+
+        if ( mask != 0 ) {
+            return i + ( uint32_t )__builtin_ctz( mask );
+        }
+    }
+
+    return i + findWayScalar( tags + i, count - i, tag );
+}
+
+/*
+ * Finds the first way of a set with a tag comparing 32 ways at a time with AVX2.
+ */
+__attribute__(( target( "avx2" ) ))
+static uint32_t findWayAVX2( const uint32_t * tags, uint32_t count, uint32_t tag ) {
+    const __m256i  needle = _mm256_set1_epi32( ( int )tag );
+    uint32_t       i = 0;
+
+    for ( ; i + 32 <= count; i += 32 ) {
+        uint32_t mask = ( uint32_t )_mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( _mm256_loadu_si256( ( const __m256i * )( tags + i ) ), needle ) ) )
+                      | ( uint32_t )_mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( _mm256_loadu_si256( ( const __m256i * )( tags + i + 8 ) ), needle ) ) ) << 8
+                      | ( uint32_t )_mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( _mm256_loadu_si256( ( const __m256i * )( tags + i + 16 ) ), needle ) ) ) << 16
+                      | ( uint32_t )_mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( _mm256_loadu_si256( ( const __m256i * )( tags + i + 24 ) ), needle ) ) ) << 24;
+
+        if ( mask != 0 ) {
+            return i + ( uint32_t )__builtin_ctz( mask );
+        }
+    }
+
+    for ( ; i + 8 <= count; i += 8 ) {
+        uint32_t mask = ( uint32_t )_mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( _mm256_loadu_si256( ( const __m256i * )( tags + i ) ), needle ) ) );
+
+        if ( mask != 0 ) {
+            return i + ( uint32_t )__builtin_ctz( mask );
+        }
+    }
+
+    return i + findWaySSE2( tags + i, count - i, tag );
+}
+#endif
+
+/*
+ * Picks the widest tag search supported by the CPU running the program for a number of ways.
+ *
+ * Sets with fewer than 4 ways are searched one way at a time, since they don't fill a vector.
+ */
+static findWay_t selectFindWay( uint32_t assoc ) {
+    #if HAS_X86_SIMD
+    if ( assoc >= 8 && __builtin_cpu_supports( "avx2" ) ) {
+        return findWayAVX2;
+    }
+
+    if ( assoc >= 4 && __builtin_cpu_supports( "sse2" ) ) {
+        return findWaySSE2;
+    }
+    #endif
+
+    return findWayScalar;
+}
+
+static void selectAccessKernels( cache_t * cache );
+
+/*
+ * Advances the generator of a cache and gets its next 32-bit output.
+ *
+ * The generator is a PCG32 (XSH RR variant), owned by each cache so parallel simulations neither share nor lock it.
+ */
+static inline uint32_t nextRandom( cache_t * cache ) {
+    uint64_t  state = cache->randomState;
+    uint32_t  xorShifted = ( uint32_t )( ( ( state >> 18 ) ^ state ) >> 27 );
+    uint32_t  rotation = ( uint32_t )( state >> 59 );
+
+    cache->randomState = state * UINT64_C( 6364136223846793005 ) + cache->randomIncrement;
+
+    return ( xorShifted >> rotation ) | ( xorShifted << ( ( -rotation ) & 31 ) );
+}
+
+/*
+ * Gets a uniformly distributed random number from 0 to bound - 1.
+ *
+ * Uses the multiply and shift reduction with rejection of the few outputs that would bias it, unlike a modulo. The
+ * threshold is 0 for powers of 2, so there is never a second draw for the usual associativities.
+ */
+static inline uint32_t randomBelow( cache_t * cache, uint32_t bound ) {
+    uint64_t  product = ( uint64_t )nextRandom( cache ) * bound;
+    uint32_t  threshold = -bound % bound;
+
+    while ( ( uint32_t )product < threshold ) {
+        product = ( uint64_t )nextRandom( cache ) * bound;
+    }
+
+    return ( uint32_t )( product >> 32 );
+}
+
+/*
+ * Seeds the generator of a cache, the level selects the stream so each level of a hierarchy draws a different sequence
+ * from the same seed.
+ */
+static void seedRandom( cache_t * cache, uint64_t seed, unsigned long level ) {
+    cache->randomState = 0;
+    cache->randomIncrement = ( ( uint64_t )level << 1 ) | 1;
+
+    nextRandom( cache );
+
+    cache->randomState += seed;
+
+    nextRandom( cache );
+}
+
 /*
  * This function initializes a cache structure.
+ *
+ * All the lines of a level are allocated in a single arena, with the timestamps of the replacement policy, if it
+ * uses any, followed by the tags, the high halves of the tags, if they are wide, the bits of the replacement policy, if
+ * it uses any, and the flags of the lines.
+ *
+ * Tags are wide only if the significant bits of the addresses, addressBits of the configuration, leave 32 bits or more
+ * after the offset and index bits. A wide tag can only be all ones, like the invalid tag, with a single set. Set
+ * partitioned levels keep the index bits in the tag too, see tenantPartition_t.
  */
 cache_t * initializeCache( cacheConfigList_t * cacheConfigList ) {
     cache_t * cache = malloc( sizeof( cache_t ) );
@@ -139,37 +406,108 @@ cache_t * initializeCache( cacheConfigList_t * cacheConfigList ) {
     
     cache->validLines = 0;
 
-    cache->lruCounter = 0;
+    cache->lruCounter = cacheConfigList->cacheConfig.replacementPolicy == DIP ? DIP_COUNTER_START : 0;
     cache->fifoCounter = 0;
+    cache->lipCounter = DIP_COUNTER_START;
+    cache->bimodalCounter = 0;
+    cache->policySelector = DIP_PSEL_MAX / 2;
+
+    seedRandom( cache, cacheConfigList->cacheConfig.seed, cacheConfigList->cacheConfig.level );
 
     cache->result = ( result_t ){ .hits = 0, .capacityMisses = 0, .conflictMisses = 0, .compulsoryMisses = 0, .accesses = 0 };
 
-    cache->sets = malloc( sizeof( cacheSet_t ) * cacheConfigList->cacheConfig.nsets );
+    size_t    lines = ( size_t )cacheConfigList->cacheConfig.nsets * cacheConfigList->cacheConfig.assoc;
+    int       policy = cacheConfigList->cacheConfig.replacementPolicy;
+    bool      timestamped = policy == LRU || policy == FIFO || policy == DIP;
+    bool      bitBased = policy == PLRU || policy == NRU || policy == SRRIP || policy == BRRIP;
+    uint32_t  addressBits = cacheConfigList->cacheConfig.addressBits;
+
+    cache->partition = NULL;
+
+    if ( cacheConfigList->cacheConfig.partitioned ) {
+        cache->partition = initializeTenantPartition( &cacheConfigList->cacheConfig, lines );
+    }
+
+    bool setPartitioned = cache->partition != NULL && cache->partition->setPartitioned;
+
+    cache->offsetBits = log2PowerOf2( cacheConfigList->cacheConfig.bsize );
+    cache->tagShift = cache->offsetBits + ( setPartitioned ? 0 : log2PowerOf2( cacheConfigList->cacheConfig.nsets ) );
+    cache->indexMask = cacheConfigList->cacheConfig.nsets - 1;
+
+    bool wide = ( addressBits > 32 || setPartitioned ) && ( addressBits > 32 ? addressBits : 32 ) >= cache->tagShift + 32;
+
+    cache->arena = malloc( lines * ( sizeof( uint32_t ) * ( wide ? 2 : 1 ) + ( timestamped ? sizeof( uint64_t ) : 0 ) + ( bitBased ? sizeof( uint8_t ) : 0 ) + sizeof( uint8_t ) ) );
 
-    if ( cache->sets == NULL ) {
+    if ( cache->arena == NULL ) {
         fputs( "Sem memória.\n", stderr );
         exit( EXIT_FAILURE );
     }
 
-    for ( size_t i = 0; i < cacheConfigList->cacheConfig.nsets; i++ ) {
-        cache->sets[ i ].lines = malloc( sizeof( cacheLine_t ) * cacheConfigList->cacheConfig.assoc );
+    // The timestamps come first so they are aligned, the policy bits last
+    cache->timestamps = timestamped ? cache->arena : NULL;
+    cache->tags = timestamped ? ( uint32_t * )( cache->timestamps + lines ) : cache->arena;
+    cache->tagsHigh = wide ? cache->tags + lines : NULL;
+    cache->policyBits = bitBased ? ( uint8_t * )( cache->tags + lines * ( wide ? 2 : 1 ) ) : NULL;
+    cache->lineFlags = ( uint8_t * )( cache->tags + lines * ( wide ? 2 : 1 ) ) + ( bitBased ? lines : 0 );
 
-        if ( cache->sets[ i ].lines == NULL ) {
-            fputs( "Sem memória.\n", stderr );
-            exit( EXIT_FAILURE );
-        }
-        
-        for ( size_t j = 0; j < cacheConfigList->cacheConfig.assoc; j++ ) {
-            cache->sets[ i ].lines[ j ].valid = false;
-            cache->sets[ i ].lines[ j ].lastUsed = 0;
-        }
+    for ( size_t i = 0; i < lines * ( wide ? 2 : 1 ); i++ ) {
+        cache->tags[ i ] = INVALID_TAG;
+    }
+
+    if ( bitBased ) {
+        memset( cache->policyBits, 0, lines );
+    }
+
+    memset( cache->lineFlags, 0, lines );
+
+    cache->invalidTagWay = cacheConfigList->cacheConfig.assoc;
+    cache->findWay = selectFindWay( cacheConfigList->cacheConfig.assoc );
+
+    selectAccessKernels( cache );
+
+    cache->missClassifier = NULL;
+
+    if ( cacheConfigList->cacheConfig.exactMissClassification ) {
+        cache->missClassifier = initializeMissClassifier( cacheConfigList->cacheConfig.bsize, cacheConfigList->cacheConfig.nsets * cacheConfigList->cacheConfig.assoc );
+    }
+
+    cache->prefetcher = NULL;
+
+    if ( cacheConfigList->cacheConfig.prefetcher != PREFETCH_NONE ) {
+        cache->prefetcher = initializePrefetcher( cacheConfigList->cacheConfig.prefetcher, cacheConfigList->cacheConfig.prefetchDegree,
+                                                  cacheConfigList->cacheConfig.prefetchDistance, cache->offsetBits, addressBits, lines );
     }
 
+    cache->victimCache = NULL;
+
+    if ( cacheConfigList->cacheConfig.victimCache != VICTIM_CACHE_NONE ) {
+        cache->victimCache = initializeVictimCache( cacheConfigList->cacheConfig.victimCache, cacheConfigList->cacheConfig.victimEntries );
+    }
+
+    cache->hotspots = cacheConfigList->cacheConfig.hotspots;
+
+    cache->upperLevel = NULL;
+
+    cache->directMapped = cacheConfigList->cacheConfig.assoc == 1 && cacheConfigList->next == NULL;
+
+    cache->firstTouch = NULL;
+
     if ( cacheConfigList->next != NULL ) {
         cache->nextLevel = initializeCache( cacheConfigList->next );
+        cache->nextLevel->upperLevel = cache;
+        cache->nextLevel->directMapped = false;
+
+        if ( cacheConfigList->cacheConfig.inclusionPolicy == INCLUSION_EXCLUSIVE ) {
+            cache->nextLevel->firstTouch = initializeFirstTouch();
+        }
     } else {
         cache->nextLevel = NULL;
     }
+
+    // Inclusive and exclusive hierarchies move blocks between levels outside of the misses of the level above
+    cache->lineTracking = cache->prefetcher != NULL || cache->victimCache != NULL || cache->partition != NULL
+        || ( cache->nextLevel != NULL
+        && ( cache->nextLevel->lineTracking || cacheConfigList->cacheConfig.inclusionPolicy != INCLUSION_NINE ) );
     
     return cache;
 }
@@ -177,13 +515,10 @@ cache_t * initializeCache( cacheConfigList_t * cacheConfigList ) {
 /*
  * Parse a cache address into its tag, set index, and block offset.
  */
-void parseAddress( cache_t * cache, uint32_t address, uint32_t * tag, uint32_t * setIndex, uint32_t * blockOffset ) {
-    const uint32_t  offsetBits = log2PowerOf2( cache->cacheConfig.bsize );
-    const uint32_t  setBits = log2PowerOf2( cache->cacheConfig.nsets );
-
-    *blockOffset = address & ( ( 1 << offsetBits ) - 1 );
-    *setIndex = ( address >> offsetBits ) & ( ( 1 << setBits ) - 1 );
-    *tag = address >> ( offsetBits + setBits );
+static inline void parseAddress( cache_t * cache, uint64_t address, uint64_t * tag, uint32_t * setIndex, uint32_t * blockOffset ) {
+    *blockOffset = ( uint32_t )address & ( ( UINT32_C( 1 ) << cache->offsetBits ) - 1 );
+    *setIndex = ( uint32_t )( address >> cache->offsetBits ) & cache->indexMask;
+    *tag = address >> cache->tagShift;
 }
 
 /*
@@ -194,11 +529,27 @@ void destroyCache( cache_t * cache ) {
     cache_t *  previous;
 
     while ( current != NULL ) {
-        for ( size_t i = 0; i < current->cacheConfig.nsets; i++ ) {
-            free( current->sets[ i ].lines );
+        free( current->arena );
+
+        if ( current->missClassifier != NULL ) {
+            destroyMissClassifier( current->missClassifier );
+        }
+
+        if ( current->prefetcher != NULL ) {
+            destroyPrefetcher( current->prefetcher );
+        }
+
+        if ( current->victimCache != NULL ) {
+            destroyVictimCache( current->victimCache );
         }
 
-        free( current->sets );
+        if ( current->partition != NULL ) {
+            destroyTenantPartition( current->partition );
+        }
+
+        if ( current->firstTouch != NULL ) {
+            destroyFirstTouch( current->firstTouch );
+        }
         
         previous = current;
         current = current->nextLevel;
@@ -209,233 +560,1178 @@ void destroyCache( cache_t * cache ) {
 
 /*
  * Determine if a cache miss is a capacity miss or a conflict miss and update the statistics accordingly.
+ *
+ * Misses of a single level directly mapped cache are always conflict misses, as in simulateDirectMapping, so a level
+ * that takes the generic structure for a victim cache, a prefetcher or a profile keeps the same classification.
+ *
+ * The levels that track the blocks they access lose lines to their hits, so they are seldom full, and count as full
+ * once they have accessed as many blocks as they have lines instead.
  */
 void updateCapacityConflictMissStats( cache_t * cache ) {
-    if ( cache->validLines == cache->cacheConfig.nsets * cache->cacheConfig.assoc ) {
+    uint32_t  lines = cache->cacheConfig.nsets * cache->cacheConfig.assoc;
+    bool      full = cache->firstTouch != NULL ? cache->firstTouch->blocks >= lines : cache->validLines == lines;
+
+    if ( full && !cache->directMapped ) {
         cache->result.capacityMisses++;
     } else {
         cache->result.conflictMisses++;
     }
 }
 
-// Dispatcher must be forward declared for the recursion to work
-void accessCache_r( cache_t * cache, uint32_t address );
-
 /*
- * Simulate a cache access using the RANDOM replacement policy.
+ * Update the miss statistics of a cache miss.
  *
- * This function is indirectly recursive, as it calls accessCache_r, which calls a cache access function.
+ * If the misses of the cache are classified exactly, missKind is the classification of the access by the miss
+ * classifier. Otherwise compulsory tells if the miss is compulsory, see accessCacheLine, and the rest are classified by
+ * updateCapacityConflictMissStats.
  */
-void accessCacheRandom_r( cache_t * cache, uint32_t address ) {
-    uint32_t tag, setIndex, blockOffset;
-    parseAddress(cache, address, &tag, &setIndex, &blockOffset);
-
-    cacheSet_t * set = &cache->sets[ setIndex ];
-    int emptyLineIndex = -1; // Keep track of an empty line, if any
-
-    cache->result.accesses++; // Increment the number of accesses in all cases
-
-    // Find a cache hit or an empty line
-    for ( uint32_t i = 0; i < cache->cacheConfig.assoc; i++ ) {
-        if ( set->lines[ i ].valid && set->lines[ i ].tag == tag ) {
-            // Hit
-            cache->result.hits++;
-            
-            return;
-        }
-        
-        // Find the first empty line, if there is one
-        if ( !set->lines[ i ].valid && emptyLineIndex == -1 ) {
-            emptyLineIndex = i;
+static inline void updateMissStats( cache_t * cache, int missKind, bool compulsory ) {
+    if ( cache->missClassifier != NULL ) {
+        if ( missKind == COMPULSORY_MISS ) {
+            cache->result.compulsoryMisses++;
+        } else if ( missKind == CAPACITY_MISS ) {
+            cache->result.capacityMisses++;
+        } else {
+            cache->result.conflictMisses++;
         }
-    }
-
-    // Miss
-    if ( emptyLineIndex != -1 ) {
-        // If there's an empty line, use it
-        set->lines[ emptyLineIndex ].valid = true;
-        set->lines[ emptyLineIndex ].tag = tag;
-
-        cache->validLines++;
-
+    } else if ( compulsory ) {
         cache->result.compulsoryMisses++;
     } else {
-        // If no empty lines, replace a random line
-        uint32_t replaceIndex = rand() % cache->cacheConfig.assoc;
-        set->lines[ replaceIndex ].tag = tag;
-        set->lines[ replaceIndex ].valid = true;
-        
         updateCapacityConflictMissStats( cache );
     }
+}
+
+#if defined( __GNUC__ )
+#define ALWAYS_INLINE inline __attribute__(( always_inline ))
+#else
+#define ALWAYS_INLINE inline
+#endif
+
+/*
+ * Gets the index of the lowest set bit of a non-zero mask.
+ */
+static inline uint32_t lowestSetBit( uint32_t mask ) {
+    #if defined( __GNUC__ )
+    return ( uint32_t )__builtin_ctz( mask );
+    #else
+    uint32_t index = 0;
 
-    // Look for the address in the next level of the cache
-    if ( cache->nextLevel != NULL ) {
-        accessCache_r( cache->nextLevel, address );
+    while ( ( mask & 1 ) == 0 ) {
+        mask >>= 1;
+        index++;
     }
+
+    return index;
+    #endif
 }
 
 /*
- * Simulate a cache access using the LRU replacement policy.
+ * Finds the first of count ways of a set with a tag.
  *
- * This function is indirectly recursive, as it calls accessCache_r, which calls a cache access function.
+ * In the kernels specialized for an associativity count is a constant of up to 16 ways, so the compares are unrolled
+ * into a mask without branches. The generic kernels use the SIMD search of the cache.
  */
-void accessCacheLRU_r( cache_t * cache, uint32_t address ) {
-    uint32_t  tag;
-    uint32_t  setIndex;
-    uint32_t  blockOffset;
-    
-    parseAddress( cache, address, &tag, &setIndex, &blockOffset );
+static ALWAYS_INLINE uint32_t findWayFixed( cache_t * cache, const uint32_t * tags, uint32_t count, uint32_t tag, bool fixed ) {
+    if ( fixed ) {
+        uint32_t mask = 0;
 
-    cacheSet_t *  set = &cache->sets[ setIndex ];
-    int           emptyLineIndex = -1;
-    unsigned int  oldestTime = UINT_MAX;
-    int32_t       lruIndex = -1;
-
-    cache->result.accesses++; // Increment the number of accesses in all cases
-
-    // Update LRU counter and find a cache hit, an empty line, or the LRU line
-    for ( uint32_t i = 0; i < cache->cacheConfig.assoc; i++ ) {
-        if ( set->lines[ i ].valid ) {
-            if ( set->lines[ i ].tag == tag ) {
-                // Hit
-                set->lines[ i ].lastUsed = ++cache->lruCounter; // Update usage time
-                cache->result.hits++;
-                
-                return;
-            }
-            
-            if ( set->lines[ i ].lastUsed < oldestTime ) {
-                oldestTime = set->lines[ i ].lastUsed;
-                lruIndex = i; // Remember the LRU line
-            }
-        } else if ( emptyLineIndex == -1 ) {
-            emptyLineIndex = i; // Remember the first empty line
+        for ( uint32_t i = 0; i < count; i++ ) {
+            mask |= ( uint32_t )( tags[ i ] == tag ) << i;
         }
-    }
 
-    // Miss
-    if ( emptyLineIndex != -1 ) {
-        // Use the empty line if there is one
-        set->lines[ emptyLineIndex ].valid = 1;
-        set->lines[ emptyLineIndex ].tag = tag;
-        set->lines[ emptyLineIndex ].lastUsed = ++cache->lruCounter; // Update usage time
+        return mask != 0 ? lowestSetBit( mask ) : count;
+    }
 
-        cache->validLines++;
+    return cache->findWay( tags, count, tag );
+}
 
-        cache->result.compulsoryMisses++;
-    } else {
-        // Replace the LRU line if there isn't an empty line
-        set->lines[ lruIndex ].tag = tag;
-        set->lines[ lruIndex ].lastUsed = ++cache->lruCounter; // Update usage time
+/*
+ * Finds the first of count ways of a set with a wide tag, split in its low half in tags and its high half in tagsHigh.
+ *
+ * The low halves are searched like narrow tags and each match is confirmed by its high half.
+ */
+static ALWAYS_INLINE uint32_t findWideWay( cache_t * cache, const uint32_t * tags, const uint32_t * tagsHigh, uint32_t count, uint64_t tag, bool fixed ) {
+    uint32_t way = findWayFixed( cache, tags, count, ( uint32_t )tag, fixed );
 
-        updateCapacityConflictMissStats( cache );
+    while ( way < count && tagsHigh[ way ] != ( uint32_t )( tag >> 32 ) ) {
+        way += 1 + cache->findWay( tags + way + 1, count - way - 1, ( uint32_t )tag );
     }
 
-    // Look for the address in the next level of the cache
-    if ( cache->nextLevel != NULL ) {
-        accessCache_r( cache->nextLevel, address );
-    }
+    return way;
 }
 
 /*
- * Simulate a cache access using the FIFO replacement policy.
+ * Finds the way of the valid line of a set with a tag, returns assoc if there isn't one.
  *
- * This function is indirectly recursive, as it calls accessCache_r, which calls a cache access function.
+ * wide is whether the tags of the cache are wide, in which case tagsHigh holds the high halves of the tags of the set.
  */
-void accessCacheFIFO_r( cache_t * cache, unsigned address ) {
-    uint32_t  tag;
-    uint32_t  setIndex;
-    uint32_t  blockOffset;
-    
-    parseAddress( cache, address, &tag, &setIndex, &blockOffset );
+static ALWAYS_INLINE uint32_t findLine( cache_t * cache, const uint32_t * tags, const uint32_t * tagsHigh, uint32_t assoc, uint64_t tag, bool fixed, bool wide ) {
+    // Only a tag as wide as its storage can be the invalid tag, and the way of its line is tracked separately
+    if ( tag == ( wide ? UINT64_MAX : INVALID_TAG ) ) {
+        return cache->invalidTagWay;
+    }
+
+    return wide ? findWideWay( cache, tags, tagsHigh, assoc, tag, fixed ) : findWayFixed( cache, tags, assoc, ( uint32_t )tag, fixed );
+}
 
-    cacheSet_t * set = &cache->sets[ setIndex ];
-    int emptyLineIndex = -1;
-    unsigned int oldestInsertion = UINT_MAX;
-    int fifoIndex = -1;
+/*
+ * Finds the first invalid line of a set, returns assoc if there isn't one.
+ */
+static ALWAYS_INLINE uint32_t findEmptyLine( cache_t * cache, const uint32_t * tags, const uint32_t * tagsHigh, uint32_t assoc, bool fixed, bool wide ) {
+    uint32_t way;
 
-    cache->result.accesses++; // Increment the number of accesses in all cases
+    // Once every line of the cache is valid there is no need to search
+    if ( cache->validLines == cache->cacheConfig.nsets * assoc ) {
+        return assoc;
+    }
 
-    // Search for a cache hit, an empty line, or the oldest line for FIFO
-    for ( uint32_t i = 0; i < cache->cacheConfig.assoc; i++ ) {
-        if ( set->lines[ i ].valid ) {
-            if ( set->lines[ i ].tag == tag ) {
-                // Hit
-                cache->result.hits++;
+    way = wide ? findWideWay( cache, tags, tagsHigh, assoc, UINT64_MAX, fixed ) : findWayFixed( cache, tags, assoc, INVALID_TAG, fixed );
 
-                return;
-            }
-            
-            if ( set->lines[ i ].inserted < oldestInsertion ) {
-                oldestInsertion = set->lines[ i ].inserted;
-                fifoIndex = i; // Remember the oldest line for possible replacement
-            }
-        } else if ( emptyLineIndex == -1 ) {
-            emptyLineIndex = i; // Remember the first empty line
-        }
+    // Skip the valid line with the invalid tag
+    if ( way < assoc && way == cache->invalidTagWay ) {
+        way += 1 + ( wide ? findWideWay( cache, tags + way + 1, tagsHigh + way + 1, assoc - way - 1, UINT64_MAX, false )
+                          : cache->findWay( tags + way + 1, assoc - way - 1, INVALID_TAG ) );
     }
 
-    // Miss
-    if ( emptyLineIndex != -1 ) {
-        // Use the empty line if there is one
-        set->lines[ emptyLineIndex ].valid = 1;
-        set->lines[ emptyLineIndex ].tag = tag;
-        set->lines[ emptyLineIndex ].inserted = ++cache->fifoCounter; // Set the insertion time
+    return way;
+}
+
+/*
+ * Finds the line of a set with the oldest timestamp, all lines of the set must be valid.
+ */
+static ALWAYS_INLINE uint32_t findOldestLine( const uint64_t * timestamps, uint32_t assoc ) {
+    uint64_t  oldestTime = timestamps[ 0 ];
+    uint32_t  oldestIndex = 0;
+
+    for ( uint32_t i = 1; i < assoc; i++ ) {
+        if ( timestamps[ i ] < oldestTime ) {
+            oldestTime = timestamps[ i ];
+            oldestIndex = i;
+        }
+    }
 
-        cache->validLines++;
+    return oldestIndex;
+}
 
-        cache->result.compulsoryMisses++;
-    } else {
-        // If there isn't an empty line, replace the oldest line
-        set->lines[ fifoIndex ].tag = tag;
-        set->lines[ fifoIndex ].inserted = ++cache->fifoCounter; // Update insertion time for the replaced line
+/*
+ * Stores a tag in a line of a set, keeping track of the line with the invalid tag.
+ */
+static ALWAYS_INLINE void fillLine( cache_t * cache, uint32_t * tags, uint32_t * tagsHigh, uint32_t way, uint64_t tag, bool wide ) {
+    tags[ way ] = ( uint32_t )tag;
 
-        updateCapacityConflictMissStats( cache );
+    if ( wide ) {
+        tagsHigh[ way ] = ( uint32_t )( tag >> 32 );
     }
 
-    // Look for the address in the next level of the cache
-    if ( cache->nextLevel != NULL ) {
-        accessCache_r( cache->nextLevel, address );
+    if ( tag == ( wide ? UINT64_MAX : INVALID_TAG ) ) {
+        cache->invalidTagWay = way;
+    } else if ( way == cache->invalidTagWay ) {
+        cache->invalidTagWay = cache->cacheConfig.assoc;
     }
 }
 
 /*
- * Simulate a cache access using the cache's replacement policy.
+ * Points the tree pseudo-LRU bits of a set away from a way.
  *
- * This a dispatch function that calls the appropriate function for the cache's replacement policy.
- * 
- * This function causes a recursive behavior, as it calls a cache access function, which in turn calls this function again.
- */
-void accessCache_r( cache_t * cache, uint32_t address ) {
-    if ( cache->cacheConfig.replacementPolicy == RANDOM ) {
-        accessCacheRandom_r( cache, address );
-    } else if ( cache->cacheConfig.replacementPolicy == LRU ) {
-        accessCacheLRU_r( cache, address );
-    } else if ( cache->cacheConfig.replacementPolicy == FIFO ) {
-        accessCacheFIFO_r( cache, address );
-    } else {
-        fputs( "Politica de substituição inválida.\n", stderr );
-        exit( EXIT_FAILURE );
+ * The tree of a set has assoc - 1 nodes stored in heap order from index 1 in the bits of the set, each node pointing
+ * to the subtree with the next victim: 0 for the left subtree and 1 for the right one.
+ */
+static ALWAYS_INLINE void touchTreePLRU( uint8_t * bits, uint32_t assoc, uint32_t way ) {
+    for ( uint32_t node = way + assoc; node > 1; node >>= 1 ) {
+        bits[ node >> 1 ] = ( uint8_t )( ( node & 1 ) == 0 );
+    }
+}
+
+/*
+ * Follows the tree pseudo-LRU bits of a set to the victim.
+ */
+static ALWAYS_INLINE uint32_t findTreePLRUVictim( const uint8_t * bits, uint32_t assoc ) {
+    uint32_t node = 1;
+
+    while ( node < assoc ) {
+        node = node * 2 + bits[ node ];
+    }
+
+    return node - assoc;
+}
+
+/*
+ * Finds the first line of a set whose NRU bit is clear, clearing the bits of all lines first if all are set.
+ */
+static ALWAYS_INLINE uint32_t findNRUVictim( uint8_t * bits, uint32_t assoc ) {
+    uint8_t * victim = memchr( bits, 0, assoc );
+
+    if ( victim == NULL ) {
+        memset( bits, 0, assoc );
+
+        return 0;
+    }
+
+    return ( uint32_t )( victim - bits );
+}
+
+/*
+ * Finds the first line of a set predicted to be re-referenced last, aging all lines of the set until there is one.
+ *
+ * All lines are aged at once by the distance from the largest prediction of the set to RRPV_MAX.
+ */
+static ALWAYS_INLINE uint32_t findRRIPVictim( uint8_t * bits, uint32_t assoc ) {
+    uint8_t * victim = memchr( bits, RRPV_MAX, assoc );
+    uint8_t   largest = 0;
+
+    if ( victim != NULL ) {
+        return ( uint32_t )( victim - bits );
+    }
+
+    for ( uint32_t i = 0; i < assoc; i++ ) {
+        largest = bits[ i ] > largest ? bits[ i ] : largest;
+    }
+
+    for ( uint32_t i = 0; i < assoc; i++ ) {
+        bits[ i ] += RRPV_MAX - largest;
+    }
+
+    return ( uint32_t )( ( uint8_t * )memchr( bits, RRPV_MAX, assoc ) - bits );
+}
+
+/*
+ * Checks if a bimodal insertion is a distant one, all but one in BIMODAL_THROTTLE are.
+ */
+static ALWAYS_INLINE bool isDistantInsertion( cache_t * cache ) {
+    return ++cache->bimodalCounter % BIMODAL_THROTTLE != 0;
+}
+
+/*
+ * Gets the DIP role of a set: 1 for the leader sets that always use LRU insertion, -1 for the leader sets that always
+ * use bimodal insertion and 0 for the follower sets, which use the insertion of the leaders with fewer misses.
+ *
+ * Caches with at least 64 sets have one leader set of each kind every 64 sets, smaller caches have the first and last
+ * sets as leaders.
+ */
+static ALWAYS_INLINE int dipSetRole( cache_t * cache, uint32_t setIndex ) {
+    uint32_t nsets = cache->cacheConfig.nsets;
+
+    if ( nsets >= 64 ) {
+        return setIndex % 64 == 0 ? 1 : setIndex % 64 == 33 ? -1 : 0;
+    }
+
+    return setIndex == 0 ? 1 : setIndex == nsets - 1 ? -1 : 0;
+}
+
+/*
+ * Updates the replacement state of a line of a set that was hit.
+ *
+ * The replacement state is the timestamps of LRU, FIFO and DIP, and the bits of the other policies, which are the tree
+ * pseudo-LRU node of the same index for PLRU, the reference bit for NRU and the re-reference prediction value for SRRIP
+ * and BRRIP. RANDOM has no state.
+ */
+static ALWAYS_INLINE void touchLine( cache_t * cache, size_t firstLine, uint32_t way, uint32_t assoc, int policy ) {
+    if ( policy == LRU || policy == DIP ) {
+        cache->timestamps[ firstLine + way ] = ++cache->lruCounter;
+    } else if ( policy == PLRU ) {
+        touchTreePLRU( &cache->policyBits[ firstLine ], assoc, way );
+    } else if ( policy == NRU ) {
+        cache->policyBits[ firstLine + way ] = 1;
+    } else if ( policy == SRRIP || policy == BRRIP ) {
+        cache->policyBits[ firstLine + way ] = 0;
+    }
+}
+
+/*
+ * Picks the line of a full set to be replaced, finding a victim takes a constant number of passes over the set.
+ */
+static ALWAYS_INLINE uint32_t selectVictim( cache_t * cache, size_t firstLine, uint32_t assoc, int policy ) {
+    if ( policy == LRU || policy == FIFO || policy == DIP ) {
+        return findOldestLine( &cache->timestamps[ firstLine ], assoc );
+    } else if ( policy == PLRU ) {
+        return findTreePLRUVictim( &cache->policyBits[ firstLine ], assoc );
+    } else if ( policy == NRU ) {
+        return findNRUVictim( &cache->policyBits[ firstLine ], assoc );
+    } else if ( policy == SRRIP || policy == BRRIP ) {
+        return findRRIPVictim( &cache->policyBits[ firstLine ], assoc );
+    }
+
+    return randomBelow( cache, assoc );
+}
+
+/*
+ * Gets the mask of count ways from the first one on, up to 64 ways.
+ */
+static inline uint64_t wayRangeMask( uint32_t first, uint32_t count ) {
+    return ( count >= 64 ? UINT64_MAX : ( UINT64_C( 1 ) << count ) - 1 ) << first;
+}
+
+/*
+ * Finds the first invalid line of a set among the ways of a mask, returns assoc if there isn't one.
+ */
+static uint32_t findMaskedEmptyLine( cache_t * cache, size_t firstLine, uint32_t assoc, uint64_t wayMask ) {
+    for ( uint32_t way = 0; way < assoc; way++ ) {
+        bool invalid = cache->tags[ firstLine + way ] == INVALID_TAG && ( cache->tagsHigh == NULL || cache->tagsHigh[ firstLine + way ] == INVALID_TAG )
+            && way != cache->invalidTagWay;
+
+        if ( ( wayMask >> way & 1 ) != 0 && invalid ) {
+            return way;
+        }
+    }
+
+    return assoc;
+}
+
+/*
+ * Picks the line of a set to be replaced among the ways of a mask, like selectVictim restricted to those ways: the
+ * replacement state of the other ways is neither used nor changed, except that the tree pseudo-LRU bits are followed
+ * to the other subtree when the one they point to has none of the ways.
+ */
+static uint32_t selectMaskedVictim( cache_t * cache, size_t firstLine, uint32_t assoc, int policy, uint64_t wayMask ) {
+    uint8_t * bits = policy == PLRU || policy == NRU || policy == SRRIP || policy == BRRIP ? &cache->policyBits[ firstLine ] : NULL;
+
+    if ( policy == LRU || policy == FIFO || policy == DIP ) {
+        const uint64_t *  timestamps = &cache->timestamps[ firstLine ];
+        uint32_t          oldest = assoc;
+
+        for ( uint32_t way = 0; way < assoc; way++ ) {
+            if ( ( wayMask >> way & 1 ) != 0 && ( oldest == assoc || timestamps[ way ] < timestamps[ oldest ] ) ) {
+                oldest = way;
+            }
+        }
+
+        return oldest;
+    } else if ( policy == PLRU ) {
+        uint32_t node = 1;
+        uint32_t first = 0;
+        uint32_t span = assoc;
+
+        while ( node < assoc ) {
+            uint32_t side = bits[ node ];
+
+            span /= 2;
+
+            if ( ( wayMask & wayRangeMask( first + side * span, span ) ) == 0 ) {
+                side ^= 1;
+            }
+
+            node = node * 2 + side;
+            first += side * span;
+        }
+
+        return first;
+    } else if ( policy == NRU || policy == SRRIP || policy == BRRIP ) {
+        uint8_t target = policy == NRU ? 0 : RRPV_MAX;
+
+        // Age the ways of the mask until one of them is a victim, NRU clears their bits at once
+        while ( true ) {
+            for ( uint32_t way = 0; way < assoc; way++ ) {
+                if ( ( wayMask >> way & 1 ) != 0 && bits[ way ] == target ) {
+                    return way;
+                }
+            }
+
+            for ( uint32_t way = 0; way < assoc; way++ ) {
+                if ( ( wayMask >> way & 1 ) != 0 ) {
+                    bits[ way ] = policy == NRU ? 0 : bits[ way ] + 1;
+                }
+            }
+        }
+    }
+
+    // RANDOM picks one of the ways of the mask uniformly
+    uint32_t choice = randomBelow( cache, ( uint32_t )__builtin_popcountll( wayMask ) );
+
+    for ( uint32_t way = 0; way < assoc; way++ ) {
+        if ( ( wayMask >> way & 1 ) != 0 && choice-- == 0 ) {
+            return way;
+        }
+    }
+
+    return assoc;
+}
+
+/*
+ * Sets the replacement state of a line just filled by a miss of a set.
+ */
+static ALWAYS_INLINE void insertLine( cache_t * cache, uint32_t setIndex, size_t firstLine, uint32_t way, uint32_t assoc, int policy ) {
+    if ( policy == LRU ) {
+        cache->timestamps[ firstLine + way ] = ++cache->lruCounter;
+    } else if ( policy == FIFO ) {
+        cache->timestamps[ firstLine + way ] = ++cache->fifoCounter;
+    } else if ( policy == PLRU ) {
+        touchTreePLRU( &cache->policyBits[ firstLine ], assoc, way );
+    } else if ( policy == NRU ) {
+        cache->policyBits[ firstLine + way ] = 1;
+    } else if ( policy == SRRIP ) {
+        cache->policyBits[ firstLine + way ] = RRPV_MAX - 1;
+    } else if ( policy == BRRIP ) {
+        cache->policyBits[ firstLine + way ] = isDistantInsertion( cache ) ? RRPV_MAX : RRPV_MAX - 1;
+    } else if ( policy == DIP ) {
+        int   role = dipSetRole( cache, setIndex );
+        bool  bimodal = role < 0 || ( role == 0 && cache->policySelector > DIP_PSEL_MAX / 2 );
+
+        // Misses of the leaders vote for the insertion of the other leaders
+        if ( role > 0 && cache->policySelector < DIP_PSEL_MAX ) {
+            cache->policySelector++;
+        } else if ( role < 0 && cache->policySelector > 0 ) {
+            cache->policySelector--;
+        }
+
+        // Bimodal insertion puts most lines in the LRU position, below every line inserted before
+        cache->timestamps[ firstLine + way ] = bimodal && isDistantInsertion( cache ) ? --cache->lipCounter : ++cache->lruCounter;
+    }
+}
+
+/*
+ * Simulate a cache access with any replacement policy.
+ *
+ * The body of the kernels, fixedAssoc is the associativity of the kernel or 0 for the generic kernel, wide is whether
+ * the tags of the cache are wide, see cache_t, and policy is a constant, so each kernel only keeps the code of its
+ * policy. Returns true on a hit.
+ *
+ * outcome is NULL in the kernels that only count hits and misses. Otherwise it selects whether a miss fills a line and
+ * receives the line that was used and the line that was replaced, see accessOutcome_t.
+ */
+static ALWAYS_INLINE bool accessCacheLine( cache_t * cache, uint64_t address, uint32_t fixedAssoc, bool wide, int policy, accessOutcome_t * outcome ) {
+    uint64_t  tag;
+    uint32_t  setIndex;
+    uint32_t  blockOffset;
+
+    parseAddress( cache, address, &tag, &setIndex, &blockOffset );
+
+    // Only the accesses with an outcome can go to a partitioned level, see lineTracking
+    tenantPartition_t *  partition = outcome != NULL ? cache->partition : NULL;
+    unsigned int         tenant = partition != NULL ? partition->tenant : 0;
+    bool                 setPartitioned = partition != NULL && partition->setPartitioned;
+
+    if ( setPartitioned ) {
+        setIndex = partitionSet( partition, setIndex );
+    }
+
+    // Only the accesses with an outcome can go to a level below the first of an exclusive hierarchy, see lineTracking
+    firstTouch_t * firstTouch = outcome != NULL ? cache->firstTouch : NULL;
+
+    // Profiles are kept by the batched kernels too, so profiling a level doesn't change how it is simulated
+    hotspotProfile_t * hotspots = cache->hotspots;
+
+    uint32_t    assoc = fixedAssoc != 0 ? fixedAssoc : cache->cacheConfig.assoc;
+    size_t      firstLine = ( size_t )setIndex * assoc;
+    uint32_t *  tags = &cache->tags[ firstLine ];
+    uint32_t *  tagsHigh = wide ? &cache->tagsHigh[ firstLine ] : NULL;
+    uint32_t    lineIndex;
+    bool        emptyLine;
+
+    bool uncounted = outcome != NULL && outcome->uncounted;
+
+    if ( !uncounted ) {
+        cache->result.accesses++; // Increment the number of accesses in all cases
+    }
+
+    if ( partition != NULL && !uncounted ) {
+        partition->results[ tenant ].accesses++;
+    }
+
+    // The shadow cache of the classifier sees every access, hits included
+    int missKind = cache->missClassifier != NULL && !uncounted ? classifyAccess( cache->missClassifier, ( uint32_t )address ) : COMPULSORY_MISS;
+
+    // A miss is compulsory if it fills an empty line, or if it is the first access to the block at a level that tracks them
+    bool firstAccess = firstTouch != NULL && !uncounted && touchBlock( firstTouch, address >> cache->offsetBits );
+
+    lineIndex = findLine( cache, tags, tagsHigh, assoc, tag, fixedAssoc != 0, wide );
+
+    if ( lineIndex < assoc ) {
+        // Hit
+        if ( !uncounted ) {
+            touchLine( cache, firstLine, lineIndex, assoc, policy );
+
+            cache->result.hits++;
+        }
+
+        if ( partition != NULL && !uncounted ) {
+            partition->results[ tenant ].hits++;
+        }
+
+        if ( hotspots != NULL && !uncounted ) {
+            hotspots->sets[ setIndex ].hits++;
+        }
+
+        if ( outcome != NULL ) {
+            outcome->line = firstLine + lineIndex;
+            outcome->evicted = false;
+        }
+
+        return true;
+    }
+
+    // Miss, use the empty line if there is one or pick a victim, among the ways of the tenant in a partitioned level
+    uint64_t wayMask = partition != NULL ? partition->wayMasks[ tenant ] : 0;
+
+    lineIndex = wayMask != 0 ? findMaskedEmptyLine( cache, firstLine, assoc, wayMask ) : findEmptyLine( cache, tags, tagsHigh, assoc, fixedAssoc != 0, wide );
+    emptyLine = lineIndex < assoc;
+
+    if ( outcome != NULL ) {
+        outcome->evicted = false;
+
+        if ( !outcome->allocate ) {
+            outcome->line = NO_LINE;
+
+            // Without a fill the empty line stays empty and the next miss of the block would be compulsory again
+            updateMissStats( cache, missKind, firstAccess );
+
+            if ( hotspots != NULL && !uncounted ) {
+                recordHotspotMiss( hotspots, setIndex, address );
+            }
+
+            return false;
+        }
+    }
+
+    if ( !emptyLine ) {
+        lineIndex = wayMask != 0 ? selectMaskedVictim( cache, firstLine, assoc, policy, wayMask ) : selectVictim( cache, firstLine, assoc, policy );
+
+        if ( outcome != NULL ) {
+            uint64_t victimTag = tags[ lineIndex ] | ( wide ? ( uint64_t )tagsHigh[ lineIndex ] << 32 : 0 );
+
+            outcome->evicted = true;
+            outcome->evictedAddress = ( victimTag << cache->tagShift ) | ( setPartitioned ? 0 : ( uint64_t )setIndex << cache->offsetBits );
+            outcome->evictedFlags = cache->lineFlags[ firstLine + lineIndex ];
+        }
+
+        if ( hotspots != NULL ) {
+            hotspots->sets[ setIndex ].evictions++;
+        }
+    }
+
+    fillLine( cache, tags, tagsHigh, lineIndex, tag, wide );
+    insertLine( cache, setIndex, firstLine, lineIndex, assoc, policy );
+
+    if ( outcome != NULL ) {
+        outcome->line = firstLine + lineIndex;
+        cache->lineFlags[ outcome->line ] = 0;
+    }
+
+    if ( partition != NULL ) {
+        partition->owners[ firstLine + lineIndex ] = ( uint8_t )tenant;
+    }
+
+    if ( emptyLine ) {
+        cache->validLines++;
+    }
+
+    if ( !uncounted ) {
+        updateMissStats( cache, missKind, firstTouch != NULL ? firstAccess : emptyLine );
+    }
+
+    if ( hotspots != NULL && !uncounted ) {
+        recordHotspotMiss( hotspots, setIndex, address );
+    }
+
+    return false;
+}
+
+/*
+ * Defines the kernels of a policy and associativity for each address width, which access an array of addresses in a
+ * cache level and write the addresses that miss to misses, in order. Returns the number of misses.
+ *
+ * The miss is always written and only kept if the access misses, so the loop doesn't branch on the result. Tags of
+ * 32-bit addresses always fit in 32 bits, so only the 64-bit kernels check if the tags of the cache are wide.
+ */
+#define DEFINE_ACCESS_KERNEL( NAME, POLICY, ASSOC ) \
+    static size_t accessCache##NAME##ASSOC( cache_t * cache, const uint32_t * addresses, size_t count, uint32_t * misses ) { \
+        size_t missCount = 0; \
+        for ( size_t i = 0; i < count; i++ ) { \
+            misses[ missCount ] = addresses[ i ]; \
+            missCount += !accessCacheLine( cache, addresses[ i ], ASSOC, false, POLICY, NULL ); \
+        } \
+        return missCount; \
+    } \
+    static size_t accessCache64##NAME##ASSOC( cache_t * cache, const uint64_t * addresses, size_t count, uint64_t * misses ) { \
+        size_t  missCount = 0; \
+        bool    wide = cache->tagsHigh != NULL; \
+        for ( size_t i = 0; i < count; i++ ) { \
+            misses[ missCount ] = addresses[ i ]; \
+            missCount += !accessCacheLine( cache, addresses[ i ], ASSOC, wide, POLICY, NULL ); \
+        } \
+        return missCount; \
+    }
+
+/*
+ * Defines the kernels of all replacement policies for an associativity, 0 defines the generic kernels.
+ */
+#define DEFINE_ACCESS_KERNELS( ASSOC ) \
+    DEFINE_ACCESS_KERNEL( Random, RANDOM, ASSOC ) \
+    DEFINE_ACCESS_KERNEL( LRU, LRU, ASSOC ) \
+    DEFINE_ACCESS_KERNEL( FIFO, FIFO, ASSOC ) \
+    DEFINE_ACCESS_KERNEL( PLRU, PLRU, ASSOC ) \
+    DEFINE_ACCESS_KERNEL( NRU, NRU, ASSOC ) \
+    DEFINE_ACCESS_KERNEL( SRRIP, SRRIP, ASSOC ) \
+    DEFINE_ACCESS_KERNEL( BRRIP, BRRIP, ASSOC ) \
+    DEFINE_ACCESS_KERNEL( DIP, DIP, ASSOC )
+
+/*
+ * Defines the kernel of a policy that accesses a single address with an outcome, for the simulations that follow each
+ * access through the hierarchy. Only the generic associativity is needed, their cost is in the code around them.
+ */
+#define DEFINE_LINE_KERNEL( NAME, POLICY ) \
+    static bool accessLine##NAME( cache_t * cache, uint64_t address, accessOutcome_t * outcome ) { \
+        return accessCacheLine( cache, address, 0, cache->tagsHigh != NULL, POLICY, outcome ); \
+    }
+
+DEFINE_LINE_KERNEL( Random, RANDOM )
+DEFINE_LINE_KERNEL( LRU, LRU )
+DEFINE_LINE_KERNEL( FIFO, FIFO )
+DEFINE_LINE_KERNEL( PLRU, PLRU )
+DEFINE_LINE_KERNEL( NRU, NRU )
+DEFINE_LINE_KERNEL( SRRIP, SRRIP )
+DEFINE_LINE_KERNEL( BRRIP, BRRIP )
+DEFINE_LINE_KERNEL( DIP, DIP )
+
+DEFINE_ACCESS_KERNELS( 0 )
+DEFINE_ACCESS_KERNELS( 1 )
+DEFINE_ACCESS_KERNELS( 2 )
+DEFINE_ACCESS_KERNELS( 4 )
+DEFINE_ACCESS_KERNELS( 8 )
+DEFINE_ACCESS_KERNELS( 16 )
+
+// Associativities with specialized kernels, in the order of the columns of accessKernels
+static const uint32_t specializedAssocs[] = { 1, 2, 4, 8, 16 };
+
+// Kernels by replacement policy, the generic kernel followed by the specialized kernels of each associativity
+static const accessKernel_t accessKernels[][ 6 ] = {
+    [ RANDOM ] = { accessCacheRandom0, accessCacheRandom1, accessCacheRandom2, accessCacheRandom4, accessCacheRandom8, accessCacheRandom16 },
+    [ LRU ] = { accessCacheLRU0, accessCacheLRU1, accessCacheLRU2, accessCacheLRU4, accessCacheLRU8, accessCacheLRU16 },
+    [ FIFO ] = { accessCacheFIFO0, accessCacheFIFO1, accessCacheFIFO2, accessCacheFIFO4, accessCacheFIFO8, accessCacheFIFO16 },
+    [ PLRU ] = { accessCachePLRU0, accessCachePLRU1, accessCachePLRU2, accessCachePLRU4, accessCachePLRU8, accessCachePLRU16 },
+    [ NRU ] = { accessCacheNRU0, accessCacheNRU1, accessCacheNRU2, accessCacheNRU4, accessCacheNRU8, accessCacheNRU16 },
+    [ SRRIP ] = { accessCacheSRRIP0, accessCacheSRRIP1, accessCacheSRRIP2, accessCacheSRRIP4, accessCacheSRRIP8, accessCacheSRRIP16 },
+    [ BRRIP ] = { accessCacheBRRIP0, accessCacheBRRIP1, accessCacheBRRIP2, accessCacheBRRIP4, accessCacheBRRIP8, accessCacheBRRIP16 },
+    [ DIP ] = { accessCacheDIP0, accessCacheDIP1, accessCacheDIP2, accessCacheDIP4, accessCacheDIP8, accessCacheDIP16 }
+};
+
+// Kernels of 64-bit addresses, in the same order as accessKernels
+static const accessKernel64_t accessKernels64[][ 6 ] = {
+    [ RANDOM ] = { accessCache64Random0, accessCache64Random1, accessCache64Random2, accessCache64Random4, accessCache64Random8, accessCache64Random16 },
+    [ LRU ] = { accessCache64LRU0, accessCache64LRU1, accessCache64LRU2, accessCache64LRU4, accessCache64LRU8, accessCache64LRU16 },
+    [ FIFO ] = { accessCache64FIFO0, accessCache64FIFO1, accessCache64FIFO2, accessCache64FIFO4, accessCache64FIFO8, accessCache64FIFO16 },
+    [ PLRU ] = { accessCache64PLRU0, accessCache64PLRU1, accessCache64PLRU2, accessCache64PLRU4, accessCache64PLRU8, accessCache64PLRU16 },
+    [ NRU ] = { accessCache64NRU0, accessCache64NRU1, accessCache64NRU2, accessCache64NRU4, accessCache64NRU8, accessCache64NRU16 },
+    [ SRRIP ] = { accessCache64SRRIP0, accessCache64SRRIP1, accessCache64SRRIP2, accessCache64SRRIP4, accessCache64SRRIP8, accessCache64SRRIP16 },
+    [ BRRIP ] = { accessCache64BRRIP0, accessCache64BRRIP1, accessCache64BRRIP2, accessCache64BRRIP4, accessCache64BRRIP8, accessCache64BRRIP16 },
+    [ DIP ] = { accessCache64DIP0, accessCache64DIP1, accessCache64DIP2, accessCache64DIP4, accessCache64DIP8, accessCache64DIP16 }
+};
+
+// Single access kernels by replacement policy
+static const accessLineKernel_t accessLineKernels[] = {
+    [ RANDOM ] = accessLineRandom,
+    [ LRU ] = accessLineLRU,
+    [ FIFO ] = accessLineFIFO,
+    [ PLRU ] = accessLinePLRU,
+    [ NRU ] = accessLineNRU,
+    [ SRRIP ] = accessLineSRRIP,
+    [ BRRIP ] = accessLineBRRIP,
+    [ DIP ] = accessLineDIP
+};
+
+/*
+ * Selects the access kernels of a cache level for both address widths, specialized for its associativity if there is
+ * one.
+ */
+static void selectAccessKernels( cache_t * cache ) {
+    int     replacementPolicy = cache->cacheConfig.replacementPolicy;
+    size_t  column = 0;
+
+    if ( replacementPolicy < 0 || replacementPolicy >= ( int )( sizeof( accessKernels ) / sizeof( accessKernels[ 0 ] ) ) ) {
+        fputs( "Politica de substituição inválida.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( size_t i = 0; i < sizeof( specializedAssocs ) / sizeof( specializedAssocs[ 0 ] ); i++ ) {
+        if ( specializedAssocs[ i ] == cache->cacheConfig.assoc ) {
+            column = i + 1;
+        }
+    }
+
+    cache->access = accessKernels[ replacementPolicy ][ column ];
+    cache->access64 = accessKernels64[ replacementPolicy ][ column ];
+    cache->accessLine = accessLineKernels[ replacementPolicy ];
+}
+
+/*
+ * Finds the line of a cache level that holds the block of an address without accessing it, returns NO_LINE if there
+ * isn't one.
+ */
+size_t findBlockLine( cache_t * cache, uint64_t address ) {
+    uint64_t  tag;
+    uint32_t  setIndex;
+    uint32_t  blockOffset;
+
+    parseAddress( cache, address, &tag, &setIndex, &blockOffset );
+
+    if ( cache->partition != NULL && cache->partition->setPartitioned ) {
+        setIndex = partitionSet( cache->partition, setIndex );
+    }
+
+    uint32_t  assoc = cache->cacheConfig.assoc;
+    size_t    firstLine = ( size_t )setIndex * assoc;
+    bool      wide = cache->tagsHigh != NULL;
+    uint32_t  way = findLine( cache, &cache->tags[ firstLine ], wide ? &cache->tagsHigh[ firstLine ] : NULL, assoc, tag, false, wide );
+
+    return way < assoc ? firstLine + way : NO_LINE;
+}
+
+/*
+ * Invalidates a valid line of a cache level, returning its flags. The replacement state of the line is left as is,
+ * since invalid lines are always filled before any victim is picked.
+ */
+uint8_t invalidateLine( cache_t * cache, size_t line ) {
+    uint8_t flags = cache->lineFlags[ line ];
+
+    // Only a cache with a single set can have a valid line with the invalid tag, so its line index is its way
+    if ( line == cache->invalidTagWay ) {
+        cache->invalidTagWay = cache->cacheConfig.assoc;
+    }
+
+    cache->tags[ line ] = INVALID_TAG;
+
+    if ( cache->tagsHigh != NULL ) {
+        cache->tagsHigh[ line ] = INVALID_TAG;
+    }
+
+    cache->lineFlags[ line ] = 0;
+    cache->validLines--;
+
+    return flags;
+}
+
+/*
+ * Invalidates the copies of a block replaced in a level of an inclusive hierarchy in every level above it, returning
+ * the flags of the copies, so the block is written back if any of them is dirty. Levels above with smaller blocks may
+ * hold several blocks of it, levels with larger blocks lose the block that contains it.
+ */
+static uint8_t backInvalidate( cache_t * cache, uint64_t address ) {
+    uint32_t  bsize = cache->cacheConfig.bsize;
+    uint8_t   flags = 0;
+
+    for ( cache_t * upper = cache->upperLevel; upper != NULL; upper = upper->upperLevel ) {
+        uint32_t  upperBsize = upper->cacheConfig.bsize;
+        uint64_t  first = address & ~( uint64_t )( upperBsize - 1 );
+        uint32_t  count = upperBsize < bsize ? bsize / upperBsize : 1;
+
+        for ( uint32_t i = 0; i < count; i++ ) {
+            size_t line = findBlockLine( upper, first + ( uint64_t )i * upperBsize );
+
+            if ( line != NO_LINE ) {
+                flags |= invalidateLine( upper, line );
+                upper->result.backInvalidations++;
+            }
+        }
+    }
+
+    return flags;
+}
+
+static void moveVictim( cache_t * cache, uint64_t address, uint8_t flags );
+
+/*
+ * Handles the line replaced by a fill of a cache level, if there was one.
+ *
+ * Inclusive hierarchies first invalidate the block in the levels above. Exclusive hierarchies move every victim to
+ * the next level, clean or dirty, so the bytes written to the next level include the clean victims. Otherwise dirty
+ * victims are written back to the next level, or to memory by the last level.
+ */
+static void evictLine( cache_t * cache, accessOutcome_t * outcome ) {
+    uint32_t  bsize = cache->cacheConfig.bsize;
+    int       inclusionPolicy = cache->cacheConfig.inclusionPolicy;
+
+    if ( !outcome->evicted ) {
+        return;
+    }
+
+    if ( inclusionPolicy == INCLUSION_INCLUSIVE ) {
+        outcome->evictedFlags |= backInvalidate( cache, outcome->evictedAddress ) & LINE_DIRTY;
+    }
+
+    bool dirty = ( outcome->evictedFlags & LINE_DIRTY ) != 0;
+
+    if ( inclusionPolicy == INCLUSION_EXCLUSIVE && cache->nextLevel != NULL ) {
+        cache->result.writeBacks += dirty;
+        cache->result.bytesWritten += bsize;
+
+        moveVictim( cache->nextLevel, outcome->evictedAddress, outcome->evictedFlags & LINE_DIRTY );
+    } else if ( dirty ) {
+        cache->result.writeBacks++;
+        cache->result.bytesWritten += bsize;
+
+        if ( cache->nextLevel != NULL ) {
+            accessCacheRange( cache->nextLevel, outcome->evictedAddress, true, bsize );
+        }
+    }
+}
+
+/*
+ * Stores the victim of the level above in a level of an exclusive hierarchy, which doesn't count as an access to it.
+ * The victim of the level is in turn moved to the level below it.
+ */
+static void moveVictim( cache_t * cache, uint64_t address, uint8_t flags ) {
+    accessOutcome_t outcome = { .allocate = true, .uncounted = true };
+
+    if ( cache->accessLine( cache, address, &outcome ) ) {
+        cache->lineFlags[ outcome.line ] |= flags;
+
+        return;
+    }
+
+    cache->lineFlags[ outcome.line ] = flags;
+
+    evictLine( cache, &outcome );
+}
+
+/*
+ * Reads the block of a line just filled in a cache level from the next level, returning the flags it brings along. The
+ * next level is accessed once with the missing address, like the misses that accessCacheChunk passes down, so it sees
+ * the same accesses whatever its block size. The bytes that the last level moves are the traffic to memory.
+ */
+static uint8_t readNextLevel( cache_t * cache, uint64_t address ) {
+    cache->result.bytesRead += cache->cacheConfig.bsize;
+
+    return cache->nextLevel != NULL ? accessCacheRange( cache->nextLevel, address, false, 1 ) : 0;
+}
+
+/*
+ * Moves the blocks of a line just filled in a cache level: handles its victim with evictLine and reads the block of the
+ * line with readNextLevel.
+ *
+ * An exclusive hierarchy swaps the two blocks, so the missing block leaves the next level before the victim moves
+ * into it, otherwise the victim could replace the very block being read.
+ *
+ * Returns the flags the block brings from the next level, which is only dirty when it moves up from a level of an
+ * exclusive hierarchy.
+ */
+static uint8_t fillFromNextLevel( cache_t * cache, uint64_t address, accessOutcome_t * outcome ) {
+    bool     swap = cache->cacheConfig.inclusionPolicy == INCLUSION_EXCLUSIVE;
+    uint8_t  flags;
+
+    if ( !swap ) {
+        evictLine( cache, outcome );
+    }
+
+    flags = readNextLevel( cache, address );
+
+    if ( swap ) {
+        evictLine( cache, outcome );
+    }
+
+    return flags;
+}
+
+/*
+ * Fills a line of a cache level that has a victim or miss cache, in place of fillFromNextLevel.
+ *
+ * A victim cache receives the victim of the level, dropping its least recently used entry to the next level if it is
+ * full. If it holds the missing block, the block and the victim swap places and the next level is not accessed. A miss
+ * cache keeps a copy of every block read from the next level, and if it holds the missing block the line is filled
+ * from it instead, while the victim of the level goes to the next level as usual.
+ *
+ * Returns the flags the block brings along, like fillFromNextLevel.
+ */
+static uint8_t fillThroughVictimCache( cache_t * cache, uint64_t address, accessOutcome_t * outcome ) {
+    victimCache_t *  victimCache = cache->victimCache;
+    uint64_t         block = address & ~( uint64_t )( cache->cacheConfig.bsize - 1 );
+    uint32_t         entry = findVictimEntry( victimCache, block );
+    bool             swap = cache->cacheConfig.inclusionPolicy == INCLUSION_EXCLUSIVE;
+    uint8_t          flags = 0;
+
+    cache->result.victimProbes++;
+    cache->result.victimHits += entry != VICTIM_CACHE_NO_ENTRY;
+
+    if ( victimCache->kind == MISS_CACHE ) {
+        if ( entry == VICTIM_CACHE_NO_ENTRY ) {
+            insertVictimEntry( victimCache, block, 0, NULL, NULL );
+
+            return fillFromNextLevel( cache, address, outcome );
+        }
+
+        touchVictimEntry( victimCache, entry );
+        evictLine( cache, outcome );
+
+        return 0;
+    }
+
+    if ( entry != VICTIM_CACHE_NO_ENTRY ) {
+        flags = removeVictimEntry( victimCache, entry );
+    } else if ( swap ) {
+        // The entry dropped to the next level of an exclusive hierarchy could replace the block, see fillFromNextLevel
+        flags = readNextLevel( cache, address );
+    }
+
+    // The victim of the level takes the place of the block, or of the least recently used entry, which is replaced
+    if ( outcome->evicted ) {
+        accessOutcome_t dropped;
+
+        dropped.evicted = insertVictimEntry( victimCache, outcome->evictedAddress, outcome->evictedFlags, &dropped.evictedAddress, &dropped.evictedFlags );
+
+        evictLine( cache, &dropped );
+    }
+
+    if ( entry == VICTIM_CACHE_NO_ENTRY && !swap ) {
+        flags = readNextLevel( cache, address );
+    }
+
+    return flags;
+}
+
+/*
+ * Trains the prefetcher of a cache level with a demand access and prefetches the blocks it picks that are not in the
+ * level yet, through the replacement policy of the level. Prefetched lines are read from the next level like the lines
+ * filled by misses.
+ */
+static void issuePrefetches( cache_t * cache, uint64_t address, bool miss, bool prefetchHit ) {
+    uint64_t  candidates[ PREFETCH_MAX_DEGREE ];
+    size_t    count = trainPrefetcher( cache->prefetcher, address >> cache->offsetBits, miss, prefetchHit, candidates );
+
+    for ( size_t i = 0; i < count; i++ ) {
+        uint64_t         blockAddress = candidates[ i ] << cache->offsetBits;
+        accessOutcome_t  outcome = { .allocate = true, .uncounted = true };
+
+        if ( cache->accessLine( cache, blockAddress, &outcome ) ) {
+            continue;
+        }
+
+        cache->result.prefetches++;
+        cache->lineFlags[ outcome.line ] = LINE_PREFETCHED;
+        cache->prefetcher->issued[ outcome.line ] = cache->result.accesses;
+
+        cache->lineFlags[ outcome.line ] |= fillFromNextLevel( cache, blockAddress, &outcome );
+    }
+}
+
+/*
+ * Reads or writes size bytes of a single block of a cache level, moving blocks between it and the levels below as
+ * needed.
+ *
+ * A miss that fills a line goes through fillFromNextLevel, or fillThroughVictimCache if the level has a victim or miss
+ * cache. A write marks its line dirty, unless the level writes
+ * through or the write missed without allocating a line, in which case the written bytes go to the next level
+ * instead. The prefetcher of the level, if it has one, sees the access last.
+ *
+ * The levels below the first of an exclusive hierarchy never fill a line for an access from the level above: a hit
+ * moves the block up, invalidating its line, and a read miss reads the block from the next level on behalf of the
+ * level above. Returns the flags of the block moved up, 0 otherwise.
+ */
+static uint8_t accessCacheBlock( cache_t * cache, uint64_t address, bool write, uint64_t size ) {
+    bool             exclusive = cache->cacheConfig.inclusionPolicy == INCLUSION_EXCLUSIVE && cache->upperLevel != NULL;
+    accessOutcome_t  outcome = { .allocate = !exclusive && ( !write || !cache->cacheConfig.noWriteAllocate ), .uncounted = false };
+    uint8_t          movedFlags = 0;
+    bool             hit;
+    bool             prefetchHit;
+
+    if ( write ) {
+        cache->result.writes++;
+    }
+
+    hit = cache->accessLine( cache, address, &outcome );
+
+    if ( !hit && outcome.line != NO_LINE && cache->victimCache != NULL ) {
+        cache->lineFlags[ outcome.line ] |= fillThroughVictimCache( cache, address, &outcome );
+    } else if ( !hit && outcome.line != NO_LINE ) {
+        cache->lineFlags[ outcome.line ] |= fillFromNextLevel( cache, address, &outcome );
+    } else if ( !hit && exclusive && !write ) {
+        cache->result.bytesRead += cache->cacheConfig.bsize;
+
+        if ( cache->nextLevel != NULL ) {
+            movedFlags = accessCacheRange( cache->nextLevel, address, false, size );
+        }
+    }
+
+    // The first demand use of a prefetched line makes it a useful prefetch
+    prefetchHit = hit && ( cache->lineFlags[ outcome.line ] & LINE_PREFETCHED ) != 0;
+
+    if ( prefetchHit ) {
+        cache->lineFlags[ outcome.line ] &= ( uint8_t )~LINE_PREFETCHED;
+        cache->result.usefulPrefetches++;
+
+        if ( cache->result.accesses - cache->prefetcher->issued[ outcome.line ] < PREFETCH_TIMELY_DISTANCE ) {
+            cache->result.latePrefetches++;
+        }
+    }
+
+    if ( write ) {
+        if ( outcome.line == NO_LINE || cache->cacheConfig.writeThrough ) {
+            cache->result.bytesWritten += size;
+
+            if ( cache->nextLevel != NULL ) {
+                accessCacheRange( cache->nextLevel, address, true, size );
+            }
+        } else {
+            cache->lineFlags[ outcome.line ] |= LINE_DIRTY;
+        }
+    } else if ( hit && exclusive ) {
+        movedFlags = invalidateLine( cache, outcome.line ) & LINE_DIRTY;
+    }
+
+    if ( cache->prefetcher != NULL ) {
+        issuePrefetches( cache, address, !hit, prefetchHit );
+    }
+
+    return movedFlags;
+}
+
+/*
+ * Reads or writes size bytes of a cache level from address on, one block at a time, since an access may cross the
+ * blocks of the level. Returns the flags of the blocks moved up, see accessCacheBlock.
+ */
+uint8_t accessCacheRange( cache_t * cache, uint64_t address, bool write, uint64_t size ) {
+    uint64_t  end = address + size;
+    uint8_t   movedFlags = 0;
+
+    while ( address < end ) {
+        uint64_t blockEnd = ( address | ( cache->cacheConfig.bsize - 1 ) ) + 1;
+        uint64_t pieceEnd = blockEnd < end ? blockEnd : end;
+
+        movedFlags |= accessCacheBlock( cache, address, write, pieceEnd - address );
+
+        address = pieceEnd;
+    }
+
+    return movedFlags;
+}
+
+/*
+ * Simulates the accesses of an array of addresses in a cache hierarchy one level at a time.
+ *
+ * The addresses are split in chunks of HIERARCHY_CHUNK_SIZE. Each chunk goes through the kernel of the first level,
+ * which collects the addresses that miss in a buffer, and the buffer goes through the next level, and so on, so only
+ * the code and data of one level are in use at a time. Since each level sees the misses of the level above in the same
+ * order, the results are the same as accessing each address through all levels before the next address.
+ *
+ * Hierarchies with a prefetcher move blocks that are not misses of the level above, so their addresses go through all
+ * levels one at a time instead, as 1 byte reads.
+ */
+void accessCacheChunk( cache_t * cache, const uint32_t * addresses, size_t addressesSize ) {
+    uint32_t  buffers[ 2 ][ HIERARCHY_CHUNK_SIZE ];
+
+    if ( cache->lineTracking ) {
+        for ( size_t i = 0; i < addressesSize; i++ ) {
+            accessCacheRange( cache, addresses[ i ], false, 1 );
+        }
+
+        return;
+    }
+
+    for ( size_t offset = 0; offset < addressesSize; offset += HIERARCHY_CHUNK_SIZE ) {
+        const uint32_t *  input = addresses + offset;
+        size_t            count = addressesSize - offset < HIERARCHY_CHUNK_SIZE ? addressesSize - offset : HIERARCHY_CHUNK_SIZE;
+        unsigned int      buffer = 0;
+
+        for ( cache_t * level = cache; level != NULL && count > 0; level = level->nextLevel ) {
+            count = level->access( level, input, count, buffers[ buffer ] );
+            input = buffers[ buffer ];
+            buffer ^= 1;
+        }
+    }
+}
+
+/*
+ * Simulates the accesses of an array of 64-bit addresses in a cache hierarchy one level at a time, like
+ * accessCacheChunk.
+ */
+void accessCacheChunk64( cache_t * cache, const uint64_t * addresses, size_t addressesSize ) {
+    uint64_t  buffers[ 2 ][ HIERARCHY_CHUNK_SIZE ];
+
+    if ( cache->lineTracking ) {
+        for ( size_t i = 0; i < addressesSize; i++ ) {
+            accessCacheRange( cache, addresses[ i ], false, 1 );
+        }
+
+        return;
+    }
+
+    for ( size_t offset = 0; offset < addressesSize; offset += HIERARCHY_CHUNK_SIZE ) {
+        const uint64_t *  input = addresses + offset;
+        size_t            count = addressesSize - offset < HIERARCHY_CHUNK_SIZE ? addressesSize - offset : HIERARCHY_CHUNK_SIZE;
+        unsigned int      buffer = 0;
+
+        for ( cache_t * level = cache; level != NULL && count > 0; level = level->nextLevel ) {
+            count = level->access64( level, input, count, buffers[ buffer ] );
+            input = buffers[ buffer ];
+            buffer ^= 1;
+        }
+    }
+}
+
+/*
+ * Checks if a line of a cache level is valid, only a cache with a single set can have a valid line with the invalid
+ * tag, so its line index is its way.
+ */
+static bool isLineValid( cache_t * cache, size_t line ) {
+    return cache->tags[ line ] != INVALID_TAG || ( cache->tagsHigh != NULL && cache->tagsHigh[ line ] != INVALID_TAG )
+        || line == cache->invalidTagWay;
+}
+
+/*
+ * Counts the valid lines of a partitioned cache level filled by each tenant, into the lines of its results.
+ */
+void countTenantLines( cache_t * cache ) {
+    size_t lines = ( size_t )cache->cacheConfig.nsets * cache->cacheConfig.assoc;
+
+    for ( unsigned int tenant = 0; tenant < PARTITION_MAX_TENANTS; tenant++ ) {
+        cache->partition->results[ tenant ].lines = 0;
+    }
+
+    for ( size_t line = 0; line < lines; line++ ) {
+        if ( isLineValid( cache, line ) ) {
+            cache->partition->results[ cache->partition->owners[ line ] ].lines++;
+        }
+    }
+}
+
+/*
+ * Counts the bytes held by the valid lines of a cache level that no level above it holds, in pieces of the smallest
+ * block size of the level and the levels above. The sum over all levels is the effective capacity of the hierarchy.
+ */
+static uint64_t countUniqueBytes( cache_t * cache ) {
+    uint32_t  assoc = cache->cacheConfig.assoc;
+    size_t    lines = ( size_t )cache->cacheConfig.nsets * assoc;
+    uint32_t  bsize = cache->cacheConfig.bsize;
+    uint32_t  pieceSize = bsize;
+    uint64_t  bytes = 0;
+    bool      setPartitioned = cache->partition != NULL && cache->partition->setPartitioned;
+
+    for ( cache_t * upper = cache->upperLevel; upper != NULL; upper = upper->upperLevel ) {
+        pieceSize = upper->cacheConfig.bsize < pieceSize ? upper->cacheConfig.bsize : pieceSize;
+    }
+
+    for ( size_t line = 0; line < lines; line++ ) {
+        if ( !isLineValid( cache, line ) ) {
+            continue;
+        }
+
+        uint64_t tag = cache->tags[ line ] | ( cache->tagsHigh != NULL ? ( uint64_t )cache->tagsHigh[ line ] << 32 : 0 );
+        uint64_t address = ( tag << cache->tagShift ) | ( setPartitioned ? 0 : ( uint64_t )( line / assoc ) << cache->offsetBits );
+
+        for ( uint32_t offset = 0; offset < bsize; offset += pieceSize ) {
+            bool held = false;
+
+            for ( cache_t * upper = cache->upperLevel; upper != NULL && !held; upper = upper->upperLevel ) {
+                held = findBlockLine( upper, address + offset ) != NO_LINE;
+            }
+
+            bytes += held ? 0 : pieceSize;
+        }
     }
+
+    return bytes;
 }
 
 /*
- * Simulates the behaviour of a cache accessing an array of addresses.
+ * Copies the statistics of all cache levels to an array, from the highest to the lowest level.
  *
- * Accepts any valid number of sets, block size, and associativity for a 32-bit cache.
- * 
- * The supported replacement policies are RANDOM, LRU, and FIFO.
+ * If the hierarchy reports its inclusion, the bytes that each level holds and the levels above it don't are counted
+ * from the lines left at the end, see countUniqueBytes.
+ *
+ * The array is dynamically allocated, caller is responsible for freeing it.
  */
-result_t * simulate( uint32_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList ) {
-    cache_t *   cache = initializeCache( cacheConfigList );
+result_t * collectResults( cache_t * cache ) {
     result_t *  results;
     size_t      cacheLevels = 0;
     cache_t *   currentCache = cache;
 
-    for ( size_t i = 0; i < addressesSize; i++ ) {
-        accessCache_r( cache, addresses[ i ] );
-    }
-
     // Find the number of cache levels
     while ( currentCache != NULL ) {
         cacheLevels++;
@@ -456,12 +1752,539 @@ result_t * simulate( uint32_t * addresses, size_t addressesSize, cacheConfigList
     // Put the results from all cache levels in the results array
     while ( currentCache != NULL ) {
         results[ i ] = currentCache->result;
+
+        if ( currentCache->cacheConfig.reportInclusion ) {
+            results[ i ].uniqueBytes = countUniqueBytes( currentCache );
+        }
+
         currentCache = currentCache->nextLevel;
 
         i++;
     }
 
+    return results;
+}
+
+/*
+ * Simulates the behaviour of a cache accessing an array of addresses.
+ *
+ * Accepts any valid number of sets, block size, and associativity for a 32-bit cache.
+ * 
+ * Supports every replacement policy, see replacementPolicy_t.
+ */
+result_t * simulate( uint32_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList ) {
+    cache_t *   cache = initializeCache( cacheConfigList );
+    result_t *  results;
+
+    accessCacheChunk( cache, addresses, addressesSize );
+
+    results = collectResults( cache );
+
     destroyCache( cache );
     
     return results;
-}
\ No newline at end of file
+}
+
+/*
+ * Simulates the behaviour of a cache accessing an array of 64-bit addresses.
+ *
+ * The significant bits of the addresses are stored in addressBits of every level of the configuration first, so each
+ * level stores its tags in 32 bits if they fit. Single level directly mapped caches are simulated by
+ * simulateDirectMapping64, like simulateConfiguration does with simulateDirectMapping, so the results are the same as
+ * simulateConfiguration for addresses that fit in 32 bits. Exact miss classification is not supported.
+ */
+result_t * simulate64( uint64_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList ) {
+    uint64_t    usedBits = 0;
+    uint32_t    addressBits = 0;
+    cache_t *   cache;
+    result_t *  results;
+
+    for ( size_t i = 0; i < addressesSize; i++ ) {
+        usedBits |= addresses[ i ];
+    }
+
+    while ( addressBits < 64 && ( usedBits >> addressBits ) != 0 ) {
+        addressBits++;
+    }
+
+    for ( cacheConfigList_t * current = cacheConfigList; current != NULL; current = current->next ) {
+        current->cacheConfig.addressBits = addressBits;
+    }
+
+    if ( isDirectMapping( cacheConfigList ) ) {
+        results = malloc( sizeof( result_t ) );
+
+        if ( results == NULL ) {
+            fputs( "Sem memória.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+
+        results[ 0 ] = simulateDirectMapping64( addresses, addressesSize, cacheConfigList->cacheConfig.bsize, cacheConfigList->cacheConfig.nsets );
+
+        return results;
+    }
+
+    cache = initializeCache( cacheConfigList );
+
+    accessCacheChunk64( cache, addresses, addressesSize );
+
+    results = collectResults( cache );
+
+    destroyCache( cache );
+
+    return results;
+}
+
+/*
+ * Simulates the access of a record of a read/write trace in a cache hierarchy, see simulateRecords.
+ */
+void accessRecord( cache_t * cache, const traceRecord_t * record ) {
+    uint64_t size = record->size > 0 ? record->size : 1;
+
+    if ( size > ( UINT64_C( 1 ) << 32 ) - record->address ) {
+        size = ( UINT64_C( 1 ) << 32 ) - record->address;
+    }
+
+    accessCacheRange( cache, record->address, record->operation == TRACE_WRITE, size );
+}
+
+/*
+ * Simulates the behaviour of a cache accessing the records of a read/write trace, counting the traffic between its
+ * levels and to memory.
+ *
+ * Each record goes through the whole hierarchy before the next one, since write-backs and writes that go through a
+ * level reach the next levels out of the order of the misses. An access that crosses blocks counts as one access to
+ * each block, accesses of size 0 are taken as 1 byte long and accesses are cut at the end of the 32-bit address space.
+ * Dirty lines left in the cache at the end of the trace are not written back.
+ */
+result_t * simulateRecords( traceRecord_t * records, size_t recordsSize, cacheConfigList_t * cacheConfigList ) {
+    cache_t *   cache = initializeCache( cacheConfigList );
+    result_t *  results;
+
+    for ( size_t i = 0; i < recordsSize; i++ ) {
+        accessRecord( cache, &records[ i ] );
+    }
+
+    results = collectResults( cache );
+
+    destroyCache( cache );
+
+    return results;
+}
+
+/*
+ * Initializes a simulation that is fed addresses in chunks with simulateChunk.
+ */
+simulation_t * initializeSimulation( cacheConfigList_t * cacheConfigList ) {
+    simulation_t * simulation = malloc( sizeof( simulation_t ) );
+
+    if ( simulation == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    simulation->cache = NULL;
+    simulation->directMappedCache = NULL;
+
+    if ( isDirectMapping( cacheConfigList ) ) {
+        simulation->directMappedCache = initializeDirectMappedCache( cacheConfigList->cacheConfig.bsize, cacheConfigList->cacheConfig.nsets );
+    } else {
+        simulation->cache = initializeCache( cacheConfigList );
+    }
+
+    return simulation;
+}
+
+/*
+ * Simulates the next chunk of addresses of a simulation.
+ */
+void simulateChunk( simulation_t * simulation, uint32_t * addresses, size_t addressesSize ) {
+    if ( simulation->directMappedCache != NULL ) {
+        accessDirectMappedCache( simulation->directMappedCache, addresses, addressesSize );
+    } else {
+        accessCacheChunk( simulation->cache, addresses, addressesSize );
+    }
+}
+
+/*
+ * Copies the current statistics of all cache levels of a simulation to results, from the highest to the lowest level.
+ */
+void snapshotSimulation( simulation_t * simulation, result_t * results ) {
+    if ( simulation->directMappedCache != NULL ) {
+        results[ 0 ] = simulation->directMappedCache->result;
+
+        return;
+    }
+
+    snapshotCache( simulation->cache, results );
+}
+
+/*
+ * Copies the current statistics of all levels of a cache hierarchy to results, from the highest to the lowest level.
+ */
+void snapshotCache( cache_t * cache, result_t * results ) {
+    for ( cache_t * level = cache; level != NULL; level = level->nextLevel ) {
+        *results++ = level->result;
+    }
+}
+
+/*
+ * Adds the statistics of result to total.
+ */
+void accumulateResult( result_t * total, const result_t * result ) {
+    total->hits += result->hits;
+    total->capacityMisses += result->capacityMisses;
+    total->conflictMisses += result->conflictMisses;
+    total->compulsoryMisses += result->compulsoryMisses;
+    total->accesses += result->accesses;
+    total->writes += result->writes;
+    total->writeBacks += result->writeBacks;
+    total->bytesRead += result->bytesRead;
+    total->bytesWritten += result->bytesWritten;
+    total->prefetches += result->prefetches;
+    total->usefulPrefetches += result->usefulPrefetches;
+    total->latePrefetches += result->latePrefetches;
+    total->victimProbes += result->victimProbes;
+    total->victimHits += result->victimHits;
+    total->backInvalidations += result->backInvalidations;
+}
+
+/*
+ * Subtracts the statistics of result from total, result must be an earlier snapshot of total.
+ */
+void subtractResult( result_t * total, const result_t * result ) {
+    total->hits -= result->hits;
+    total->capacityMisses -= result->capacityMisses;
+    total->conflictMisses -= result->conflictMisses;
+    total->compulsoryMisses -= result->compulsoryMisses;
+    total->accesses -= result->accesses;
+    total->writes -= result->writes;
+    total->writeBacks -= result->writeBacks;
+    total->bytesRead -= result->bytesRead;
+    total->bytesWritten -= result->bytesWritten;
+    total->prefetches -= result->prefetches;
+    total->usefulPrefetches -= result->usefulPrefetches;
+    total->latePrefetches -= result->latePrefetches;
+    total->victimProbes -= result->victimProbes;
+    total->victimHits -= result->victimHits;
+    total->backInvalidations -= result->backInvalidations;
+}
+
+/*
+ * Destroys a simulation and returns the statistics of all its cache levels, from the highest to the lowest level.
+ *
+ * The results array is dynamically allocated, caller is responsible for freeing it.
+ */
+result_t * finishSimulation( simulation_t * simulation ) {
+    result_t * results;
+
+    if ( simulation->directMappedCache != NULL ) {
+        results = malloc( sizeof( result_t ) );
+
+        if ( results == NULL ) {
+            fputs( "Sem memória.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+
+        results[ 0 ] = simulation->directMappedCache->result;
+
+        destroyDirectMappedCache( simulation->directMappedCache );
+    } else {
+        results = collectResults( simulation->cache );
+
+        destroyCache( simulation->cache );
+    }
+
+    free( simulation );
+
+    return results;
+}
+
+/*
+ * Simulates a cache configuration accessing an array of addresses with simulateDirectMapping, simulateSetPartitioned
+ * or simulate, as appropriate for the configuration.
+ *
+ * The results array is dynamically allocated, caller is responsible for freeing it.
+ */
+result_t * simulateConfiguration( uint32_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList ) {
+    result_t * results;
+
+    if ( isDirectMapping( cacheConfigList ) ) {
+        results = malloc( sizeof( result_t ) );
+
+        if ( results == NULL ) {
+            fputs( "Sem memória.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+
+        results[ 0 ] = simulateDirectMapping( addresses, addressesSize, cacheConfigList->cacheConfig.bsize, cacheConfigList->cacheConfig.nsets );
+    } else if ( isSetPartitionable( cacheConfigList, addressesSize ) ) {
+        results = simulateSetPartitioned( addresses, addressesSize, cacheConfigList );
+    } else {
+        results = simulate( addresses, addressesSize, cacheConfigList );
+    }
+
+    return results;
+}
+
+// Marks a position of a stack distance set that holds no block
+#define STACK_POSITION_FREE UINT32_MAX
+
+/*
+ * A set of a stack distance computation.
+ *
+ * Every access to the set takes the next position of the set, and the position of the last access to each block is
+ * marked in a Fenwick tree, so the number of distinct blocks accessed since the last access to a block is the number
+ * of marks after its position. Positions are compacted when they run out, so the set uses space proportional to the
+ * number of distinct blocks it has seen.
+ */
+typedef struct _stackDistanceSet_t {
+    uint32_t *  tree;     // Fenwick tree of marks, 1-based
+    uint32_t *  owners;   // Slot of the block marked at each position, or STACK_POSITION_FREE
+    uint32_t    capacity;
+    uint32_t    next;     // Next free position
+    uint32_t    marks;
+} stackDistanceSet_t;
+
+typedef struct _stackDistanceRun_t {
+    uint32_t *                addresses;
+    size_t                    addressesSize;
+    stackDistanceProfile_t *  profiles;
+} stackDistanceRun_t;
+
+static inline void fenwickAdd( uint32_t * tree, uint32_t capacity, uint32_t position, int32_t value ) {
+    for ( uint32_t i = position + 1; i <= capacity; i += i & ( ~i + 1 ) ) {
+        tree[ i ] += ( uint32_t )value;
+    }
+}
+
+static inline uint32_t fenwickPrefix( uint32_t * tree, uint32_t position ) {
+    uint32_t sum = 0;
+
+    for ( uint32_t i = position + 1; i > 0; i -= i & ( ~i + 1 ) ) {
+        sum += tree[ i ];
+    }
+
+    return sum;
+}
+
+/*
+ * Renumbers the marked positions of a set from 0, growing the set if it's more than half full, and rebuilds its
+ * Fenwick tree in linear time.
+ *
+ * times holds the position of every slot in this set's number of sets, which is updated for the moved blocks.
+ */
+static void compactStackDistanceSet( stackDistanceSet_t * set, uint32_t * times, uint32_t stride ) {
+    uint32_t   capacity = set->capacity;
+    uint32_t   newCapacity = capacity;
+    uint32_t   position = 0;
+
+    while ( newCapacity < 16 || set->marks * 2 >= newCapacity ) {
+        newCapacity = newCapacity < 16 ? 16 : newCapacity * 2;
+    }
+
+    uint32_t * owners = malloc( sizeof( uint32_t ) * newCapacity );
+    uint32_t * tree = calloc( newCapacity + 1, sizeof( uint32_t ) );
+
+    if ( owners == NULL || tree == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( uint32_t i = 0; i < set->next; i++ ) {
+        if ( set->owners[ i ] != STACK_POSITION_FREE ) {
+            owners[ position ] = set->owners[ i ];
+            times[ ( size_t )set->owners[ i ] * stride ] = position;
+            tree[ position + 1 ] = 1;
+            position++;
+        }
+    }
+
+    for ( uint32_t i = position; i < newCapacity; i++ ) {
+        owners[ i ] = STACK_POSITION_FREE;
+    }
+
+    // Linear Fenwick tree construction, each node adds itself to its parent
+    for ( uint32_t i = 1; i <= newCapacity; i++ ) {
+        uint32_t parent = i + ( i & ( ~i + 1 ) );
+
+        if ( parent <= newCapacity ) {
+            tree[ parent ] += tree[ i ];
+        }
+    }
+
+    free( set->owners );
+    free( set->tree );
+
+    set->owners = owners;
+    set->tree = tree;
+    set->capacity = newCapacity;
+    set->next = position;
+}
+
+/*
+ * Computes the stack distance histograms of a trace for one block size, for all the numbers of sets at once.
+ */
+static void computeStackDistanceProfile( void * context, unsigned int index ) {
+    stackDistanceRun_t *      run = context;
+    stackDistanceProfile_t *  profile = &run->profiles[ index ];
+    uint32_t                  offsetBits = log2PowerOf2( profile->bsize );
+    uint32_t                  nsetsCount = profile->nsetsCount;
+    uint32_t                  maxAssoc = profile->maxAssoc;
+    stackDistanceSet_t **     sets = malloc( sizeof( stackDistanceSet_t * ) * nsetsCount );
+    uint32_t *                times = NULL; // Position of each slot for each number of sets
+    uint32_t                  slots = 0;
+    uint32_t                  allocatedSlots = 0;
+    blockMap_t                blockSlots;
+
+    if ( sets == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( uint32_t k = 0; k < nsetsCount; k++ ) {
+        sets[ k ] = calloc( ( size_t )1 << k, sizeof( stackDistanceSet_t ) );
+
+        if ( sets[ k ] == NULL ) {
+            fputs( "Sem memória.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    initializeBlockMap( &blockSlots, 1024 );
+
+    for ( size_t i = 0; i < run->addressesSize; i++ ) {
+        uint32_t    block = run->addresses[ i ] >> offsetBits;
+        uint32_t *  slot = blockMapFind( &blockSlots, block );
+        bool        cold = slot == NULL;
+        uint32_t    blockSlot;
+
+        if ( cold ) {
+            if ( slots == allocatedSlots ) {
+                allocatedSlots = allocatedSlots > 0 ? allocatedSlots * 2 : 1024;
+                times = realloc( times, sizeof( uint32_t ) * nsetsCount * ( size_t )allocatedSlots );
+
+                if ( times == NULL ) {
+                    fputs( "Sem memória.\n", stderr );
+                    exit( EXIT_FAILURE );
+                }
+            }
+
+            blockSlot = slots++;
+            blockMapInsert( &blockSlots, block, blockSlot );
+
+            profile->coldMisses++;
+        } else {
+            blockSlot = *slot;
+        }
+
+        for ( uint32_t k = 0; k < nsetsCount; k++ ) {
+            stackDistanceSet_t *  set = &sets[ k ][ block & ( ( ( uint32_t )1 << k ) - 1 ) ];
+            uint32_t *            time = &times[ ( size_t )blockSlot * nsetsCount + k ];
+
+            if ( !cold ) {
+                // Marks after the last access to the block are the distinct blocks accessed since then
+                uint32_t distance = set->marks - fenwickPrefix( set->tree, *time );
+
+                profile->histograms[ ( size_t )k * ( maxAssoc + 1 ) + ( distance < maxAssoc ? distance : maxAssoc ) ]++;
+
+                fenwickAdd( set->tree, set->capacity, *time, -1 );
+                set->owners[ *time ] = STACK_POSITION_FREE;
+                set->marks--;
+            }
+
+            if ( set->next == set->capacity ) {
+                compactStackDistanceSet( set, times + k, nsetsCount );
+            }
+
+            *time = set->next;
+            set->owners[ set->next ] = blockSlot;
+            fenwickAdd( set->tree, set->capacity, set->next, 1 );
+            set->next++;
+            set->marks++;
+        }
+    }
+
+    profile->accesses = run->addressesSize;
+
+    for ( uint32_t k = 0; k < nsetsCount; k++ ) {
+        for ( size_t j = 0; j < ( ( size_t )1 << k ); j++ ) {
+            free( sets[ k ][ j ].tree );
+            free( sets[ k ][ j ].owners );
+        }
+
+        free( sets[ k ] );
+    }
+
+    free( sets );
+    free( times );
+    destroyBlockMap( &blockSlots );
+}
+
+/*
+ * Computes LRU stack distance histograms of a trace (Mattson's stack algorithm), which give the hits of every LRU
+ * cache with a block size in bsizes, up to maxNsets sets and up to maxAssoc ways in a single pass over the trace.
+ *
+ * Each access takes O( log M ) time for each number of sets, where M is the number of distinct blocks in the set,
+ * instead of one simulation per cache size. Block sizes are computed in parallel.
+ *
+ * bsizes, maxNsets and maxAssoc must be powers of 2. The profiles array has one profile per block size and is freed
+ * with destroyStackDistanceProfiles.
+ */
+stackDistanceProfile_t * computeStackDistances( uint32_t * addresses, size_t addressesSize, uint32_t * bsizes, size_t bsizeCount, uint32_t maxNsets, uint32_t maxAssoc ) {
+    stackDistanceRun_t        run = { .addresses = addresses, .addressesSize = addressesSize };
+    stackDistanceProfile_t *  profiles = malloc( sizeof( stackDistanceProfile_t ) * ( bsizeCount > 0 ? bsizeCount : 1 ) );
+
+    if ( profiles == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( size_t i = 0; i < bsizeCount; i++ ) {
+        profiles[ i ] = ( stackDistanceProfile_t ){
+            .bsize = bsizes[ i ],
+            .maxNsets = maxNsets,
+            .maxAssoc = maxAssoc,
+            .nsetsCount = log2PowerOf2( maxNsets ) + 1,
+            .accesses = 0,
+            .coldMisses = 0
+        };
+
+        profiles[ i ].histograms = calloc( ( size_t )profiles[ i ].nsetsCount * ( maxAssoc + 1 ), sizeof( uint64_t ) );
+
+        if ( profiles[ i ].histograms == NULL ) {
+            fputs( "Sem memória.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    run.profiles = profiles;
+
+    parallelFor( ( unsigned int )bsizeCount, computeStackDistanceProfile, &run );
+
+    return profiles;
+}
+
+/*
+ * Gets the number of hits of a LRU cache with nsets sets and assoc ways from a stack distance profile.
+ *
+ * nsets and assoc must be powers of 2 up to the maximums of the profile.
+ */
+uint64_t stackDistanceHits( stackDistanceProfile_t * profile, uint32_t nsets, uint32_t assoc ) {
+    uint64_t *  histogram = &profile->histograms[ ( size_t )log2PowerOf2( nsets ) * ( profile->maxAssoc + 1 ) ];
+    uint64_t    hits = 0;
+
+    for ( uint32_t distance = 0; distance < assoc; distance++ ) {
+        hits += histogram[ distance ];
+    }
+
+    return hits;
+}
+
+void destroyStackDistanceProfiles( stackDistanceProfile_t * profiles, size_t count ) {
+    for ( size_t i = 0; i < count; i++ ) {
+        free( profiles[ i ].histograms );
+    }
+
+    free( profiles );
+}
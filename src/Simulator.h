@@ -2,58 +2,292 @@
 #define SIMULATOR_H
 
 #include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+
 #include "CacheConfig.h"
+#include "MissClassifier.h"
+#include "Prefetcher.h"
+#include "VictimCache.h"
+#include "TenantPartition.h"
+#include "HotspotProfile.h"
+#include "FirstTouch.h"
 
 typedef struct _result_t {
-    int  hits;
-    int  capacityMisses;
-    int  conflictMisses;
-    int  compulsoryMisses;
-    int  accesses;
+    uint64_t  hits;
+    uint64_t  capacityMisses;
+    uint64_t  conflictMisses;
+    uint64_t  compulsoryMisses;
+    uint64_t  accesses;
+
+    // Traffic, only counted by simulateRecords
+    uint64_t  writes;       // Accesses that write, included in accesses
+    uint64_t  writeBacks;   // Dirty lines written back to the next level when replaced
+    uint64_t  bytesRead;    // Bytes read from the next level, or from memory by the last level
+    uint64_t  bytesWritten; // Bytes written to the next level, or to memory by the last level
+
+    // Prefetching, only counted by levels with a prefetcher
+    uint64_t  prefetches;       // Blocks filled by the prefetcher, their bytes are included in bytesRead
+    uint64_t  usefulPrefetches; // Prefetched lines used by a demand access before being replaced
+    uint64_t  latePrefetches;   // Useful prefetches used less than PREFETCH_TIMELY_DISTANCE accesses after them
+
+    // Victim or miss cache, only counted by levels with one
+    uint64_t  victimProbes; // Misses of the level that looked for their block in its victim or miss cache
+    uint64_t  victimHits;   // Probes that found their block there, so the next level was not accessed
+
+    // Inclusion, only counted by hierarchies with an inclusion policy given
+    uint64_t  backInvalidations; // Lines invalidated because a level below replaced their block
+    uint64_t  uniqueBytes;       // Bytes held by the level at the end that no level above holds, see collectResults
 } result_t;
 
+enum traceOperation_t {
+    TRACE_READ = 0,
+    TRACE_WRITE = 1
+};
+
+/*
+ * An access of a read/write trace, see handleRecordFile.
+ */
+typedef struct _traceRecord_t {
+    uint32_t  address;
+    uint16_t  size;      // Bytes accessed, from address on
+    uint8_t   operation; // See traceOperation_t
+    uint8_t   reserved;
+} traceRecord_t;
+
 enum replacementPolicy_t {
     RANDOM,
     LRU,
-    FIFO
+    FIFO,
+    PLRU,   // Tree pseudo-LRU
+    NRU,    // Not recently used
+    SRRIP,  // Static re-reference interval prediction
+    BRRIP,  // Bimodal re-reference interval prediction
+    DIP     // Dynamic insertion policy, LRU and bimodal insertion chosen by set dueling
+};
+
+enum inclusionPolicy_t {
+    INCLUSION_NINE,       // Non-inclusive non-exclusive, misses fill every level and replacements only affect their level
+    INCLUSION_INCLUSIVE,  // Replacements in a level invalidate their block in the levels above it
+    INCLUSION_EXCLUSIVE   // Levels below the first only hold the victims of the level above, hits move blocks up
 };
 
-typedef struct _cacheLine_t {
-    bool          valid;
-    uint32_t      tag;
-    unsigned int  lastUsed; // For LRU
-    unsigned int  inserted; // For FIFO
-} cacheLine_t;
+// Largest re-reference prediction value of SRRIP and BRRIP, lines with it are predicted to be re-referenced last
+#define RRPV_MAX 3
+
+// One in this many insertions of the bimodal policies, BRRIP and the bimodal insertion of DIP, is not a distant one
+#define BIMODAL_THROTTLE 32
+
+// Maximum value of the DIP policy selector, the followers use bimodal insertion when it's above half of it
+#define DIP_PSEL_MAX 1023
+
+// First value of the DIP counters, bimodal insertions count down from it so they are older than any other line
+#define DIP_COUNTER_START ( UINT64_C( 1 ) << 62 )
+
+// Number of addresses that go through each level of a cache hierarchy at a time
+#define HIERARCHY_CHUNK_SIZE 1024
+
+// Tag of an invalid line, see cache_t
+#define INVALID_TAG UINT32_MAX
+
+// Line of an access that missed without filling a line, see accessOutcome_t
+#define NO_LINE SIZE_MAX
+
+// Flags of a line, see cache_t
+#define LINE_DIRTY 0x01      // Written since it was filled, its block must be written back when it is replaced
+#define LINE_PREFETCHED 0x02 // Filled by the prefetcher and not used by a demand access yet
+#define LINE_SHARED 0x04     // Other cores of a multi-core simulation may hold the block too, see MultiCore.c
+
+/*
+ * Finds the first of count ways of a set whose tag is tag, returns count if there isn't one.
+ */
+typedef uint32_t ( * findWay_t )( const uint32_t * tags, uint32_t count, uint32_t tag );
 
-typedef struct _cacheSet_t {
-    cacheLine_t * lines;
-} cacheSet_t;
+struct _cache_t;
 
+/*
+ * Accesses an array of addresses in a cache level and writes the addresses that miss to misses, returning how many
+ * missed. A kernel specialized for the replacement policy and associativity of the level.
+ */
+typedef size_t ( * accessKernel_t )( struct _cache_t * cache, const uint32_t * addresses, size_t count, uint32_t * misses );
+
+/*
+ * Accesses an array of 64-bit addresses in a cache level like accessKernel_t.
+ */
+typedef size_t ( * accessKernel64_t )( struct _cache_t * cache, const uint64_t * addresses, size_t count, uint64_t * misses );
+
+struct _accessOutcome_t;
+
+/*
+ * Accesses a single address in a cache level and describes what happened to its lines in outcome, returning whether it
+ * hit. A kernel specialized for the replacement policy of the level.
+ */
+typedef bool ( * accessLineKernel_t )( struct _cache_t * cache, uint64_t address, struct _accessOutcome_t * outcome );
+
+/*
+ * Details of an access to a cache level, for the simulations that need more than whether it hit.
+ *
+ * allocate and uncounted are set by the caller, the other fields are set by the access. allocate selects whether a
+ * miss fills a line. uncounted makes the access a fill that is not a demand access, like a prefetch or a victim moved
+ * down an exclusive hierarchy, which fills the line on a miss without being counted in the statistics and without
+ * updating the replacement state on a hit.
+ */
+typedef struct _accessOutcome_t {
+    bool      allocate;
+    bool      uncounted;
+    size_t    line;           // Index of the line hit or filled in the arrays of the cache, NO_LINE if there isn't one
+    bool      evicted;        // A valid line was replaced
+    uint64_t  evictedAddress; // Address of the first byte of the block of the replaced line
+    uint8_t   evictedFlags;   // Flags of the replaced line
+} accessOutcome_t;
+
+typedef struct _directMappedCache_t {
+    uint32_t   nsets;
+    uint32_t   offsetBits;
+    uint32_t   indexBits;
+    bool *     valid;
+    uint32_t * tags;
+    uint32_t * tagsHigh; // High halves of the tags of 64-bit addresses, only allocated by simulateDirectMapping64
+    result_t   result;
+} directMappedCache_t;
+
+/*
+ * A cache level simulated by the generic cache structure.
+ *
+ * Valid bits are folded into the tags: invalid lines have the tag INVALID_TAG, so a single compare across all ways of
+ * a set finds hits and empty lines. INVALID_TAG can only be a valid tag when tags are 32 bits wide, which only happens
+ * with a single set, so the way of the only line that can hold it is tracked separately.
+ *
+ * Tags of 64-bit addresses that don't fit in 31 bits are wide: their low halves are in tags, so ways are still found
+ * with the same search, and their high halves in tagsHigh. Invalid wide lines have both halves all ones.
+ */
 typedef struct _cache_t {   
     // Cache configuration
     cacheConfig_t      cacheConfig;
+
+    // Address decomposition, precomputed from the configuration
+    uint32_t           offsetBits;
+    uint32_t           tagShift;   // Offset and index bits
+    uint32_t           indexMask;
+    accessKernel_t     access;
+    accessKernel64_t   access64;
+    accessLineKernel_t accessLine;
     
     // Runtime parameters
     uint32_t           validLines;
     
     // Replacement policy parameters
-    unsigned int       lruCounter;
-    unsigned int       fifoCounter;
+    uint64_t           lruCounter;
+    uint64_t           fifoCounter;
+    uint64_t           lipCounter;      // Timestamp of the last DIP insertion in the LRU position
+    uint32_t           bimodalCounter;  // Insertions of the bimodal policies
+    uint32_t           policySelector;  // DIP saturating counter, incremented by misses of the LRU leader sets
+    uint64_t           randomState;     // PCG32 generator of the RANDOM policy, see nextRandom
+    uint64_t           randomIncrement;
     
     // Statistics
     result_t           result;
 
-    // Cache structure
-    cacheSet_t *       sets;
+    // Cache structure, a single arena per level laid out as structure of arrays, line i of set s is at s * assoc + i
+    void *             arena;
+    uint32_t *         tags;          // Tag of each line, INVALID_TAG if the line is invalid
+    uint32_t *         tagsHigh;      // High half of the tag of each line if the tags are wide, NULL otherwise
+    uint64_t *         timestamps;    // Last use of each line for LRU and DIP, insertion for FIFO, NULL otherwise
+    uint8_t *          policyBits;    // Replacement state of the bit based policies, NULL otherwise, see touchLine
+    uint8_t *          lineFlags;     // LINE_ flags of each line, only kept by the accesses with an outcome
+    uint32_t           invalidTagWay; // Way holding a valid line with the tag INVALID_TAG, or assoc if there isn't one
+    findWay_t          findWay;
+
+    // Exact miss classification, NULL if misses are classified by the state of the cache, only for 32-bit addresses
+    missClassifier_t * missClassifier;
+
+    // Prefetcher of the level, NULL if it has none
+    prefetcher_t *     prefetcher;
 
-    // Next level cache
+    // Victim or miss cache between the level and the next one, NULL if it has none
+    victimCache_t *    victimCache;
+
+    // Partitions of the level between tenants, NULL if it has none
+    tenantPartition_t *  partition;
+
+    // Hotspot profile of the level, owned by its configuration, NULL if it has none
+    hotspotProfile_t *   hotspots;
+
+    // Blocks accessed by the level, only kept by the levels below the first of an exclusive hierarchy, which never fill
+    // a line for a miss and lose lines to their hits, so their misses are compulsory on the first access to the block
+    // instead of when they find an empty line. NULL otherwise
+    firstTouch_t *     firstTouch;
+
+    // Whether this level or a level below it needs every access to go through all levels one at a time
+    bool               lineTracking;
+
+    // Whether the level is a whole hierarchy with an associativity of 1, whose misses are classified like
+    // simulateDirectMapping classifies them even when it has to be simulated by the generic structure
+    bool               directMapped;
+
+    // Next level cache and the level above, NULL for the first level
     struct _cache_t *  nextLevel;
+    struct _cache_t *  upperLevel;
 } cache_t;
 
+/*
+ * State of a simulation that is fed addresses in chunks.
+ *
+ * Single level caches with an associativity of 1 are simulated as directly mapped caches, other configurations are
+ * simulated by the generic cache structure.
+ */
+typedef struct _simulation_t {
+    cache_t *              cache;
+    directMappedCache_t *  directMappedCache;
+} simulation_t;
+
+/*
+ * Histograms of the LRU stack distances of a trace for a block size, for every power of 2 number of sets up to
+ * maxNsets.
+ *
+ * The stack distance of an access is the number of distinct blocks of the same set accessed since the previous access
+ * to the same block. An access hits in a LRU cache with assoc ways if and only if its stack distance is less than assoc.
+ */
+typedef struct _stackDistanceProfile_t {
+    uint32_t    bsize;
+    uint32_t    maxNsets;
+    uint32_t    maxAssoc;
+    uint32_t    nsetsCount;  // Number of histograms, log2( maxNsets ) + 1
+    uint64_t    accesses;
+    uint64_t    coldMisses;  // First accesses to a block
+    uint64_t *  histograms;  // nsetsCount histograms of maxAssoc + 1 buckets, the last for distances >= maxAssoc
+} stackDistanceProfile_t;
+
+unsigned int log2PowerOf2( unsigned int n );
 cache_t * initializeCache( cacheConfigList_t * cacheConfigList );
-void accessCache_r( cache_t * cache, uint32_t address );
+void accessCacheChunk( cache_t * cache, const uint32_t * addresses, size_t addressesSize );
+void accessCacheChunk64( cache_t * cache, const uint64_t * addresses, size_t addressesSize );
+uint8_t accessCacheRange( cache_t * cache, uint64_t address, bool write, uint64_t size );
+size_t findBlockLine( cache_t * cache, uint64_t address );
+uint8_t invalidateLine( cache_t * cache, size_t line );
+void countTenantLines( cache_t * cache );
 void destroyCache( cache_t * cache );
+result_t * collectResults( cache_t * cache );
+directMappedCache_t * initializeDirectMappedCache( uint32_t bsize, uint32_t nsets );
+void accessDirectMappedCache( directMappedCache_t * cache, uint32_t * addresses, size_t addressesSize );
+void destroyDirectMappedCache( directMappedCache_t * cache );
+bool isDirectMapping( cacheConfigList_t * cacheConfigList );
 result_t simulateDirectMapping( uint32_t * addresses, size_t addressesSize, uint32_t bsize, uint32_t nsets );
+result_t simulateDirectMapping64( uint64_t * addresses, size_t addressesSize, uint32_t bsize, uint32_t nsets );
 result_t * simulate( uint32_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList );
+result_t * simulate64( uint64_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList );
+void accessRecord( cache_t * cache, const traceRecord_t * record );
+result_t * simulateRecords( traceRecord_t * records, size_t recordsSize, cacheConfigList_t * cacheConfigList );
+simulation_t * initializeSimulation( cacheConfigList_t * cacheConfigList );
+void simulateChunk( simulation_t * simulation, uint32_t * addresses, size_t addressesSize );
+void snapshotSimulation( simulation_t * simulation, result_t * results );
+void snapshotCache( cache_t * cache, result_t * results );
+void accumulateResult( result_t * total, const result_t * result );
+void subtractResult( result_t * total, const result_t * result );
+result_t * finishSimulation( simulation_t * simulation );
+stackDistanceProfile_t * computeStackDistances( uint32_t * addresses, size_t addressesSize, uint32_t * bsizes, size_t bsizeCount, uint32_t maxNsets, uint32_t maxAssoc );
+uint64_t stackDistanceHits( stackDistanceProfile_t * profile, uint32_t nsets, uint32_t assoc );
+void destroyStackDistanceProfiles( stackDistanceProfile_t * profiles, size_t count );
+result_t * simulateConfiguration( uint32_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList );
 
 #endif
\ No newline at end of file
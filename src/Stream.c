@@ -0,0 +1,325 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#include "CacheSimulator.h"
+#include "FileHandler.h"
+#include "Simulator.h"
+#include "CacheConfig.h"
+#include "Stream.h"
+#include "IntervalStats.h"
+#include "CompressedTrace.h"
+
+/*
+ * A chunk of addresses in the stream ring buffer.
+ *
+ * A chunk with no addresses marks the end of the stream.
+ */
+typedef struct _streamChunk_t {
+    uint32_t *  addresses;
+    size_t      size;
+} streamChunk_t;
+
+/*
+ * A ring buffer of chunks shared by the reader thread, which fills the chunks, and the simulation, which consumes them.
+ */
+typedef struct _stream_t {
+    FILE *                   file;
+    char *                   filePath;
+    bool                     textFile;
+    char *                   text;       // Text read from a text file and not parsed yet, STREAM_TEXT_SIZE bytes
+    size_t                   textLength;
+    bool                     textEnded;  // The end of the file or something that is not a number was reached
+    bool                     compressedFile;
+    compressedTraceReader_t  compressedReader;
+    streamChunk_t            chunks[ STREAM_CHUNK_COUNT ];
+    size_t                   head; // Next chunk to be filled by the reader
+    size_t                   tail; // Next chunk to be consumed by the simulation
+    size_t                   filled;
+    pthread_mutex_t          mutex;
+    pthread_cond_t           notEmpty;
+    pthread_cond_t           notFull;
+} stream_t;
+
+/*
+ * Reads up to STREAM_CHUNK_SIZE 32-bit big-endian addresses from a binary file into a chunk.
+ *
+ * Returns the number of addresses read, which is only less than STREAM_CHUNK_SIZE at the end of the file.
+ */
+static size_t readBinaryChunk( stream_t * stream, uint32_t * addresses ) {
+    size_t bytesRead = fread( addresses, 1, STREAM_CHUNK_SIZE * sizeof( uint32_t ), stream->file );
+
+    if ( ferror( stream->file ) ) {
+        perror( stream->filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    // A short read only happens at the end of the file, so a partial address means the file is truncated
+    if ( bytesRead % sizeof( uint32_t ) != 0 ) {
+        fprintf( stderr, "%s: binary file is not composed of a whole number of 32-bit addressed.\n", stream->filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    bigEndianToHost( addresses, bytesRead / sizeof( uint32_t ) );
+
+    return bytesRead / sizeof( uint32_t );
+}
+
+/*
+ * Reads the addresses in base 10 or base 16 (with a "0x" prefix) of the next STREAM_TEXT_SIZE bytes of a text file
+ * into a chunk, parsed like handleTextFile parses them, so the stream has the same addresses.
+ *
+ * A number cut at the end of the text read is kept for the next chunk. Returns the number of addresses read, which is
+ * only 0 at the end of the file or at the first thing that is not a number.
+ */
+static size_t readTextChunk( stream_t * stream, uint32_t * addresses ) {
+    size_t  size = 0;
+    size_t  consumed;
+    bool    truncated;
+
+    while ( size == 0 && !stream->textEnded ) {
+        stream->textLength += fread( stream->text + stream->textLength, 1, STREAM_TEXT_SIZE - stream->textLength, stream->file );
+
+        if ( ferror( stream->file ) ) {
+            perror( stream->filePath );
+            exit( EXIT_FAILURE );
+        }
+
+        bool last = feof( stream->file ) != 0;
+
+        size = parseTextChunk( stream->text, stream->textLength, last, addresses, &consumed, &truncated );
+
+        stream->textEnded = last || truncated;
+        stream->textLength -= consumed;
+
+        memmove( stream->text, stream->text + consumed, stream->textLength );
+    }
+
+    return size;
+}
+
+/*
+ * Reader thread, fills the chunks of the ring buffer until the end of the file.
+ *
+ * Blocks while all chunks are waiting to be consumed, so the memory used is constant regardless of the size of the
+ * trace.
+ */
+static void * readStream( void * argument ) {
+    stream_t *  stream = argument;
+    size_t      size;
+
+    do {
+        pthread_mutex_lock( &stream->mutex );
+
+        while ( stream->filled == STREAM_CHUNK_COUNT ) {
+            pthread_cond_wait( &stream->notFull, &stream->mutex );
+        }
+
+        streamChunk_t * chunk = &stream->chunks[ stream->head ];
+
+        pthread_mutex_unlock( &stream->mutex );
+
+        // The chunk isn't shared until it is marked as filled, so it can be written without holding the lock
+        if ( stream->compressedFile ) {
+            size = readCompressedAddresses( &stream->compressedReader, chunk->addresses, STREAM_CHUNK_SIZE );
+        } else if ( stream->textFile ) {
+            size = readTextChunk( stream, chunk->addresses );
+        } else {
+            size = readBinaryChunk( stream, chunk->addresses );
+        }
+
+        chunk->size = size;
+
+        pthread_mutex_lock( &stream->mutex );
+
+        stream->head = ( stream->head + 1 ) % STREAM_CHUNK_COUNT;
+        stream->filled++;
+
+        pthread_cond_signal( &stream->notEmpty );
+        pthread_mutex_unlock( &stream->mutex );
+    // An empty chunk is always sent to mark the end of the stream
+    } while ( size > 0 );
+
+    return NULL;
+}
+
+/*
+ * Waits for the next filled chunk of the ring buffer.
+ */
+static streamChunk_t * acquireChunk( stream_t * stream ) {
+    pthread_mutex_lock( &stream->mutex );
+
+    while ( stream->filled == 0 ) {
+        pthread_cond_wait( &stream->notEmpty, &stream->mutex );
+    }
+
+    streamChunk_t * chunk = &stream->chunks[ stream->tail ];
+
+    pthread_mutex_unlock( &stream->mutex );
+
+    return chunk;
+}
+
+/*
+ * Gives a consumed chunk back to the reader thread.
+ */
+static void releaseChunk( stream_t * stream ) {
+    pthread_mutex_lock( &stream->mutex );
+
+    stream->tail = ( stream->tail + 1 ) % STREAM_CHUNK_COUNT;
+    stream->filled--;
+
+    pthread_cond_signal( &stream->notFull );
+    pthread_mutex_unlock( &stream->mutex );
+}
+
+/*
+ * Opens the file of a stream, STREAM_STDIN_PATH opens the standard input.
+ *
+ * Compressed traces and text files are detected like in handleFile, text files are only supported in the relaxed
+ * compliance level. Compressed traces are decoded one block at a time. The standard input is always read as a binary
+ * file.
+ */
+static void openStream( stream_t * stream, char * filePath ) {
+    stream->filePath = filePath;
+    stream->textFile = false;
+    stream->text = NULL;
+    stream->textLength = 0;
+    stream->textEnded = false;
+    stream->compressedFile = false;
+
+    if ( strcmp( filePath, STREAM_STDIN_PATH ) == 0 ) {
+        stream->filePath = "stdin";
+        stream->file = stdin;
+
+        #ifdef _WIN32
+        _setmode( _fileno( stdin ), _O_BINARY );
+        #endif
+
+        return;
+    }
+
+    #if COMPLIANCE_LEVEL < 1
+    char * extension = strrchr( filePath, '.' );
+    stream->textFile = extension != NULL && strcmp( extension, ".txt" ) == 0;
+
+    if ( stream->textFile ) {
+        stream->text = malloc( STREAM_TEXT_SIZE );
+
+        if ( stream->text == NULL ) {
+            fputs( "Sem memória.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+    }
+    #endif
+
+    stream->file = fopen( filePath, stream->textFile ? "r" : "rb" );
+
+    if ( stream->file == NULL ) {
+        perror( filePath );
+        exit( EXIT_FAILURE );
+    }
+
+    #if COMPLIANCE_LEVEL < 2
+    if ( !stream->textFile && isCompressedTrace( stream->file ) ) {
+        stream->compressedFile = true;
+
+        openCompressedTraceReader( &stream->compressedReader, stream->file, filePath );
+    }
+    #endif
+}
+
+/*
+ * Simulates the behaviour of a cache accessing the addresses of a file as they are read.
+ *
+ * The file is read by a separate thread into a fixed size ring buffer of chunks, so reading the file overlaps with the
+ * simulation and the memory used doesn't depend on the size of the file. Reading from the standard input allows traces
+ * to be piped in directly from a tracer.
+ *
+ * The results are the same as loading the whole file with handleFile and simulating it with simulate or
+ * simulateDirectMapping. If intervalStats isn't NULL the statistics of each interval are recorded in it, see
+ * simulateIntervalChunk.
+ *
+ * The results array is dynamically allocated, caller is responsible for freeing it.
+ */
+result_t * simulateStream( char * filePath, cacheConfigList_t * cacheConfigList, intervalStats_t * intervalStats ) {
+    stream_t          stream;
+    pthread_t         reader;
+    uint32_t *        buffer;
+    simulation_t *    simulation;
+    result_t *        results;
+    streamChunk_t *   chunk;
+
+    openStream( &stream, filePath );
+
+    buffer = malloc( sizeof( uint32_t ) * STREAM_CHUNK_SIZE * STREAM_CHUNK_COUNT );
+
+    if ( buffer == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( size_t i = 0; i < STREAM_CHUNK_COUNT; i++ ) {
+        stream.chunks[ i ].addresses = buffer + i * STREAM_CHUNK_SIZE;
+        stream.chunks[ i ].size = 0;
+    }
+
+    stream.head = 0;
+    stream.tail = 0;
+    stream.filled = 0;
+
+    pthread_mutex_init( &stream.mutex, NULL );
+    pthread_cond_init( &stream.notEmpty, NULL );
+    pthread_cond_init( &stream.notFull, NULL );
+
+    simulation = initializeSimulation( cacheConfigList );
+
+    if ( pthread_create( &reader, NULL, readStream, &stream ) != 0 ) {
+        fputs( "Erro: não foi possível criar a thread de leitura.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    // Consume the chunks until the empty chunk that marks the end of the stream
+    while ( ( chunk = acquireChunk( &stream ) )->size > 0 ) {
+        if ( intervalStats != NULL ) {
+            simulateIntervalChunk( simulation, intervalStats, chunk->addresses, chunk->size );
+        } else {
+            simulateChunk( simulation, chunk->addresses, chunk->size );
+        }
+
+        releaseChunk( &stream );
+    }
+
+    pthread_join( reader, NULL );
+
+    results = finishSimulation( simulation );
+
+    if ( intervalStats != NULL ) {
+        finishIntervals( intervalStats, results );
+    }
+
+    pthread_mutex_destroy( &stream.mutex );
+    pthread_cond_destroy( &stream.notEmpty );
+    pthread_cond_destroy( &stream.notFull );
+
+    if ( stream.compressedFile ) {
+        closeCompressedTraceReader( &stream.compressedReader );
+    }
+
+    if ( stream.file != stdin ) {
+        fclose( stream.file );
+    }
+
+    free( stream.text );
+    free( buffer );
+
+    return results;
+}
@@ -0,0 +1,24 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <inttypes.h>
+
+#include "CacheConfig.h"
+#include "Simulator.h"
+#include "IntervalStats.h"
+
+// Number of addresses in each chunk of the stream ring buffer
+#define STREAM_CHUNK_SIZE ( 1 << 16 )
+
+// Bytes of text read at a time from a text file, at most one address for every 2 bytes fits in a chunk
+#define STREAM_TEXT_SIZE ( 2 * STREAM_CHUNK_SIZE )
+
+// Number of chunks in the stream ring buffer
+#define STREAM_CHUNK_COUNT 8
+
+// File path that makes the stream read from the standard input
+#define STREAM_STDIN_PATH "-"
+
+result_t * simulateStream( char * filePath, cacheConfigList_t * cacheConfigList, intervalStats_t * intervalStats );
+
+#endif
@@ -0,0 +1,574 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "CacheSimulator.h"
+#include "CacheConfig.h"
+#include "Simulator.h"
+#include "FileHandler.h"
+#include "Arguments.h"
+#include "Parallel.h"
+#include "Sweep.h"
+#include "Performance.h"
+
+/*
+ * A parameter of a line of a sweep configuration file and the values it takes in the cartesian product.
+ */
+typedef struct _sweepParameter_t {
+    char **  values;
+    size_t   count;
+    char **  generated; // Values generated from ranges, owned by the parameter
+    size_t   generatedCount;
+} sweepParameter_t;
+
+typedef struct _sweepList_t {
+    sweepConfig_t *  configs;
+    size_t           count;
+    size_t           allocated;
+} sweepList_t;
+
+typedef struct _sweepRun_t {
+    sweepConfig_t *  configs;
+    size_t           configCount;
+    size_t           batchSize;
+    uint32_t *       addresses;
+    size_t           addressesSize;
+} sweepRun_t;
+
+static void * sweepAllocate( size_t size ) {
+    void * memory = malloc( size > 0 ? size : 1 );
+
+    if ( memory == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    return memory;
+}
+
+/*
+ * Adds a value to a parameter, generated values are owned by the parameter and freed with it.
+ */
+static void addParameterValue( sweepParameter_t * parameter, char * value, bool generated ) {
+    parameter->values = realloc( parameter->values, sizeof( char * ) * ( parameter->count + 1 ) );
+
+    if ( parameter->values == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    parameter->values[ parameter->count++ ] = value;
+
+    if ( generated ) {
+        parameter->generated = realloc( parameter->generated, sizeof( char * ) * ( parameter->generatedCount + 1 ) );
+
+        if ( parameter->generated == NULL ) {
+            fputs( "Sem memória.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+
+        parameter->generated[ parameter->generatedCount++ ] = value;
+    }
+}
+
+/*
+ * Expands a parameter of a sweep line into its values.
+ *
+ * Values are separated by commas, and a range <a>..<b> expands to the powers of 2 multiples of a up to b, for example
+ * 64..512 expands to 64,128,256,512. Options, which start with a dash, are never expanded. The token is modified.
+ */
+static void expandParameter( sweepParameter_t * parameter, char * token, unsigned int line ) {
+    parameter->values = NULL;
+    parameter->count = 0;
+    parameter->generated = NULL;
+    parameter->generatedCount = 0;
+
+    if ( token[ 0 ] == '-' ) {
+        addParameterValue( parameter, token, false );
+        return;
+    }
+
+    for ( char * value = strtok( token, "," ); value != NULL; value = strtok( NULL, "," ) ) {
+        char * range = strstr( value, ".." );
+
+        if ( range == NULL ) {
+            addParameterValue( parameter, value, false );
+            continue;
+        }
+
+        char *         endptr;
+        unsigned long  first = strtoul( value, &endptr, 0 );
+        unsigned long  last = strtoul( range + 2, NULL, 0 );
+
+        if ( endptr != range || first == 0 || first > last ) {
+            fprintf( stderr, "Erro: linha %u do arquivo de configurações: intervalo \"%s\" é inválido.\n", line, value );
+            exit( EXIT_FAILURE );
+        }
+
+        for ( unsigned long number = first; number <= last && number >= first; number *= 2 ) {
+            char * generated = sweepAllocate( 24 );
+
+            snprintf( generated, 24, "%lu", number );
+            addParameterValue( parameter, generated, true );
+        }
+    }
+
+    if ( parameter->count == 0 ) {
+        fprintf( stderr, "Erro: linha %u do arquivo de configurações: parâmetro vazio.\n", line );
+        exit( EXIT_FAILURE );
+    }
+}
+
+static void destroyParameter( sweepParameter_t * parameter ) {
+    for ( size_t i = 0; i < parameter->generatedCount; i++ ) {
+        free( parameter->generated[ i ] );
+    }
+
+    free( parameter->generated );
+    free( parameter->values );
+}
+
+/*
+ * Builds the cache hierarchy of one combination of the values of a sweep line and adds it to the list.
+ *
+ * The first 4 parameters are the L1 cache, like on the command line, and the rest are cache hierarchy arguments.
+ * Combinations that are not valid cache hierarchies, like a L2 cache smaller than the L1 cache, are skipped with a
+ * warning, since they are expected in cartesian products.
+ */
+static void addSweepConfig( sweepList_t * list, int argc, char * argv[], unsigned int line ) {
+    cacheConfigList_t *  cacheConfigList;
+    char                 message[ 256 ];
+    size_t               descriptionLength = 0;
+    char *               description;
+
+    cacheConfig_t cacheConfig = {
+        .nsets = ( uint32_t )parseNumberInput( argv[ 0 ], 1, 1 ),
+        .bsize = ( uint32_t )parseNumberInput( argv[ 1 ], 2, 1 ),
+        .assoc = ( uint32_t )parseNumberInput( argv[ 2 ], 3, 1 ),
+        .replacementPolicy = parseReplacementPolicy( argv[ 3 ] ),
+        .level = 1
+    };
+
+    initializeCacheConfigList( &cacheConfigList, &cacheConfig );
+
+    for ( int i = 4; i < argc; ) {
+        int taken = parseHierarchyArgument( argc, argv, i, &cacheConfigList );
+
+        if ( taken == 0 ) {
+            fprintf( stderr, "Erro: linha %u do arquivo de configurações: opção \"%s\" desconhecida.\n", line, argv[ i ] );
+            exit( EXIT_FAILURE );
+        }
+
+        i += taken;
+    }
+
+    for ( int i = 0; i < argc; i++ ) {
+        descriptionLength += strlen( argv[ i ] ) + 1;
+    }
+
+    description = sweepAllocate( descriptionLength );
+    description[ 0 ] = '\0';
+
+    for ( int i = 0; i < argc; i++ ) {
+        strcat( description, argv[ i ] );
+
+        if ( i < argc - 1 ) {
+            strcat( description, " " );
+        }
+    }
+
+    if ( !checkCacheConfig( cacheConfigList, message, sizeof( message ) ) ) {
+        fprintf( stderr, "Aviso: linha %u do arquivo de configurações: configuração \"%s\" ignorada. %s\n", line, description, message );
+
+        destroyCacheConfigList( cacheConfigList );
+        free( description );
+
+        return;
+    }
+
+    if ( list->count == list->allocated ) {
+        list->allocated = list->allocated > 0 ? list->allocated * 2 : 64;
+        list->configs = realloc( list->configs, sizeof( sweepConfig_t ) * list->allocated );
+
+        if ( list->configs == NULL ) {
+            fputs( "Sem memória.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    list->configs[ list->count++ ] = ( sweepConfig_t ){
+        .cacheConfigList = cacheConfigList,
+        .description = description,
+        .levels = countCacheLevels( cacheConfigList ),
+        .results = NULL
+    };
+}
+
+/*
+ * Parses a line of a sweep configuration file and adds the cartesian product of its values to the list.
+ */
+static void parseSweepLine( sweepList_t * list, char * text, unsigned int line ) {
+    sweepParameter_t *  parameters = NULL;
+    int                 parameterCount = 0;
+    char *              comment = strchr( text, '#' );
+
+    if ( comment != NULL ) {
+        *comment = '\0';
+    }
+
+    // Split the line in parameters first, since expanding a parameter uses strtok
+    char ** tokens = NULL;
+
+    for ( char * token = strtok( text, " \t\r\v\f" ); token != NULL; token = strtok( NULL, " \t\r\v\f" ) ) {
+        tokens = realloc( tokens, sizeof( char * ) * ( parameterCount + 1 ) );
+
+        if ( tokens == NULL ) {
+            fputs( "Sem memória.\n", stderr );
+            exit( EXIT_FAILURE );
+        }
+
+        tokens[ parameterCount++ ] = token;
+    }
+
+    // Empty lines and comments
+    if ( parameterCount == 0 ) {
+        return;
+    }
+
+    if ( parameterCount < 4 ) {
+        fprintf( stderr, "Erro: linha %u do arquivo de configurações: utilize <nsets> <bsize> <assoc> <substituição> [-l<level> <nsets> <bsize> <assoc> <substituição>]*\n", line );
+        exit( EXIT_FAILURE );
+    }
+
+    parameters = sweepAllocate( sizeof( sweepParameter_t ) * parameterCount );
+
+    for ( int i = 0; i < parameterCount; i++ ) {
+        expandParameter( &parameters[ i ], tokens[ i ], line );
+    }
+
+    // Go through the cartesian product of the values like an odometer
+    size_t *  selected = calloc( parameterCount, sizeof( size_t ) );
+    char **   argv = sweepAllocate( sizeof( char * ) * parameterCount );
+
+    if ( selected == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    while ( true ) {
+        for ( int i = 0; i < parameterCount; i++ ) {
+            argv[ i ] = parameters[ i ].values[ selected[ i ] ];
+        }
+
+        addSweepConfig( list, parameterCount, argv, line );
+
+        int i = parameterCount - 1;
+
+        while ( i >= 0 && ++selected[ i ] == parameters[ i ].count ) {
+            selected[ i ] = 0;
+            i--;
+        }
+
+        if ( i < 0 ) {
+            break;
+        }
+    }
+
+    for ( int i = 0; i < parameterCount; i++ ) {
+        destroyParameter( &parameters[ i ] );
+    }
+
+    free( selected );
+    free( argv );
+    free( parameters );
+    free( tokens );
+}
+
+/*
+ * Reads a sweep configuration file.
+ *
+ * Each line describes cache hierarchies like the command line does, <nsets> <bsize> <assoc> <substituição> followed by
+ * any cache hierarchy arguments, where every parameter may be a list of values (see expandParameter). A line adds every
+ * combination of its values. Text after a # is a comment.
+ */
+static void readSweepSpec( char * specPath, sweepList_t * list ) {
+    FILE *        file = fopen( specPath, "rb" );
+    char *        text;
+    size_t        fileSize;
+    unsigned int  line = 1;
+
+    if ( file == NULL ) {
+        perror( specPath );
+        exit( EXIT_FAILURE );
+    }
+
+    fileSize = getFileSize( file );
+    text = sweepAllocate( fileSize + 1 );
+
+    if ( fread( text, 1, fileSize, file ) < fileSize ) {
+        perror( specPath );
+        exit( EXIT_FAILURE );
+    }
+
+    text[ fileSize ] = '\0';
+
+    fclose( file );
+
+    for ( char * current = text; current != NULL; line++ ) {
+        char * newline = strchr( current, '\n' );
+
+        if ( newline != NULL ) {
+            *newline = '\0';
+        }
+
+        parseSweepLine( list, current, line );
+
+        current = newline != NULL ? newline + 1 : NULL;
+    }
+
+    free( text );
+
+    if ( list->count == 0 ) {
+        fprintf( stderr, "%s: nenhuma configuração válida.\n", specPath );
+        exit( EXIT_FAILURE );
+    }
+}
+
+/*
+ * Simulates a batch of configurations together.
+ *
+ * The trace is fed in chunks to every configuration of the batch in turn, so each chunk is read from memory once per
+ * batch and stays in the CPU cache while the configurations consume it.
+ */
+static void simulateSweepBatch( void * context, unsigned int batch ) {
+    sweepRun_t *     run = context;
+    size_t           first = ( size_t )batch * run->batchSize;
+    size_t           count = run->configCount - first < run->batchSize ? run->configCount - first : run->batchSize;
+    simulation_t *   simulations[ SWEEP_MAX_BATCH_SIZE ];
+
+    for ( size_t i = 0; i < count; i++ ) {
+        simulations[ i ] = initializeSimulation( run->configs[ first + i ].cacheConfigList );
+    }
+
+    for ( size_t offset = 0; offset < run->addressesSize; offset += SWEEP_CHUNK_SIZE ) {
+        size_t chunkSize = run->addressesSize - offset < SWEEP_CHUNK_SIZE ? run->addressesSize - offset : SWEEP_CHUNK_SIZE;
+
+        for ( size_t i = 0; i < count; i++ ) {
+            simulateChunk( simulations[ i ], run->addresses + offset, chunkSize );
+        }
+    }
+
+    for ( size_t i = 0; i < count; i++ ) {
+        run->configs[ first + i ].results = finishSimulation( simulations[ i ] );
+    }
+}
+
+/*
+ * Prints the results of a sweep as CSV, one row per configuration.
+ *
+ * Every level has the same group of columns, configurations with fewer levels than the deepest one leave the columns
+ * of the missing levels empty. If any configuration has latency or energy parameters, the stall cycles and energy of
+ * each level and the AMAT, cycles and energy of the hierarchy are added, see estimatePerformance, so configurations
+ * can be ranked by performance. If any configuration has a prefetcher, the prefetches of each level and their
+ * accuracy, coverage, timeliness and traffic are added too, see computePrefetchStatistics, empty for the levels
+ * without one. If any configuration has a victim or miss cache, its kind, entries, probes, hits and hit rate are added,
+ * empty for the levels without one. If any configuration has an inclusion policy, the back-invalidations and unique bytes of each level and
+ * the inclusion policy and effective capacity of the hierarchy are added, see collectResults, empty for the
+ * configurations without one.
+ */
+static void printSweepResults( sweepList_t * list ) {
+    unsigned long         maxLevels = 0;
+    bool                  performanceModel = false;
+    bool                  prefetching = false;
+    bool                  victimCaching = false;
+    bool                  inclusion = false;
+    levelPerformance_t *  levels;
+    performance_t         performance;
+    prefetchStatistics_t  statistics;
+
+    for ( size_t i = 0; i < list->count; i++ ) {
+        if ( list->configs[ i ].levels > maxLevels ) {
+            maxLevels = list->configs[ i ].levels;
+        }
+
+        performanceModel = performanceModel || hasPerformanceModel( list->configs[ i ].cacheConfigList );
+        prefetching = prefetching || hasPrefetcher( list->configs[ i ].cacheConfigList );
+        victimCaching = victimCaching || hasVictimCache( list->configs[ i ].cacheConfigList );
+        inclusion = inclusion || list->configs[ i ].cacheConfigList->cacheConfig.reportInclusion;
+    }
+
+    levels = sweepAllocate( sizeof( levelPerformance_t ) * maxLevels );
+
+    printf( "configuration,levels" );
+
+    const char * columns[] = { "nsets", "bsize", "assoc", "replacement", "accesses", "hits", "misses", "compulsory_misses",
+                               "capacity_misses", "conflict_misses", "hit_rate", "miss_rate" };
+    const char * performanceColumns[] = { "stall_cycles", "energy" };
+    const char * prefetchColumns[] = { "prefetcher", "prefetches", "useful_prefetches", "late_prefetches", "prefetch_accuracy",
+                                       "prefetch_coverage", "prefetch_timeliness", "prefetch_traffic" };
+    size_t       columnCount = sizeof( columns ) / sizeof( columns[ 0 ] );
+    size_t       performanceColumnCount = performanceModel ? sizeof( performanceColumns ) / sizeof( performanceColumns[ 0 ] ) : 0;
+    const char * victimColumns[] = { "victim_cache", "victim_entries", "victim_probes", "victim_hits", "victim_hit_rate" };
+    const char * inclusionColumns[] = { "back_invalidations", "unique_bytes" };
+    size_t       prefetchColumnCount = prefetching ? sizeof( prefetchColumns ) / sizeof( prefetchColumns[ 0 ] ) : 0;
+    size_t       victimColumnCount = victimCaching ? sizeof( victimColumns ) / sizeof( victimColumns[ 0 ] ) : 0;
+    size_t       inclusionColumnCount = inclusion ? sizeof( inclusionColumns ) / sizeof( inclusionColumns[ 0 ] ) : 0;
+
+    for ( unsigned long level = 1; level <= maxLevels; level++ ) {
+        for ( size_t i = 0; i < columnCount; i++ ) {
+            printf( ",L%lu_%s", level, columns[ i ] );
+        }
+
+        for ( size_t i = 0; i < performanceColumnCount; i++ ) {
+            printf( ",L%lu_%s", level, performanceColumns[ i ] );
+        }
+
+        for ( size_t i = 0; i < prefetchColumnCount; i++ ) {
+            printf( ",L%lu_%s", level, prefetchColumns[ i ] );
+        }
+
+        for ( size_t i = 0; i < victimColumnCount; i++ ) {
+            printf( ",L%lu_%s", level, victimColumns[ i ] );
+        }
+
+        for ( size_t i = 0; i < inclusionColumnCount; i++ ) {
+            printf( ",L%lu_%s", level, inclusionColumns[ i ] );
+        }
+    }
+
+    if ( performanceModel ) {
+        printf( ",amat,cycles,energy" );
+    }
+
+    if ( inclusion ) {
+        printf( ",inclusion,effective_capacity" );
+    }
+
+    printf( "\n" );
+
+    for ( size_t i = 0; i < list->count; i++ ) {
+        sweepConfig_t *      config = &list->configs[ i ];
+        cacheConfigList_t *  current = config->cacheConfigList;
+        bool                 reportInclusion = config->cacheConfigList->cacheConfig.reportInclusion;
+        uint64_t             effectiveCapacity = 0;
+
+        printf( "\"%s\",%lu", config->description, config->levels );
+
+        if ( performanceModel ) {
+            estimatePerformance( config->cacheConfigList, config->results, &performance, levels );
+        }
+
+        for ( unsigned long level = 0; level < maxLevels; level++ ) {
+            if ( current == NULL ) {
+                for ( size_t column = 0; column < columnCount + performanceColumnCount + prefetchColumnCount + victimColumnCount + inclusionColumnCount; column++ ) {
+                    putchar( ',' );
+                }
+
+                continue;
+            }
+
+            result_t * result = &config->results[ level ];
+            uint64_t   misses = result->compulsoryMisses + result->capacityMisses + result->conflictMisses;
+
+            printf( ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.6f,%.6f",
+                    current->cacheConfig.nsets, current->cacheConfig.bsize, current->cacheConfig.assoc,
+                    replacementPolicyName( current->cacheConfig.replacementPolicy ),
+                    result->accesses, result->hits, misses, result->compulsoryMisses, result->capacityMisses, result->conflictMisses,
+                    result->accesses > 0 ? ( double )result->hits / result->accesses : 0.0,
+                    result->accesses > 0 ? ( double )misses / result->accesses : 0.0 );
+
+            if ( performanceModel ) {
+                printf( ",%.2f,%.4f", levels[ level ].stallCycles, levels[ level ].energy );
+            }
+
+            if ( prefetching && current->cacheConfig.prefetcher == PREFETCH_NONE ) {
+                for ( size_t column = 0; column < prefetchColumnCount; column++ ) {
+                    putchar( ',' );
+                }
+            } else if ( prefetching ) {
+                computePrefetchStatistics( &current->cacheConfig, result, &statistics );
+
+                printf( ",%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.6f,%.6f,%.6f,%" PRIu64, prefetcherName( current->cacheConfig.prefetcher ),
+                        result->prefetches, result->usefulPrefetches, result->latePrefetches, statistics.accuracy,
+                        statistics.coverage, statistics.timeliness, statistics.traffic );
+            }
+
+            if ( victimCaching && current->cacheConfig.victimCache == VICTIM_CACHE_NONE ) {
+                for ( size_t column = 0; column < victimColumnCount; column++ ) {
+                    putchar( ',' );
+                }
+            } else if ( victimCaching ) {
+                printf( ",%s,%" PRIu32 ",%" PRIu64 ",%" PRIu64 ",%.6f", victimCacheName( current->cacheConfig.victimCache ),
+                        current->cacheConfig.victimEntries, result->victimProbes, result->victimHits,
+                        result->victimProbes > 0 ? ( double )result->victimHits / result->victimProbes : 0.0 );
+            }
+
+            if ( inclusion && !reportInclusion ) {
+                for ( size_t column = 0; column < inclusionColumnCount; column++ ) {
+                    putchar( ',' );
+                }
+            } else if ( inclusion ) {
+                printf( ",%" PRIu64 ",%" PRIu64, result->backInvalidations, result->uniqueBytes );
+
+                effectiveCapacity += result->uniqueBytes;
+            }
+
+            current = current->next;
+        }
+
+        if ( performanceModel ) {
+            printf( ",%.4f,%.2f,%.4f", performance.amat, performance.cycles, performance.energy );
+        }
+
+        if ( inclusion && !reportInclusion ) {
+            printf( ",," );
+        } else if ( inclusion ) {
+            printf( ",%s,%" PRIu64, inclusionPolicyName( config->cacheConfigList->cacheConfig.inclusionPolicy ), effectiveCapacity );
+        }
+
+        printf( "\n" );
+    }
+
+    free( levels );
+}
+
+/*
+ * Simulates every cache hierarchy of a sweep configuration file over a trace and prints one CSV row per hierarchy.
+ *
+ * The trace is loaded once and shared read only by all the configurations, which are split in batches simulated in
+ * parallel by the worker threads.
+ */
+void runSweep( char * specPath, char * tracePath ) {
+    sweepList_t   list = { .configs = NULL, .count = 0, .allocated = 0 };
+    sweepRun_t    run;
+    unsigned int  threads = getThreadCount();
+
+    readSweepSpec( specPath, &list );
+
+    handleFile( tracePath, &run.addresses, &run.addressesSize );
+
+    // Use small enough batches that all threads have work, but no more than SWEEP_MAX_BATCH_SIZE configurations
+    run.configs = list.configs;
+    run.configCount = list.count;
+    run.batchSize = ( list.count + threads - 1 ) / threads;
+
+    if ( run.batchSize > SWEEP_MAX_BATCH_SIZE ) {
+        run.batchSize = SWEEP_MAX_BATCH_SIZE;
+    }
+
+    parallelFor( ( unsigned int )( ( list.count + run.batchSize - 1 ) / run.batchSize ), simulateSweepBatch, &run );
+
+    printSweepResults( &list );
+
+    for ( size_t i = 0; i < list.count; i++ ) {
+        destroyCacheConfigList( list.configs[ i ].cacheConfigList );
+        free( list.configs[ i ].description );
+        free( list.configs[ i ].results );
+    }
+
+    free( list.configs );
+
+    releaseFile( run.addresses );
+}
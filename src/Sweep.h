@@ -0,0 +1,22 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "CacheConfig.h"
+#include "Simulator.h"
+
+// Number of addresses fed to every configuration of a batch before moving to the next chunk of the trace
+#define SWEEP_CHUNK_SIZE ( 1 << 14 )
+
+// Maximum number of configurations simulated together by a worker
+#define SWEEP_MAX_BATCH_SIZE 16
+
+typedef struct _sweepConfig_t {
+    cacheConfigList_t *  cacheConfigList;
+    char *               description;
+    unsigned long        levels;
+    result_t *           results;
+} sweepConfig_t;
+
+void runSweep( char * specPath, char * tracePath );
+
+#endif
@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "TenantPartition.h"
+
+/*
+ * Initializes the partitions of a cache level with lines lines from the masks of its configuration, with every
+ * statistic at 0 and tenant 0 accessing it.
+ */
+tenantPartition_t * initializeTenantPartition( const cacheConfig_t * cacheConfig, size_t lines ) {
+    tenantPartition_t *  partition = malloc( sizeof( tenantPartition_t ) );
+    uint32_t             groups = cacheConfig->nsets < PARTITION_SET_GROUPS ? cacheConfig->nsets : PARTITION_SET_GROUPS;
+
+    if ( partition == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    partition->tenant = 0;
+    partition->setPartitioned = false;
+    partition->groupBits = 0;
+
+    while ( ( groups << partition->groupBits ) < cacheConfig->nsets ) {
+        partition->groupBits++;
+    }
+
+    for ( unsigned int tenant = 0; tenant < PARTITION_MAX_TENANTS; tenant++ ) {
+        uint64_t  setMask = cacheConfig->setMasks[ tenant ];
+        uint8_t   allowed[ PARTITION_SET_GROUPS ];
+        uint32_t  count = 0;
+
+        partition->wayMasks[ tenant ] = cacheConfig->wayMasks[ tenant ];
+        partition->setPartitioned = partition->setPartitioned || ( setMask != 0 && groups > 1 );
+
+        for ( uint32_t group = 0; group < groups; group++ ) {
+            if ( setMask == 0 || ( setMask >> group & 1 ) != 0 ) {
+                allowed[ count++ ] = ( uint8_t )group;
+            }
+        }
+
+        // The groups of the tenant take turns, so its blocks spread evenly over them
+        for ( uint32_t group = 0; group < groups; group++ ) {
+            partition->groupMap[ tenant ][ group ] = allowed[ group % count ];
+        }
+    }
+
+    partition->owners = calloc( lines, sizeof( uint8_t ) );
+
+    if ( partition->owners == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    memset( partition->results, 0, sizeof( partition->results ) );
+
+    return partition;
+}
+
+/*
+ * Maps the set of a block to the set it takes in the groups of sets of the current tenant.
+ */
+uint32_t partitionSet( const tenantPartition_t * partition, uint32_t setIndex ) {
+    uint32_t group = setIndex >> partition->groupBits;
+
+    return ( ( uint32_t )partition->groupMap[ partition->tenant ][ group ] << partition->groupBits ) | ( setIndex & ( ( UINT32_C( 1 ) << partition->groupBits ) - 1 ) );
+}
+
+/*
+ * Frees the partitions of a cache level.
+ */
+void destroyTenantPartition( tenantPartition_t * partition ) {
+    free( partition->owners );
+    free( partition );
+}
@@ -0,0 +1,43 @@
+#ifndef TENANT_PARTITION_H
+#define TENANT_PARTITION_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "CacheConfig.h"
+
+/*
+ * Statistics of a tenant in a cache level.
+ */
+typedef struct _tenantResult_t {
+    uint64_t  accesses;
+    uint64_t  hits;
+    uint64_t  lines;    // Valid lines filled by the tenant at the end of the simulation
+} tenantResult_t;
+
+/*
+ * Way and set partitions of a cache level between tenants, the cores of a multi-core simulation, like cache allocation
+ * technology and page coloring. Simulations of a single trace have tenant 0 only.
+ *
+ * A way mask restricts the lines a tenant may fill to the ways of its bits, lookups still search every way. A set mask
+ * maps the blocks of a tenant to the groups of sets of its bits: the sets are split in up to PARTITION_SET_GROUPS
+ * groups of consecutive sets, and the group of a block is replaced by one of the groups of the mask, keeping its set
+ * within the group. Set partitioned levels keep the whole block number as the tag, since the set no longer tells the
+ * index bits of the block.
+ */
+typedef struct _tenantPartition_t {
+    unsigned int     tenant;          // Tenant of the accesses being simulated
+    uint64_t         wayMasks[ PARTITION_MAX_TENANTS ];
+    bool             setPartitioned;  // Any tenant has a set mask
+    uint32_t         groupBits;       // log2 of the sets of each group
+    uint8_t          groupMap[ PARTITION_MAX_TENANTS ][ PARTITION_SET_GROUPS ]; // Group that each group of a tenant maps to
+    uint8_t *        owners;          // Tenant that filled each line
+    tenantResult_t   results[ PARTITION_MAX_TENANTS ];
+} tenantPartition_t;
+
+tenantPartition_t * initializeTenantPartition( const cacheConfig_t * cacheConfig, size_t lines );
+uint32_t partitionSet( const tenantPartition_t * partition, uint32_t setIndex );
+void destroyTenantPartition( tenantPartition_t * partition );
+
+#endif
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "TimeParallel.h"
+#include "Simulator.h"
+#include "CacheConfig.h"
+#include "Parallel.h"
+
+/*
+ * Shared state of a time parallel simulation.
+ */
+typedef struct _timeParallel_t {
+    uint32_t *           addresses;
+    size_t               addressesSize;
+    cacheConfigList_t *  cacheConfigList;
+    unsigned long        levels;
+    unsigned int         chunkCount;
+    size_t               chunkSize;
+    size_t               warmUp;
+    size_t               sampleSize;
+    result_t *           results;            // Statistics of each chunk, chunk major
+    result_t *           approximateSamples; // Statistics of the beginning of each chunk, after its warm-up
+    result_t *           referenceSamples;   // Statistics of the beginning of each chunk, continuing the previous chunk
+} timeParallel_t;
+
+/*
+ * Simulates a chunk of the trace from an empty hierarchy, warmed up by the end of the previous chunk.
+ *
+ * Every chunk but the last keeps going after its end to simulate the beginning of the next chunk with the state of a
+ * whole chunk, which is a reference for the state the next chunk starts with after its warm-up. The difference between
+ * the two is the error sample of the boundary.
+ */
+static void simulateTimeChunk( void * context, unsigned int chunk ) {
+    timeParallel_t *  run = context;
+    size_t            begin = ( size_t )chunk * run->chunkSize;
+    size_t            end = begin + run->chunkSize < run->addressesSize ? begin + run->chunkSize : run->addressesSize;
+    size_t            next = end + run->chunkSize < run->addressesSize ? end + run->chunkSize : run->addressesSize;
+    size_t            warmUpBegin = begin > run->warmUp ? begin - run->warmUp : 0;
+    size_t            sampleSize = end - begin < run->sampleSize ? end - begin : run->sampleSize;
+    size_t            nextSampleSize = next - end < run->sampleSize ? next - end : run->sampleSize;
+    result_t *        results = &run->results[ ( size_t )chunk * run->levels ];
+    result_t *        approximateSample = &run->approximateSamples[ ( size_t )chunk * run->levels ];
+    result_t *        referenceSample = &run->referenceSamples[ ( size_t )( chunk + 1 ) * run->levels ];
+    result_t *        warmedUp = malloc( sizeof( result_t ) * run->levels );
+    simulation_t *    simulation = initializeSimulation( run->cacheConfigList );
+
+    if ( warmedUp == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    simulateChunk( simulation, run->addresses + warmUpBegin, begin - warmUpBegin );
+    snapshotSimulation( simulation, warmedUp );
+
+    simulateChunk( simulation, run->addresses + begin, sampleSize );
+    snapshotSimulation( simulation, approximateSample );
+
+    simulateChunk( simulation, run->addresses + begin + sampleSize, end - begin - sampleSize );
+    snapshotSimulation( simulation, results );
+
+    if ( chunk + 1 < run->chunkCount ) {
+        simulateChunk( simulation, run->addresses + end, nextSampleSize );
+        snapshotSimulation( simulation, referenceSample );
+    }
+
+    free( finishSimulation( simulation ) );
+
+    for ( unsigned long level = 0; level < run->levels; level++ ) {
+        if ( chunk + 1 < run->chunkCount ) {
+            subtractResult( &referenceSample[ level ], &results[ level ] );
+        }
+
+        subtractResult( &results[ level ], &warmedUp[ level ] );
+        subtractResult( &approximateSample[ level ], &warmedUp[ level ] );
+    }
+
+    free( warmedUp );
+}
+
+static int64_t countMisses( const result_t * result ) {
+    return ( int64_t )( result->compulsoryMisses + result->capacityMisses + result->conflictMisses );
+}
+
+/*
+ * Simulates a cache hierarchy accessing an array of addresses approximately, with the trace split in contiguous chunks
+ * simulated in parallel, one per thread.
+ *
+ * Each chunk is simulated from an empty hierarchy, which is first warmed up by up to warmUp addresses at the end of the
+ * previous chunk without counting their statistics, and the statistics of all chunks are summed. The lines left empty
+ * or with a different content than in a sequential simulation at the beginning of each chunk make the results
+ * approximate.
+ *
+ * The error comes from the beginning of the chunks, so the relative error of the number of misses of each level is
+ * estimated by simulating the beginning of each chunk both after its warm-up and as a continuation of the previous
+ * chunk. errorEstimates has one estimate per level.
+ *
+ * The results array is dynamically allocated, caller is responsible for freeing it.
+ */
+result_t * simulateTimeParallel( uint32_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList, size_t warmUp, double * errorEstimates ) {
+    timeParallel_t  run;
+    unsigned int    chunkCount = getThreadCount();
+    result_t *      results;
+
+    if ( ( size_t )chunkCount > addressesSize ) {
+        chunkCount = addressesSize > 0 ? ( unsigned int )addressesSize : 1;
+    }
+
+    run.addresses = addresses;
+    run.addressesSize = addressesSize;
+    run.cacheConfigList = cacheConfigList;
+    run.levels = countCacheLevels( cacheConfigList );
+    run.chunkSize = ( addressesSize + chunkCount - 1 ) / chunkCount;
+
+    // Rounding the chunk size up may leave the last threads without addresses, as with 100 addresses and 16 threads
+    if ( run.chunkSize > 0 ) {
+        chunkCount = ( unsigned int )( ( addressesSize + run.chunkSize - 1 ) / run.chunkSize );
+    }
+
+    run.chunkCount = chunkCount;
+    run.warmUp = warmUp;
+
+    // The sample must cover the warm-up of the next chunk and a part of the chunk that is worth its extra cost
+    run.sampleSize = run.chunkSize / TIME_PARALLEL_SAMPLE_FRACTION;
+
+    if ( run.sampleSize < warmUp ) {
+        run.sampleSize = warmUp;
+    }
+
+    if ( run.sampleSize < TIME_PARALLEL_MIN_SAMPLE_SIZE ) {
+        run.sampleSize = TIME_PARALLEL_MIN_SAMPLE_SIZE;
+    }
+
+    run.results = malloc( sizeof( result_t ) * chunkCount * run.levels );
+    run.approximateSamples = malloc( sizeof( result_t ) * chunkCount * run.levels );
+    run.referenceSamples = malloc( sizeof( result_t ) * ( chunkCount + 1 ) * run.levels );
+    results = calloc( run.levels, sizeof( result_t ) );
+
+    if ( run.results == NULL || run.approximateSamples == NULL || run.referenceSamples == NULL || results == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    parallelFor( chunkCount, simulateTimeChunk, &run );
+
+    for ( unsigned int chunk = 0; chunk < chunkCount; chunk++ ) {
+        for ( unsigned long level = 0; level < run.levels; level++ ) {
+            accumulateResult( &results[ level ], &run.results[ ( size_t )chunk * run.levels + level ] );
+        }
+    }
+
+    for ( unsigned long level = 0; level < run.levels; level++ ) {
+        int64_t difference = 0;
+
+        // The first chunk starts from an empty hierarchy in a sequential simulation too
+        for ( unsigned int chunk = 1; chunk < chunkCount; chunk++ ) {
+            int64_t chunkDifference = countMisses( &run.approximateSamples[ ( size_t )chunk * run.levels + level ] )
+                                    - countMisses( &run.referenceSamples[ ( size_t )chunk * run.levels + level ] );
+
+            difference += chunkDifference;
+        }
+
+        // The error is relative to the number of misses without it, which is the best estimate of the exact number
+        int64_t corrected = countMisses( &results[ level ] ) - difference;
+
+        errorEstimates[ level ] = corrected > 0 ? ( double )( difference < 0 ? -difference : difference ) / corrected : 0.0;
+    }
+
+    free( run.results );
+    free( run.approximateSamples );
+    free( run.referenceSamples );
+
+    return results;
+}
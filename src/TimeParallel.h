@@ -0,0 +1,18 @@
+#ifndef TIME_PARALLEL_H
+#define TIME_PARALLEL_H
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#include "CacheConfig.h"
+#include "Simulator.h"
+
+// Minimum number of accesses at the beginning of each chunk simulated twice to estimate the error
+#define TIME_PARALLEL_MIN_SAMPLE_SIZE ( 1 << 16 )
+
+// Fraction of each chunk simulated twice to estimate the error, if it's more than the minimum and the warm-up
+#define TIME_PARALLEL_SAMPLE_FRACTION 16
+
+result_t * simulateTimeParallel( uint32_t * addresses, size_t addressesSize, cacheConfigList_t * cacheConfigList, size_t warmUp, double * errorEstimates );
+
+#endif
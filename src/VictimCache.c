@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "VictimCache.h"
+
+/*
+ * Initializes an empty victim or miss cache with a number of entries.
+ */
+victimCache_t * initializeVictimCache( int kind, uint32_t entries ) {
+    victimCache_t * victimCache = malloc( sizeof( victimCache_t ) );
+
+    if ( victimCache == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    victimCache->kind = kind;
+    victimCache->entries = entries;
+    victimCache->used = 0;
+    victimCache->clock = 0;
+    victimCache->blocks = malloc( sizeof( uint64_t ) * entries );
+    victimCache->lastUse = malloc( sizeof( uint64_t ) * entries );
+    victimCache->flags = malloc( sizeof( uint8_t ) * entries );
+
+    if ( victimCache->blocks == NULL || victimCache->lastUse == NULL || victimCache->flags == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    return victimCache;
+}
+
+/*
+ * Finds the entry of a victim or miss cache that holds a block, returns VICTIM_CACHE_NO_ENTRY if there isn't one.
+ */
+uint32_t findVictimEntry( victimCache_t * victimCache, uint64_t block ) {
+    for ( uint32_t i = 0; i < victimCache->used; i++ ) {
+        if ( victimCache->blocks[ i ] == block ) {
+            return i;
+        }
+    }
+
+    return VICTIM_CACHE_NO_ENTRY;
+}
+
+/*
+ * Removes an entry of a victim or miss cache, returning its flags. The last valid entry takes its place.
+ */
+uint8_t removeVictimEntry( victimCache_t * victimCache, uint32_t entry ) {
+    uint8_t   flags = victimCache->flags[ entry ];
+    uint32_t  last = --victimCache->used;
+
+    victimCache->blocks[ entry ] = victimCache->blocks[ last ];
+    victimCache->lastUse[ entry ] = victimCache->lastUse[ last ];
+    victimCache->flags[ entry ] = victimCache->flags[ last ];
+
+    return flags;
+}
+
+/*
+ * Makes an entry of a victim or miss cache the most recently used one.
+ */
+void touchVictimEntry( victimCache_t * victimCache, uint32_t entry ) {
+    victimCache->lastUse[ entry ] = ++victimCache->clock;
+}
+
+/*
+ * Inserts a block in a victim or miss cache as its most recently used entry, replacing the least recently used entry
+ * if all are valid. Returns whether an entry was replaced, in which case its block and flags are written to
+ * droppedBlock and droppedFlags, unless they are NULL.
+ */
+bool insertVictimEntry( victimCache_t * victimCache, uint64_t block, uint8_t flags, uint64_t * droppedBlock, uint8_t * droppedFlags ) {
+    uint32_t  entry = victimCache->used;
+    bool      dropped = entry == victimCache->entries;
+
+    if ( dropped ) {
+        entry = 0;
+
+        for ( uint32_t i = 1; i < victimCache->entries; i++ ) {
+            if ( victimCache->lastUse[ i ] < victimCache->lastUse[ entry ] ) {
+                entry = i;
+            }
+        }
+
+        if ( droppedBlock != NULL ) {
+            *droppedBlock = victimCache->blocks[ entry ];
+            *droppedFlags = victimCache->flags[ entry ];
+        }
+    } else {
+        victimCache->used++;
+    }
+
+    victimCache->blocks[ entry ] = block;
+    victimCache->flags[ entry ] = flags;
+
+    touchVictimEntry( victimCache, entry );
+
+    return dropped;
+}
+
+/*
+ * Gets the name that selects a kind of victim cache in the --victim option.
+ */
+const char * victimCacheName( int kind ) {
+    switch ( kind ) {
+        case VICTIM_CACHE:
+            return "VICTIM";
+        case MISS_CACHE:
+            return "MISS";
+        default:
+            return "NONE";
+    }
+}
+
+/*
+ * Destroys a victim or miss cache.
+ */
+void destroyVictimCache( victimCache_t * victimCache ) {
+    free( victimCache->blocks );
+    free( victimCache->lastUse );
+    free( victimCache->flags );
+    free( victimCache );
+}
@@ -0,0 +1,42 @@
+#ifndef VICTIM_CACHE_H
+#define VICTIM_CACHE_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Largest number of entries of a victim or miss cache, they are searched linearly
+#define VICTIM_CACHE_MAX_ENTRIES 256
+
+// Entry index returned when a block is not in a victim or miss cache
+#define VICTIM_CACHE_NO_ENTRY UINT32_MAX
+
+enum victimCacheKind_t {
+    VICTIM_CACHE_NONE,
+    VICTIM_CACHE,  // Holds the lines replaced in its level, a hit swaps the block with the victim of the level
+    MISS_CACHE     // Holds a copy of the blocks filled by the misses of its level, a hit fills the level from it
+};
+
+/*
+ * A small fully associative LRU buffer between a cache level and the next level. Blocks are the addresses of their
+ * first byte, their flags are the LINE_ flags of the lines they come from or go to.
+ */
+typedef struct _victimCache_t {
+    int         kind;
+    uint32_t    entries;
+    uint32_t    used;      // Valid entries, always the first ones
+    uint64_t    clock;     // Last use of an entry, for LRU
+    uint64_t *  blocks;
+    uint64_t *  lastUse;
+    uint8_t *   flags;
+} victimCache_t;
+
+victimCache_t * initializeVictimCache( int kind, uint32_t entries );
+uint32_t findVictimEntry( victimCache_t * victimCache, uint64_t block );
+uint8_t removeVictimEntry( victimCache_t * victimCache, uint32_t entry );
+void touchVictimEntry( victimCache_t * victimCache, uint32_t entry );
+bool insertVictimEntry( victimCache_t * victimCache, uint64_t block, uint8_t flags, uint64_t * droppedBlock, uint8_t * droppedFlags );
+const char * victimCacheName( int kind );
+void destroyVictimCache( victimCache_t * victimCache );
+
+#endif
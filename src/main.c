@@ -6,34 +6,105 @@
 #include <string.h>
 #include <errno.h>
 #include <assert.h>
-#include <time.h>
 
 #include "CacheSimulator.h"
 #include "FileHandler.h"
 #include "Simulator.h"
 #include "CacheConfig.h"
+#include "Stream.h"
+#include "Parallel.h"
+#include "CompressedTrace.h"
+#include "Arguments.h"
+#include "Sweep.h"
+#include "TimeParallel.h"
+#include "SeedRuns.h"
+#include "Performance.h"
+#include "MultiCore.h"
+#include "IntervalStats.h"
+#include "HotspotProfile.h"
 
 enum outFlag_t {
     FREEFORM_OUT = 0,
     STANDARDIZED_OUT = 1
 };
 
-void           printOutput( result_t * results, unsigned long cacheLevels, int flagOut );
-unsigned long  parseNumberInput( char * input, int index, int level );
-int            parseReplacementPolicy( char * subst );
-unsigned long  parseCacheLevelSpecifier( char * input );
+void           printOutput( result_t * results, unsigned long cacheLevels, int flagOut, bool traffic );
+void           printLevelOutput( result_t * result, unsigned long level, int flagOut, bool traffic );
+void           printPerformance( cacheConfigList_t * cacheConfigList, result_t * results, unsigned long cacheLevels, int flagOut );
+void           printPrefetch( cacheConfigList_t * cacheConfigList, result_t * results, int flagOut );
+void           printVictimCache( cacheConfigList_t * cacheConfigList, result_t * results, int flagOut );
+void           printInclusion( cacheConfigList_t * cacheConfigList, result_t * results, int flagOut );
+void           printHotspots( cacheConfigList_t * cacheConfigList, int flagOut );
+void           printMultiCore( multiCoreResult_t * result, int protocol, int interleaving, int flagOut );
+void           printSeedSummary( seedSummary_t * summaries, unsigned long cacheLevels, unsigned int seedCount, int flagOut );
+int            convertTrace( int argc, char * argv[] );
+int            missRatioCurve( int argc, char * argv[] );
 
 int main( int argc, char *argv[] ) {
-    // Seed the random number generator
-    srand( time( NULL ) );
-    
     // Quote the executable path if it has spaces
     char * quote = strchr( argv[ 0 ], ' ' ) == NULL ? "" : "\"";
+
+    #if COMPLIANCE_LEVEL < 2
+    // Trace conversion mode
+    if ( argc >= 2 && strcmp( argv[ 1 ], "--convert" ) == 0 ) {
+        if ( argc != 4 ) {
+            fprintf( stderr, "Número de argumentos incorreto. Utilize:\n"
+                             "%s%s%s --convert <arquivo_de_entrada> <arquivo_de_saída>\n", quote, argv[ 0 ], quote );
+            exit( EXIT_FAILURE );
+        }
+
+        return convertTrace( argc, argv );
+    }
+
+    // Sweep mode
+    if ( argc >= 2 && strcmp( argv[ 1 ], "--sweep" ) == 0 ) {
+        if ( argc < 4 ) {
+            fprintf( stderr, "Número de argumentos incorreto. Utilize:\n"
+                             "%s%s%s --sweep <arquivo_de_configurações> <arquivo_de_entrada> [--threads <n>]\n", quote, argv[ 0 ], quote );
+            exit( EXIT_FAILURE );
+        }
+
+        for ( int i = 4; i < argc; i += 2 ) {
+            if ( strcmp( argv[ i ], "--threads" ) == 0 ) {
+                requireOptionArguments( argc, argv, i, 1, "<n>" );
+                setThreadCount( ( unsigned int )parseOptionNumber( argv[ i ], argv[ i + 1 ] ) );
+            } else {
+                fprintf( stderr, "Erro: opção \"%s\" desconhecida.\n", argv[ i ] );
+                exit( EXIT_FAILURE );
+            }
+        }
+
+        runSweep( argv[ 2 ], argv[ 3 ] );
+
+        return 0;
+    }
+
+    // Miss ratio curve mode
+    if ( argc >= 2 && strcmp( argv[ 1 ], "--mrc" ) == 0 ) {
+        if ( argc < 6 ) {
+            fprintf( stderr, "Número de argumentos incorreto. Utilize:\n"
+                             "%s%s%s --mrc <bsizes> <nsets_máximo> <assoc_máximo> <arquivo_de_entrada> [--threads <n>]\n", quote, argv[ 0 ], quote );
+            exit( EXIT_FAILURE );
+        }
+
+        for ( int i = 6; i < argc; i += 2 ) {
+            if ( strcmp( argv[ i ], "--threads" ) == 0 ) {
+                requireOptionArguments( argc, argv, i, 1, "<n>" );
+                setThreadCount( ( unsigned int )parseOptionNumber( argv[ i ], argv[ i + 1 ] ) );
+            } else {
+                fprintf( stderr, "Erro: opção \"%s\" desconhecida.\n", argv[ i ] );
+                exit( EXIT_FAILURE );
+            }
+        }
+
+        return missRatioCurve( argc, argv );
+    }
+    #endif
     
     #if COMPLIANCE_LEVEL < 2
     if ( argc < 7 ) {
         fprintf( stderr, "Número de argumentos incorreto. Utilize:\n"
-                         "%s%s%s <nsets> <bsize> <assoc> <substituição> <flag_saída> <arquivo_de_entrada> [-l<level> <nsets> <bsize> <assoc> <substituição>]*\n", quote, argv[ 0 ], quote );
+                         "%s%s%s <nsets> <bsize> <assoc> <substituição> <flag_saída> <arquivo_de_entrada> [-l<level> <nsets> <bsize> <assoc> <substituição>]* [--3c] [--seed <semente>] [--write <nível> <WB|WT> <WA|NWA>] [--timing <nível> <latência> <penalidade> <energia>] [--memory <latência> <energia>] [--prefetch <nível> <NEXT|STRIDE|STREAM> <grau> <distância>] [--victim <nível> <VICTIM|MISS> <entradas>] [--inclusion <NINE|INCLUSIVE|EXCLUSIVE>] [--partition <nível> <núcleo> <WAYS|SETS> <máscara>]* [--seeds <k>] [--64] [--rw] [--core <arquivo>]* [--coherence <MESI|MOESI>] [--interleave <RR|TIME>] [--interval <acessos> <CSV|BIN> <arquivo>] [--hotspots <nível> <k>] [--stream] [--threads <n>] [--time-parallel <aquecimento>]\n", quote, argv[ 0 ], quote );
         exit( EXIT_FAILURE );
     }
     #else
@@ -54,69 +125,462 @@ int main( int argc, char *argv[] ) {
     uint32_t *           addresses;
     size_t               size;
     result_t *           results;
-    unsigned long        cacheLevel;
     cacheConfig_t        cacheConfig = { .nsets = nsets, .bsize = bsize, .assoc = assoc, .replacementPolicy = parseReplacementPolicy( substString ), .level = 1 };
     cacheConfigList_t *  cacheConfigList;
-    unsigned long        numberOfCacheLevels = 1;
+    unsigned long        numberOfCacheLevels;
+    bool                 stream = false;
+    bool                 timeParallel = false;
+    size_t               warmUp = 0;
+    unsigned int         seedCount = 0;
+    bool                 wideAddresses = false;
+    bool                 readWrite = false;
+    bool                 multiCore = false;
+    char *               coreTraces[ MULTI_CORE_MAX_CORES ] = { arquivoEntrada };
+    unsigned int         coreCount = 1;
+    int                  coherenceProtocol = COHERENCE_MESI;
+    int                  interleaving = INTERLEAVE_ROUND_ROBIN;
+    uint64_t             intervalLength = 0;
+    int                  intervalFormat = INTERVAL_CSV;
+    char *               intervalPath = NULL;
+    intervalStats_t *    intervalStats = NULL;
+    bool                 hotspots = false;
     
     initializeCacheConfigList( &cacheConfigList, &cacheConfig );
 
     #if COMPLIANCE_LEVEL < 2
-    // Get lower cache levels
-    for ( int i = 7; i < argc; i += 5 ) {
-        if ( argv[ i ][ 0 ] == '-' && argv[ i ][ 1 ] == 'l' ) {
-            cacheLevel = parseCacheLevelSpecifier( argv[ i ] );
-
-            if ( argc < i + 5 ) {
-                argv[ i ][ 1 ] -= 32; // Make the L uppercase to print the level correctly
-                fprintf( stderr, "Número de argumentos incorreto na cache %s. Utilize:\n"
-                                 "[-l<level> <nsets> <bsize> <assoc> <substituição>]\n", argv[ i ] + 1 );
+    // Get lower cache levels and options
+    for ( int i = 7; i < argc; ) {
+        int taken = parseHierarchyArgument( argc, argv, i, &cacheConfigList );
+
+        if ( taken > 0 ) {
+            i += taken;
+        } else if ( strcmp( argv[ i ], "--stream" ) == 0 ) {
+            stream = true;
+
+            i++;
+        } else if ( strcmp( argv[ i ], "--threads" ) == 0 ) {
+            requireOptionArguments( argc, argv, i, 1, "<n>" );
+            setThreadCount( ( unsigned int )parseOptionNumber( argv[ i ], argv[ i + 1 ] ) );
+
+            i += 2;
+        } else if ( strcmp( argv[ i ], "--time-parallel" ) == 0 ) {
+            requireOptionArguments( argc, argv, i, 1, "<aquecimento>" );
+            warmUp = ( size_t )parseOptionNumber( argv[ i ], argv[ i + 1 ] );
+            timeParallel = true;
+
+            i += 2;
+        } else if ( strcmp( argv[ i ], "--64" ) == 0 ) {
+            wideAddresses = true;
+
+            i++;
+        } else if ( strcmp( argv[ i ], "--rw" ) == 0 ) {
+            readWrite = true;
+
+            i++;
+        } else if ( strcmp( argv[ i ], "--core" ) == 0 ) {
+            requireOptionArguments( argc, argv, i, 1, "<arquivo>" );
+
+            if ( coreCount == MULTI_CORE_MAX_CORES ) {
+                fprintf( stderr, "Erro: a simulação multi-core suporta no máximo %d núcleos.\n", MULTI_CORE_MAX_CORES );
                 exit( EXIT_FAILURE );
             }
 
-            nsets = ( uint32_t )parseNumberInput( argv[ i + 1 ], 1, cacheLevel );
-            bsize = ( uint32_t )parseNumberInput( argv[ i + 2 ], 2, cacheLevel );
-            assoc = ( uint32_t )parseNumberInput( argv[ i + 3 ], 3, cacheLevel );
-            substString = argv[ i + 4 ];
+            coreTraces[ coreCount++ ] = argv[ i + 1 ];
+            multiCore = true;
+
+            i += 2;
+        } else if ( strcmp( argv[ i ], "--coherence" ) == 0 ) {
+            requireOptionArguments( argc, argv, i, 1, "<MESI|MOESI>" );
+            coherenceProtocol = -1;
+
+            for ( int candidate = COHERENCE_MESI; candidate <= COHERENCE_MOESI; candidate++ ) {
+                if ( strcmp( argv[ i + 1 ], coherenceProtocolName( candidate ) ) == 0 ) {
+                    coherenceProtocol = candidate;
+                }
+            }
+
+            if ( coherenceProtocol < 0 ) {
+                fprintf( stderr, "Erro: protocolo de coerência \"%s\" não é suportado, utilize MESI ou MOESI.\n", argv[ i + 1 ] );
+                exit( EXIT_FAILURE );
+            }
 
-            cacheConfig = ( cacheConfig_t ){ .nsets = nsets, .bsize = bsize, .assoc = assoc, .replacementPolicy = parseReplacementPolicy( substString ), .level = cacheLevel };
+            multiCore = true;
 
-            pushCacheConfig( &cacheConfigList, &cacheConfig );
+            i += 2;
+        } else if ( strcmp( argv[ i ], "--interleave" ) == 0 ) {
+            requireOptionArguments( argc, argv, i, 1, "<RR|TIME>" );
+            interleaving = -1;
 
-            numberOfCacheLevels++;
+            for ( int candidate = INTERLEAVE_ROUND_ROBIN; candidate <= INTERLEAVE_TIMESTAMP; candidate++ ) {
+                if ( strcmp( argv[ i + 1 ], interleavingName( candidate ) ) == 0 ) {
+                    interleaving = candidate;
+                }
+            }
+
+            if ( interleaving < 0 ) {
+                fprintf( stderr, "Erro: intercalação \"%s\" não é suportada, utilize RR ou TIME.\n", argv[ i + 1 ] );
+                exit( EXIT_FAILURE );
+            }
+
+            multiCore = true;
+
+            i += 2;
+        } else if ( strcmp( argv[ i ], "--interval" ) == 0 ) {
+            requireOptionArguments( argc, argv, i, 3, "<acessos> <CSV|BIN> <arquivo>" );
+            intervalLength = parseOptionNumber( argv[ i ], argv[ i + 1 ] );
+            intervalFormat = -1;
+            intervalPath = argv[ i + 3 ];
+
+            if ( intervalLength == 0 ) {
+                fputs( "Erro: os intervalos da opção --interval precisam ter pelo menos 1 acesso.\n", stderr );
+                exit( EXIT_FAILURE );
+            }
+
+            for ( int candidate = INTERVAL_CSV; candidate <= INTERVAL_BINARY; candidate++ ) {
+                if ( strcmp( argv[ i + 2 ], intervalFormatName( candidate ) ) == 0 ) {
+                    intervalFormat = candidate;
+                }
+            }
+
+            if ( intervalFormat < 0 ) {
+                fprintf( stderr, "Erro: formato \"%s\" não é suportado, utilize CSV ou BIN.\n", argv[ i + 2 ] );
+                exit( EXIT_FAILURE );
+            }
+
+            i += 4;
+        } else if ( strcmp( argv[ i ], "--hotspots" ) == 0 ) {
+            requireOptionArguments( argc, argv, i, 2, "<nível> <k>" );
+
+            cacheConfig_t * levelConfig = findCacheLevel( cacheConfigList, argv[ i ], argv[ i + 1 ] );
+            unsigned long   top = parseOptionNumber( argv[ i ], argv[ i + 2 ] );
+
+            if ( top == 0 || top > HOTSPOT_MAX_TOP ) {
+                fprintf( stderr, "Erro: o número de blocos da opção --hotspots deve estar entre 1 e %d.\n", HOTSPOT_MAX_TOP );
+                exit( EXIT_FAILURE );
+            }
+
+            levelConfig->hotspotTop = ( uint32_t )top;
+            hotspots = true;
+
+            i += 3;
+        } else if ( strcmp( argv[ i ], "--seeds" ) == 0 ) {
+            requireOptionArguments( argc, argv, i, 1, "<k>" );
+            seedCount = ( unsigned int )parseOptionNumber( argv[ i ], argv[ i + 1 ] );
+
+            if ( seedCount < 2 ) {
+                fputs( "Erro: a opção --seeds precisa de pelo menos 2 sementes.\n", stderr );
+                exit( EXIT_FAILURE );
+            }
+
+            i += 2;
+        } else {
+            fprintf( stderr, "Erro: opção \"%s\" desconhecida.\n", argv[ i ] );
+            exit( EXIT_FAILURE );
         }
     }
-    #else
-    // Avoid unused variable warnings on very strict compliance level, where cache levels are not supported
-    ( void )cacheLevel;
     #endif
 
     verifyCacheConfig( cacheConfigList );
+
+    if ( stream && timeParallel ) {
+        fputs( "Erro: as opções --stream e --time-parallel não podem ser usadas juntas.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( seedCount > 0 && ( stream || timeParallel ) ) {
+        fputs( "Erro: a opção --seeds não pode ser usada com --stream ou --time-parallel.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( wideAddresses && ( stream || timeParallel || seedCount > 0 || cacheConfigList->cacheConfig.exactMissClassification ) ) {
+        fputs( "Erro: a opção --64 não pode ser usada com --stream, --time-parallel, --seeds ou --3c.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( timeParallel && cacheConfigList->cacheConfig.reportInclusion ) {
+        fputs( "Erro: as opções --time-parallel e --inclusion não podem ser usadas juntas.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( readWrite && ( wideAddresses || stream || timeParallel || seedCount > 0 ) ) {
+        fputs( "Erro: a opção --rw não pode ser usada com --64, --stream, --time-parallel ou --seeds.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( multiCore && ( wideAddresses || stream || timeParallel || seedCount > 0 ) ) {
+        fputs( "Erro: as opções --core, --coherence e --interleave não podem ser usadas com --64, --stream, --time-parallel ou --seeds.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( intervalPath != NULL && ( wideAddresses || timeParallel || seedCount > 0 || multiCore ) ) {
+        fputs( "Erro: a opção --interval não pode ser usada com --64, --time-parallel, --seeds ou a simulação multi-core.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( hotspots && ( timeParallel || seedCount > 0 || multiCore ) ) {
+        fputs( "Erro: a opção --hotspots não pode ser usada com --time-parallel, --seeds ou a simulação multi-core.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    numberOfCacheLevels = countCacheLevels( cacheConfigList );
+
+    initializeHotspotProfiles( cacheConfigList );
+
+    if ( multiCore ) {
+        checkMultiCoreConfig( cacheConfigList );
+
+        multiCoreResult_t * multiCoreResult = simulateMultiCore( coreTraces, coreCount, cacheConfigList, coherenceProtocol, interleaving );
+
+        printMultiCore( multiCoreResult, coherenceProtocol, interleaving, flagOut );
+
+        destroyMultiCoreResult( multiCoreResult );
+        destroyCacheConfigList( cacheConfigList );
+
+        return 0;
+    }
+
+    if ( readWrite ) {
+        traceRecord_t * records;
+
+        handleRecordFile( arquivoEntrada, &records, &size );
+
+        if ( intervalPath != NULL ) {
+            intervalStats = initializeIntervalStats( intervalLength, numberOfCacheLevels, size );
+            results = simulateRecordIntervals( records, size, cacheConfigList, intervalStats );
+        } else {
+            results = simulateRecords( records, size, cacheConfigList );
+        }
+
+        printOutput( results, numberOfCacheLevels, flagOut, true );
+        printPerformance( cacheConfigList, results, numberOfCacheLevels, flagOut );
+        printPrefetch( cacheConfigList, results, flagOut );
+        printVictimCache( cacheConfigList, results, flagOut );
+        printInclusion( cacheConfigList, results, flagOut );
+        printHotspots( cacheConfigList, flagOut );
+
+        if ( intervalStats != NULL ) {
+            writeIntervalStats( intervalStats, cacheConfigList, true, intervalFormat, intervalPath );
+            destroyIntervalStats( intervalStats );
+        }
+
+        releaseFile( records );
+        destroyCacheConfigList( cacheConfigList );
+        free( results );
+
+        return 0;
+    }
+
+    if ( wideAddresses ) {
+        uint64_t * addresses64;
+
+        handleFile64( arquivoEntrada, &addresses64, &size );
+
+        results = simulate64( addresses64, size, cacheConfigList );
+
+        printOutput( results, numberOfCacheLevels, flagOut, false );
+        printPerformance( cacheConfigList, results, numberOfCacheLevels, flagOut );
+        printPrefetch( cacheConfigList, results, flagOut );
+        printVictimCache( cacheConfigList, results, flagOut );
+        printInclusion( cacheConfigList, results, flagOut );
+        printHotspots( cacheConfigList, flagOut );
+
+        releaseFile( addresses64 );
+        destroyCacheConfigList( cacheConfigList );
+        free( results );
+
+        return 0;
+    }
     
+    if ( stream ) {
+        if ( intervalPath != NULL ) {
+            intervalStats = initializeIntervalStats( intervalLength, numberOfCacheLevels, 0 );
+        }
+
+        results = simulateStream( arquivoEntrada, cacheConfigList, intervalStats );
+
+        printOutput( results, numberOfCacheLevels, flagOut, false );
+        printPerformance( cacheConfigList, results, numberOfCacheLevels, flagOut );
+        printPrefetch( cacheConfigList, results, flagOut );
+        printVictimCache( cacheConfigList, results, flagOut );
+        printInclusion( cacheConfigList, results, flagOut );
+        printHotspots( cacheConfigList, flagOut );
+
+        if ( intervalStats != NULL ) {
+            writeIntervalStats( intervalStats, cacheConfigList, false, intervalFormat, intervalPath );
+            destroyIntervalStats( intervalStats );
+        }
+
+        destroyCacheConfigList( cacheConfigList );
+        free( results );
+
+        return 0;
+    }
+
     handleFile( arquivoEntrada, &addresses, &size );
 
-    if ( assoc == 1 && cacheConfigList->next == NULL ) {
-        results = malloc( sizeof( result_t ) );
+    if ( seedCount > 0 ) {
+        seedSummary_t * summaries = simulateSeeds( addresses, size, cacheConfigList, seedCount );
+
+        printSeedSummary( summaries, numberOfCacheLevels, seedCount, flagOut );
+
+        releaseFile( addresses );
+        destroyCacheConfigList( cacheConfigList );
+        free( summaries );
+
+        return 0;
+    }
+
+    if ( timeParallel ) {
+        double * errorEstimates = malloc( sizeof( double ) * numberOfCacheLevels );
 
-        if ( results == NULL ) {
+        if ( errorEstimates == NULL ) {
             fputs( "Sem memória.\n", stderr );
             exit( EXIT_FAILURE );
-        }   
+        }
+
+        results = simulateTimeParallel( addresses, size, cacheConfigList, warmUp, errorEstimates );
+
+        printOutput( results, numberOfCacheLevels, flagOut, false );
+        printPerformance( cacheConfigList, results, numberOfCacheLevels, flagOut );
+        printPrefetch( cacheConfigList, results, flagOut );
+        printVictimCache( cacheConfigList, results, flagOut );
+
+        // The estimate goes to stderr so the output format doesn't change
+        fflush( stdout );
+
+        for ( unsigned long i = 0; i < numberOfCacheLevels; i++ ) {
+            fprintf( stderr, "Erro relativo estimado das falhas de L%lu: %.4f%%\n", i + 1, errorEstimates[ i ] * 100 );
+        }
+
+        free( errorEstimates );
+    } else if ( intervalPath != NULL ) {
+        intervalStats = initializeIntervalStats( intervalLength, numberOfCacheLevels, size );
+        results = simulateIntervals( addresses, size, cacheConfigList, intervalStats );
+
+        printOutput( results, numberOfCacheLevels, flagOut, false );
+        printPerformance( cacheConfigList, results, numberOfCacheLevels, flagOut );
+        printPrefetch( cacheConfigList, results, flagOut );
+        printVictimCache( cacheConfigList, results, flagOut );
+        printInclusion( cacheConfigList, results, flagOut );
+        printHotspots( cacheConfigList, flagOut );
 
-        results[ 0 ] = simulateDirectMapping( addresses, size, cacheConfigList->cacheConfig.bsize, cacheConfigList->cacheConfig.nsets );
+        writeIntervalStats( intervalStats, cacheConfigList, false, intervalFormat, intervalPath );
+        destroyIntervalStats( intervalStats );
     } else {
-        results = simulate( addresses, size, cacheConfigList );
-    }
+        results = simulateConfiguration( addresses, size, cacheConfigList );
 
-    printOutput( results, numberOfCacheLevels, flagOut );
+        printOutput( results, numberOfCacheLevels, flagOut, false );
+        printPerformance( cacheConfigList, results, numberOfCacheLevels, flagOut );
+        printPrefetch( cacheConfigList, results, flagOut );
+        printVictimCache( cacheConfigList, results, flagOut );
+        printInclusion( cacheConfigList, results, flagOut );
+        printHotspots( cacheConfigList, flagOut );
+    }
 
-    free( addresses );
+    releaseFile( addresses );
     destroyCacheConfigList( cacheConfigList );
     free( results );
 
     return 0;
 }
 
+/*
+ * Converts a binary, text or compressed trace to a compressed trace.
+ *
+ * Text files are detected by the .txt extension regardless of the compliance level, since conversion is an additional
+ * feature itself.
+ */
+int convertTrace( int argc, char * argv[] ) {
+    char *      inputPath = argv[ 2 ];
+    char *      outputPath = argv[ 3 ];
+    char *      extension = strrchr( inputPath, '.' );
+    uint32_t *  addresses;
+    size_t      size;
+
+    ( void )argc;
+
+    if ( isCompressedFile( inputPath ) ) {
+        handleCompressedFile( inputPath, &addresses, &size );
+    } else if ( extension != NULL && strcmp( extension, ".txt" ) == 0 ) {
+        handleTextFile( inputPath, &addresses, &size );
+    } else {
+        handleBinaryFile( inputPath, &addresses, &size );
+    }
+
+    writeCompressedTrace( outputPath, addresses, size );
+
+    releaseFile( addresses );
+
+    return 0;
+}
+
+/*
+ * Prints the miss ratio curves of LRU caches for every block size in a comma separated list and every power of 2
+ * number of sets and associativity up to the given maximums as CSV, with one line per configuration.
+ *
+ * All the configurations are computed from the stack distances of a single pass over the trace.
+ */
+int missRatioCurve( int argc, char * argv[] ) {
+    uint32_t *                bsizes = malloc( sizeof( uint32_t ) * ( strlen( argv[ 2 ] ) / 2 + 1 ) );
+    size_t                    bsizeCount = 0;
+    uint32_t                  maxNsets = ( uint32_t )parseOptionNumber( "--mrc", argv[ 3 ] );
+    uint32_t                  maxAssoc = ( uint32_t )parseOptionNumber( "--mrc", argv[ 4 ] );
+    uint32_t *                addresses;
+    size_t                    size;
+    stackDistanceProfile_t *  profiles;
+
+    ( void )argc;
+
+    if ( bsizes == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    for ( char * value = strtok( argv[ 2 ], "," ); value != NULL; value = strtok( NULL, "," ) ) {
+        bsizes[ bsizeCount++ ] = ( uint32_t )parseOptionNumber( "--mrc", value );
+    }
+
+    for ( size_t i = 0; i <= bsizeCount; i++ ) {
+        uint32_t value = i < bsizeCount ? bsizes[ i ] : maxNsets;
+
+        if ( value == 0 || ( value & ( value - 1 ) ) != 0 ) {
+            fprintf( stderr, "Erro: %" PRIu32 " não é uma potência de 2.\n", value );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    if ( bsizeCount == 0 || maxAssoc == 0 || ( maxAssoc & ( maxAssoc - 1 ) ) != 0 ) {
+        fputs( "Erro: a associatividade máxima deve ser uma potência de 2.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    handleFile( argv[ 5 ], &addresses, &size );
+
+    profiles = computeStackDistances( addresses, size, bsizes, bsizeCount, maxNsets, maxAssoc );
+
+    puts( "bsize,nsets,assoc,size,accesses,hits,misses,miss_rate,compulsory_misses" );
+
+    for ( size_t i = 0; i < bsizeCount; i++ ) {
+        for ( uint32_t nsets = 1; nsets <= maxNsets; nsets *= 2 ) {
+            for ( uint32_t assoc = 1; assoc <= maxAssoc; assoc *= 2 ) {
+                uint64_t hits = stackDistanceHits( &profiles[ i ], nsets, assoc );
+
+                printf( "%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.6f,%" PRIu64 "\n",
+                        bsizes[ i ], nsets, assoc, ( uint64_t )bsizes[ i ] * nsets * assoc, profiles[ i ].accesses, hits,
+                        profiles[ i ].accesses - hits,
+                        profiles[ i ].accesses > 0 ? ( double )( profiles[ i ].accesses - hits ) / profiles[ i ].accesses : 0.0,
+                        profiles[ i ].coldMisses );
+            }
+        }
+    }
+
+    destroyStackDistanceProfiles( profiles, bsizeCount );
+    releaseFile( addresses );
+    free( bsizes );
+
+    return 0;
+}
+
 /*
  * This function prints the output of the simulation.
  *
@@ -125,164 +589,436 @@ int main( int argc, char *argv[] ) {
  * The freeform format is a human-readable format that prints the results in a more verbose way.
  * 
  * The standardized format is a machine-readable format that prints the results in a more concise way defined by the specification.
+ *
+ * If traffic is set, the writes, write-backs and bytes moved to and from the next level, or memory for the last level,
+ * are printed too, after the other statistics of each level.
  */
-void printOutput( result_t * results, unsigned long cacheLevels, int flagOut ) {
-    float  hitRate;
-    int    totalMisses;
-    float  missRate;
-    float  compulsoryMissRate;
-    float  capacityMissRate;
-    float  conflictMissRate;
-    
+void printOutput( result_t * results, unsigned long cacheLevels, int flagOut, bool traffic ) {
     for ( unsigned long i = 0; i < cacheLevels; i++ ) {
-        hitRate = ( ( float )results[ i ].hits / results[ i ].accesses );
-        totalMisses = results[ i ].capacityMisses + results[ i ].conflictMisses + results[ i ].compulsoryMisses;
-        missRate = ( ( float ) totalMisses / results[ i ].accesses );
-        compulsoryMissRate = ( ( float )results[ i ].compulsoryMisses / totalMisses );
-        capacityMissRate = ( ( float )results[ i ].capacityMisses / totalMisses );
-        conflictMissRate = ( ( float )results[ i ].conflictMisses / totalMisses );
-        
+        printLevelOutput( &results[ i ], i + 1, flagOut, traffic );
+    }
+}
+
+/*
+ * This function prints the output of a single level of the simulation, numbered level, like printOutput.
+ */
+void printLevelOutput( result_t * result, unsigned long level, int flagOut, bool traffic ) {
+    float     hitRate = ( ( float )result->hits / result->accesses );
+    uint64_t  totalMisses = result->capacityMisses + result->conflictMisses + result->compulsoryMisses;
+    float     missRate = ( ( float ) totalMisses / result->accesses );
+    float     compulsoryMissRate = ( ( float )result->compulsoryMisses / totalMisses );
+    float     capacityMissRate = ( ( float )result->capacityMisses / totalMisses );
+    float     conflictMissRate = ( ( float )result->conflictMisses / totalMisses );
+
+    if ( flagOut == FREEFORM_OUT ) {
+        printf( "========== L%lu ==========\n"
+                "Hits: %" PRIu64 "\n"
+                "Misses: %" PRIu64 "\n"
+                "Accesses: %" PRIu64 "\n"
+                "Compulsory Misses: %" PRIu64 "\n"
+                "Capacity Misses: %" PRIu64 "\n"
+                "Conflict Misses: %" PRIu64 "\n"
+                "Hit rate: %f\n"
+                "Miss rate: %f\n"
+                "Compulsory miss rate: %f\n"
+                "Capacity miss rate: %f\n"
+                "Conflict miss rate: %f\n",
+                level,
+                result->hits,
+                totalMisses,
+                result->accesses,
+                result->compulsoryMisses,
+                result->capacityMisses,
+                result->conflictMisses,
+                hitRate,
+                missRate,
+                compulsoryMissRate,
+                capacityMissRate,
+                conflictMissRate );
+
+        if ( traffic ) {
+            printf( "Writes: %" PRIu64 "\n"
+                    "Write-backs: %" PRIu64 "\n"
+                    "Bytes read: %" PRIu64 "\n"
+                    "Bytes written: %" PRIu64 "\n",
+                    result->writes,
+                    result->writeBacks,
+                    result->bytesRead,
+                    result->bytesWritten );
+        }
+    } else if ( traffic ) {
+        printf( "%" PRIu64 ", %.4f, %.4f, %.2f, %.2f, %.2f, %" PRIu64 ", %" PRIu64 ", %" PRIu64 ", %" PRIu64 "\n", result->accesses, hitRate, missRate,
+                compulsoryMissRate, capacityMissRate, conflictMissRate, result->writes, result->writeBacks, result->bytesRead, result->bytesWritten );
+    } else {
+        printf( "%" PRIu64 ", %.4f, %.4f, %.2f, %.2f, %.2f\n", result->accesses, hitRate, missRate, compulsoryMissRate, capacityMissRate, conflictMissRate );
+    }
+}
+
+/*
+ * This function prints the estimated performance of a simulation, if any latency or energy parameter was given.
+ *
+ * The freeform format prints the stall cycles and energy of each level followed by the totals of the hierarchy. The
+ * standardized format prints a single line with the AMAT, the total cycles, the total energy and the stall cycles of
+ * each level. See estimatePerformance.
+ */
+void printPerformance( cacheConfigList_t * cacheConfigList, result_t * results, unsigned long cacheLevels, int flagOut ) {
+    performance_t         performance;
+    levelPerformance_t *  levels;
+
+    if ( !hasPerformanceModel( cacheConfigList ) ) {
+        return;
+    }
+
+    levels = malloc( sizeof( levelPerformance_t ) * cacheLevels );
+
+    if ( levels == NULL ) {
+        fputs( "Sem memória.\n", stderr );
+        exit( EXIT_FAILURE );
+    }
+
+    estimatePerformance( cacheConfigList, results, &performance, levels );
+
+    if ( flagOut == FREEFORM_OUT ) {
+        puts( "========== Performance ==========" );
+
+        for ( unsigned long i = 0; i < cacheLevels; i++ ) {
+            printf( "L%lu stall cycles: %.2f\n"
+                    "L%lu energy: %.4f nJ\n",
+                    i + 1, levels[ i ].stallCycles,
+                    i + 1, levels[ i ].energy );
+        }
+
+        printf( "Memory energy: %.4f nJ\n"
+                "AMAT: %.4f cycles\n"
+                "Total cycles: %.2f\n"
+                "Total energy: %.4f nJ\n",
+                performance.memoryEnergy,
+                performance.amat,
+                performance.cycles,
+                performance.energy );
+    } else {
+        printf( "%.4f, %.2f, %.4f", performance.amat, performance.cycles, performance.energy );
+
+        for ( unsigned long i = 0; i < cacheLevels; i++ ) {
+            printf( ", %.2f", levels[ i ].stallCycles );
+        }
+
+        printf( "\n" );
+    }
+
+    free( levels );
+}
+
+/*
+ * This function prints the effectiveness of the prefetchers of a simulation, for the levels that have one.
+ *
+ * The freeform format prints the prefetches of each level and their accuracy, coverage, timeliness and traffic. The
+ * standardized format prints one line per level with a prefetcher with the level, the prefetches, the useful and late
+ * prefetches, the accuracy, the coverage, the timeliness and the traffic in bytes. See computePrefetchStatistics.
+ */
+void printPrefetch( cacheConfigList_t * cacheConfigList, result_t * results, int flagOut ) {
+    prefetchStatistics_t  statistics;
+    unsigned long         i = 0;
+
+    for ( cacheConfigList_t * current = cacheConfigList; current != NULL; current = current->next, i++ ) {
+        cacheConfig_t * cacheConfig = &current->cacheConfig;
+
+        if ( cacheConfig->prefetcher == PREFETCH_NONE ) {
+            continue;
+        }
+
+        computePrefetchStatistics( cacheConfig, &results[ i ], &statistics );
+
         if ( flagOut == FREEFORM_OUT ) {
-                printf( "========== L%lu ==========\n"
-                        "Hits: %d\n"
-                        "Misses: %d\n"
-                        "Accesses: %d\n"
-                        "Compulsory Misses: %d\n"
-                        "Capacity Misses: %d\n"
-                        "Conflict Misses: %d\n"
-                        "Hit rate: %f\n"
-                        "Miss rate: %f\n"
-                        "Compulsory miss rate: %f\n"
-                        "Capacity miss rate: %f\n"
-                        "Conflict miss rate: %f\n",
-                        i + 1,
-                        results[ i ].hits,
-                        totalMisses,
-                        results[ i ].accesses,
-                        results[ i ].compulsoryMisses,
-                        results[ i ].capacityMisses,
-                        results[ i ].conflictMisses,
-                        hitRate,
-                        missRate,
-                        compulsoryMissRate,
-                        capacityMissRate,
-                        conflictMissRate );
+            printf( "========== L%lu Prefetch ==========\n"
+                    "Prefetcher: %s (degree %" PRIu32 ", distance %" PRIu32 ")\n"
+                    "Prefetches: %" PRIu64 "\n"
+                    "Useful prefetches: %" PRIu64 "\n"
+                    "Late prefetches: %" PRIu64 "\n"
+                    "Accuracy: %f\n"
+                    "Coverage: %f\n"
+                    "Timeliness: %f\n"
+                    "Prefetch traffic: %" PRIu64 " bytes\n",
+                    i + 1,
+                    prefetcherName( cacheConfig->prefetcher ), cacheConfig->prefetchDegree, cacheConfig->prefetchDistance,
+                    results[ i ].prefetches,
+                    results[ i ].usefulPrefetches,
+                    results[ i ].latePrefetches,
+                    statistics.accuracy,
+                    statistics.coverage,
+                    statistics.timeliness,
+                    statistics.traffic );
         } else {
-            printf( "%d, %.4f, %.4f, %.2f, %.2f, %.2f\n", results[ i ].accesses, hitRate, missRate, compulsoryMissRate, capacityMissRate, conflictMissRate );
+            printf( "%lu, %" PRIu64 ", %" PRIu64 ", %" PRIu64 ", %.4f, %.4f, %.4f, %" PRIu64 "\n", i + 1, results[ i ].prefetches,
+                    results[ i ].usefulPrefetches, results[ i ].latePrefetches, statistics.accuracy, statistics.coverage,
+                    statistics.timeliness, statistics.traffic );
         }
     }
 }
 
-/* This function parses number parameters with and error checking.
- * 
- * It will use the strtoul function to parse the input string.
- * 
- * The strtoul function is considered safe to parse user-provided strings, as it will do error and security checks.
- * 
- * The strtoul function will automatically handle hexadecimal and octal numbers if the input string starts with "0x" or
- * "0" respectively (and binary ("0b") if the program is compiled with C2x).
+/*
+ * This function prints the statistics of the victim and miss caches of a simulation, for the levels that have one.
+ *
+ * The freeform format prints the probes and hits of the victim or miss cache of each level and the misses left for the
+ * next level. The standardized format prints one line per level with a victim or miss cache with the level, the
+ * probes, the hits and the hit rate.
  */
-unsigned long parseNumberInput( char * input, int index, int level ) {
-    unsigned long  number;
-    char *         endptr;
-    const char *   args[] = { NULL, "<nsets>", "<bsize>", "<assoc>", "<substituição>", "<flag_saída>", "<arquivo_de_entrada>" };
+void printVictimCache( cacheConfigList_t * cacheConfigList, result_t * results, int flagOut ) {
+    unsigned long i = 0;
 
-    static_assert( sizeof( unsigned long ) >= sizeof( uint32_t ), "An unsigned long isn't a least 32 bits that allow any acceptable parameter values parameters to be taken. Consider using unsigned long long instead." );
-    static_assert( ERANGE != 0, "ERANGE (range-related errors) is 0, that means it will always report an error when parsing the number input, since it checks if errno is ERANGE and errno is set to 0 before the string handling that could cause the error to ensure a previous error is not caught inadvertently. A solution is to set the errno to some other value, but that may cause problems elsewhere." );
+    for ( cacheConfigList_t * current = cacheConfigList; current != NULL; current = current->next, i++ ) {
+        cacheConfig_t *  cacheConfig = &current->cacheConfig;
+        result_t *       result = &results[ i ];
 
-    errno = 0;
+        if ( cacheConfig->victimCache == VICTIM_CACHE_NONE ) {
+            continue;
+        }
 
-    #if COMPLIANCE_LEVEL < 2
-    if ( strlen( input ) >= 2 ) {
-        // Binary
-        if ( input[ 0 ] == '0' && ( input[ 1 ] == 'b' || input[ 1 ] == 'B' ) ) {
-            number = strtoul( input + 2, &endptr, 2 );
-        // Octal with prefix "0o"
-        } else if ( input[ 0 ] == '0' && ( input[ 1 ] == 'o' || input[ 1 ] == 'O' ) ) {
-            number = strtoul( input + 2, &endptr, 8 );
-        // Hexadecimal
-        } else if ( input[ 0 ] == '0' && ( input[ 1 ] == 'x' || input[ 1 ] == 'X' ) ) {
-            number = strtoul( input + 2, &endptr, 16 );
+        double hitRate = result->victimProbes > 0 ? ( double )result->victimHits / result->victimProbes : 0.0;
+
+        if ( flagOut == FREEFORM_OUT ) {
+            printf( "========== L%lu Victim Cache ==========\n"
+                    "Type: %s (%" PRIu32 " entries)\n"
+                    "Probes: %" PRIu64 "\n"
+                    "Hits: %" PRIu64 "\n"
+                    "Hit rate: %f\n"
+                    "Misses to the next level: %" PRIu64 "\n",
+                    i + 1,
+                    victimCacheName( cacheConfig->victimCache ), cacheConfig->victimEntries,
+                    result->victimProbes,
+                    result->victimHits,
+                    hitRate,
+                    result->compulsoryMisses + result->capacityMisses + result->conflictMisses - result->victimHits );
         } else {
-            #if COMPLIANCE_LEVEL < 1
-            // Accept 0 as octal prefix
-            number = strtoul( input, &endptr, 0 );
-            #else
-            // Accept only decimals if a prefix is not present
-            number = strtoul( input, &endptr, 10 );
-            #endif
+            printf( "%lu, %" PRIu64 ", %" PRIu64 ", %.4f\n", i + 1, result->victimProbes, result->victimHits, hitRate );
         }
+    }
+}
+
+/*
+ * This function prints the inclusion of a simulation, if an inclusion policy was given.
+ *
+ * The freeform format prints the back-invalidations and the unique bytes of each level, see collectResults, followed
+ * by the effective capacity of the hierarchy, the sum of the unique bytes, and its total capacity. The standardized
+ * format prints a single line with the effective capacity, the total capacity and the back-invalidations of each level.
+ */
+void printInclusion( cacheConfigList_t * cacheConfigList, result_t * results, int flagOut ) {
+    uint64_t       effectiveCapacity = 0;
+    uint64_t       totalCapacity = 0;
+    unsigned long  i = 0;
+
+    if ( !cacheConfigList->cacheConfig.reportInclusion ) {
+        return;
+    }
+
+    for ( cacheConfigList_t * current = cacheConfigList; current != NULL; current = current->next, i++ ) {
+        effectiveCapacity += results[ i ].uniqueBytes;
+        totalCapacity += ( uint64_t )current->cacheConfig.nsets * current->cacheConfig.bsize * current->cacheConfig.assoc;
+    }
+
+    if ( flagOut == FREEFORM_OUT ) {
+        printf( "========== Inclusion ==========\n"
+                "Policy: %s\n", inclusionPolicyName( cacheConfigList->cacheConfig.inclusionPolicy ) );
+
+        for ( unsigned long level = 0; level < i; level++ ) {
+            printf( "L%lu back-invalidations: %" PRIu64 "\n"
+                    "L%lu unique bytes: %" PRIu64 "\n",
+                    level + 1, results[ level ].backInvalidations,
+                    level + 1, results[ level ].uniqueBytes );
+        }
+
+        printf( "Effective capacity: %" PRIu64 " bytes\n"
+                "Total capacity: %" PRIu64 " bytes\n",
+                effectiveCapacity,
+                totalCapacity );
     } else {
-        #if COMPLIANCE_LEVEL < 1
-        // Accept 0 as octal prefix
-        number = strtoul( input, &endptr, 0 );
-        #else
-        // Do not accept a single 0 as an octal prefix
-        number = strtoul( input, &endptr, 10 );
-        #endif
+        printf( "%" PRIu64 ", %" PRIu64, effectiveCapacity, totalCapacity );
+
+        for ( unsigned long level = 0; level < i; level++ ) {
+            printf( ", %" PRIu64, results[ level ].backInvalidations );
+        }
+
+        printf( "\n" );
     }
-    #else
-    // Only decimals allowed in very strict compliance level
-    number = strtoul( input, &endptr, 10 );
-    #endif
-    
-    if ( *endptr != '\0' || endptr == input || errno == ERANGE ) {
-        if ( level != 0 ) {
-            fprintf( stderr, "Erro: argumento \"%s\" no parâmetro %s da cache L%d não é um número válido ou aceitável.\n", input, args[ index ], level );
-            exit( EXIT_FAILURE );
-        } else {
-            fprintf( stderr, "Erro: argumento \"%s\" no parâmetro %s não é um número válido ou aceitável.\n", input, args[ index ] );
-            exit( EXIT_FAILURE );
+}
+
+/*
+ * This function prints the hotspot profile of each level that has one, see hotspotProfile_t.
+ *
+ * The freeform format prints the hits, misses and evictions of each set followed by the most missed blocks with their
+ * estimated misses, from the most missed. The standardized format prints a line with the level, the set, the hits, the
+ * misses and the evictions of each set, followed by a line with the level, the address and the estimated misses of
+ * each block.
+ */
+void printHotspots( cacheConfigList_t * cacheConfigList, int flagOut ) {
+    for ( cacheConfigList_t * current = cacheConfigList; current != NULL; current = current->next ) {
+        hotspotProfile_t *  profile = current->cacheConfig.hotspots;
+        unsigned long       level = current->cacheConfig.level;
+
+        if ( profile == NULL ) {
+            continue;
+        }
+
+        sortHotspotBlocks( profile );
+
+        if ( flagOut == FREEFORM_OUT ) {
+            printf( "========== L%lu Sets ==========\n", level );
+        }
+
+        for ( uint32_t set = 0; set < profile->nsets; set++ ) {
+            hotspotSet_t * counts = &profile->sets[ set ];
+
+            if ( flagOut == FREEFORM_OUT ) {
+                printf( "Set %" PRIu32 ": %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " evictions\n", set, counts->hits, counts->misses,
+                        counts->evictions );
+            } else {
+                printf( "%lu, %" PRIu32 ", %" PRIu64 ", %" PRIu64 ", %" PRIu64 "\n", level, set, counts->hits, counts->misses, counts->evictions );
+            }
+        }
+
+        if ( flagOut == FREEFORM_OUT ) {
+            printf( "========== L%lu Most Missed Blocks ==========\n", level );
+        }
+
+        for ( uint32_t i = 0; i < profile->count; i++ ) {
+            uint64_t address = profile->heap[ i ].block << profile->offsetBits;
+
+            if ( flagOut == FREEFORM_OUT ) {
+                printf( "0x%08" PRIx64 ": %" PRIu64 " misses (estimated)\n", address, profile->heap[ i ].misses );
+            } else {
+                printf( "%lu, 0x%08" PRIx64 ", %" PRIu64 "\n", level, address, profile->heap[ i ].misses );
+            }
         }
     }
-    
-    return number;
 }
 
 /*
- * Parses a cache level specifier argument string and returns the corresponding cache level number.
+ * This function prints the output of a multi-core simulation.
+ *
+ * The freeform format prints, for each core, its coherence statistics followed by its private levels like printOutput
+ * with the traffic, and then the protocol, the totals of the coherence statistics and the shared level. The
+ * standardized format prints, for each core, a line with the core, the records, the invalidations, the sharing misses,
+ * the upgrades and the flushes followed by one line per private level, and then one line for the shared level.
+ *
+ * Both formats end with the use of the shared level by each core: its accesses, hits, misses, hit rate and the lines
+ * it filled that are still valid at the end. The standardized format prints one line per core with the core, the
+ * accesses, the hits, the hit rate and the lines.
  */
-unsigned long parseCacheLevelSpecifier( char * input ) {
-    unsigned long  number;
-    char *         endptr;
+void printMultiCore( multiCoreResult_t * result, int protocol, int interleaving, int flagOut ) {
+    coherenceResult_t total = { 0 };
 
-    static_assert( ERANGE != 0, "ERANGE (range-related errors) is 0, that means it will always report an error when parsing the number input, since it checks if errno is ERANGE and errno is set to 0 before the string handling that could cause the error to ensure a previous error is not caught inadvertently. A solution is to set the errno to some other value, but that may cause problems elsewhere." );
+    for ( unsigned int i = 0; i < result->cores; i++ ) {
+        coherenceResult_t * coherence = &result->coherence[ i ];
 
-    errno = 0;
+        total.records += coherence->records;
+        total.invalidations += coherence->invalidations;
+        total.sharingMisses += coherence->sharingMisses;
+        total.upgrades += coherence->upgrades;
+        total.flushes += coherence->flushes;
 
-    number = strtoul( input + 2, &endptr, 10 );
-    
-    if ( *endptr != '\0' || endptr == input || errno == ERANGE ) {
-        fprintf( stderr, "Erro: especificador de nível de cache \"%s\" é inválido.\n", input );
-        exit( EXIT_FAILURE );
+        if ( flagOut == FREEFORM_OUT ) {
+            printf( "========== Core %u ==========\n"
+                    "Records: %" PRIu64 "\n"
+                    "Invalidations: %" PRIu64 "\n"
+                    "Sharing misses: %" PRIu64 "\n"
+                    "Upgrades: %" PRIu64 "\n"
+                    "Flushes: %" PRIu64 "\n",
+                    i,
+                    coherence->records,
+                    coherence->invalidations,
+                    coherence->sharingMisses,
+                    coherence->upgrades,
+                    coherence->flushes );
+        } else {
+            printf( "%u, %" PRIu64 ", %" PRIu64 ", %" PRIu64 ", %" PRIu64 ", %" PRIu64 "\n", i, coherence->records, coherence->invalidations,
+                    coherence->sharingMisses, coherence->upgrades, coherence->flushes );
+        }
+
+        printOutput( &result->privateResults[ i * result->privateLevels ], result->privateLevels, flagOut, true );
+    }
+
+    if ( flagOut == FREEFORM_OUT ) {
+        printf( "========== Shared ==========\n"
+                "Cores: %u\n"
+                "Protocol: %s\n"
+                "Interleaving: %s\n"
+                "Records: %" PRIu64 "\n"
+                "Invalidations: %" PRIu64 "\n"
+                "Sharing misses: %" PRIu64 "\n"
+                "Upgrades: %" PRIu64 "\n"
+                "Flushes: %" PRIu64 "\n",
+                result->cores,
+                coherenceProtocolName( protocol ),
+                interleavingName( interleaving ),
+                total.records,
+                total.invalidations,
+                total.sharingMisses,
+                total.upgrades,
+                total.flushes );
+    }
+
+    printLevelOutput( &result->shared, result->privateLevels + 1, flagOut, true );
+
+    if ( flagOut == FREEFORM_OUT ) {
+        printf( "========== L%lu Tenants ==========\n", result->privateLevels + 1 );
+    }
+
+    for ( unsigned int i = 0; i < result->cores; i++ ) {
+        tenantResult_t *  tenant = &result->sharedTenants[ i ];
+        double            hitRate = tenant->accesses > 0 ? ( double )tenant->hits / tenant->accesses : 0.0;
+
+        if ( flagOut == FREEFORM_OUT ) {
+            printf( "Core %u accesses: %" PRIu64 "\n"
+                    "Core %u hits: %" PRIu64 "\n"
+                    "Core %u misses: %" PRIu64 "\n"
+                    "Core %u hit rate: %f\n"
+                    "Core %u lines: %" PRIu64 "\n",
+                    i, tenant->accesses,
+                    i, tenant->hits,
+                    i, tenant->accesses - tenant->hits,
+                    i, hitRate,
+                    i, tenant->lines );
+        } else {
+            printf( "%u, %" PRIu64 ", %" PRIu64 ", %.4f, %" PRIu64 "\n", i, tenant->accesses, tenant->hits, hitRate, tenant->lines );
+        }
     }
-    
-    return number;
 }
 
 /*
- * This function parses the replacement policy string and returns the corresponding enum value.
- * 
- * Accepts lowercase letters in addition to uppercase letters as an additional feature if the compliance level is not
- * very strict.
- * 
- * The accepted letters are: 'R' for RANDOM, 'L' for LRU, and 'F' for FIFO.
+ * Prints a statistic of a multi-seed simulation as its mean, standard deviation and 95% confidence interval.
  */
-int parseReplacementPolicy( char * subst ) {
-    #if COMPLIANCE_LEVEL < 2
-    #define ASCII_CHAR_TO_UPPER( c ) ( ( c ) & 0xDF )
-    #else
-    #define ASCII_CHAR_TO_UPPER( c ) ( c )
-    #endif
-    
-    if ( ASCII_CHAR_TO_UPPER( subst[ 0 ] ) == 'R' && subst[ 1 ] == '\0' ) {
-        return RANDOM;
-    } else if ( ASCII_CHAR_TO_UPPER( subst[ 0 ] ) == 'L' && subst[ 1 ] == '\0' ) {
-        return LRU;
-    } else if ( ASCII_CHAR_TO_UPPER( subst[ 0 ] ) == 'F' && subst[ 1 ] == '\0' ) {
-        return FIFO;
-    } else {
-        fprintf( stderr, "Erro: política de substituição \"%s\" não é suportada.\n", subst );
-        exit( EXIT_FAILURE );
+static void printSeedStatistic( const char * name, seedStatistic_t * statistic, int precision ) {
+    printf( "%s: %.*f (stddev %.*f, IC 95%% [%.*f, %.*f])\n", name, precision, statistic->mean, precision, statistic->stddev,
+            precision, statistic->mean - statistic->confidence, precision, statistic->mean + statistic->confidence );
+}
+
+/*
+ * This function prints the output of a multi-seed simulation.
+ *
+ * The freeform format prints the mean, standard deviation and 95% confidence interval of the mean of the statistics of
+ * each level like printOutput. The standardized format prints one line per level with the mean number of accesses, the
+ * number of seeds and the mean, standard deviation and confidence interval bounds of the miss rate.
+ */
+void printSeedSummary( seedSummary_t * summaries, unsigned long cacheLevels, unsigned int seedCount, int flagOut ) {
+    for ( unsigned long i = 0; i < cacheLevels; i++ ) {
+        seedSummary_t * summary = &summaries[ i ];
+
+        if ( flagOut == FREEFORM_OUT ) {
+            printf( "========== L%lu ==========\n"
+                    "Seeds: %u\n",
+                    i + 1, seedCount );
+
+            printSeedStatistic( "Accesses", &summary->accesses, 2 );
+            printSeedStatistic( "Misses", &summary->misses, 2 );
+            printSeedStatistic( "Compulsory Misses", &summary->compulsoryMisses, 2 );
+            printSeedStatistic( "Capacity Misses", &summary->capacityMisses, 2 );
+            printSeedStatistic( "Conflict Misses", &summary->conflictMisses, 2 );
+            printSeedStatistic( "Hit rate", &summary->hitRate, 6 );
+            printSeedStatistic( "Miss rate", &summary->missRate, 6 );
+        } else {
+            printf( "%.2f, %u, %.6f, %.6f, %.6f, %.6f\n", summary->accesses.mean, seedCount, summary->missRate.mean,
+                    summary->missRate.stddev, summary->missRate.mean - summary->missRate.confidence,
+                    summary->missRate.mean + summary->missRate.confidence );
+        }
     }
-}
\ No newline at end of file
+}